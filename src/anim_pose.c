@@ -0,0 +1,263 @@
+#include "raylib.h"
+#include "raymath.h"
+#include "anim_pose.h"
+#include <stdlib.h>
+#include <math.h>
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+    #define ANIM_POSE_SSE2
+#endif
+
+// Instances per batch handed to a worker
+#define POSE_BATCH_SIZE 8
+
+const char* AnimPoseKernelName(void) {
+#if defined(ANIM_POSE_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+bool InitAnimPoseStage(AnimPoseStage* stage, const Transform* bindPose, int boneCount,
+                       const ModelAnimation* animations, int animationCount, int capacity, JobSystem* jobs) {
+    *stage = (AnimPoseStage){ 0 };
+    if (boneCount <= 0 || capacity <= 0) return false;
+    
+    stage->bindInverse = malloc(sizeof(Matrix) * boneCount);
+    stage->requests[0] = malloc(sizeof(AnimPoseRequest) * capacity);
+    stage->requests[1] = malloc(sizeof(AnimPoseRequest) * capacity);
+    stage->poses[0] = malloc(sizeof(Matrix) * boneCount * capacity);
+    stage->poses[1] = malloc(sizeof(Matrix) * boneCount * capacity);
+    if (!stage->bindInverse || !stage->requests[0] || !stage->requests[1] || !stage->poses[0] || !stage->poses[1]) {
+        FreeAnimPoseStage(stage);
+        return false;
+    }
+    
+    // Inverse bind matrices, exactly as UpdateModelAnimationBones builds them
+    for (int b = 0; b < boneCount; b++) {
+        Quaternion invRotation = QuaternionInvert(bindPose[b].rotation);
+        Vector3 invTranslation = Vector3RotateByQuaternion(Vector3Negate(bindPose[b].translation), invRotation);
+        Vector3 invScale = Vector3Divide((Vector3){ 1.0f, 1.0f, 1.0f }, bindPose[b].scale);
+        stage->bindInverse[b] = MatrixMultiply(MatrixMultiply(MatrixScale(invScale.x, invScale.y, invScale.z),
+                                                              QuaternionToMatrix(invRotation)),
+                                               MatrixTranslate(invTranslation.x, invTranslation.y, invTranslation.z));
+    }
+    for (int i = 0; i < boneCount * capacity; i++) {
+        stage->poses[0][i] = MatrixIdentity();
+        stage->poses[1][i] = MatrixIdentity();
+    }
+    for (int i = 0; i < capacity; i++) {
+        stage->requests[0][i] = (AnimPoseRequest){ -1, 0.0f };
+        stage->requests[1][i] = (AnimPoseRequest){ -1, 0.0f };
+    }
+    
+    stage->boneCount = boneCount;
+    stage->animations = animations;
+    stage->animationCount = animationCount;
+    stage->capacity = capacity;
+    stage->jobs = jobs;
+    return true;
+}
+
+void FreeAnimPoseStage(AnimPoseStage* stage) {
+    FlushAnimPoses(stage);
+    free(stage->bindInverse);
+    free(stage->requests[0]);
+    free(stage->requests[1]);
+    free(stage->poses[0]);
+    free(stage->poses[1]);
+    *stage = (AnimPoseStage){ 0 };
+}
+
+// Two frame indices and the blend weight between them; animations loop
+static bool ResolveFrames(const AnimPoseStage* stage, AnimPoseRequest request, int* frame0, int* frame1, float* weight) {
+    if (request.animation < 0 || request.animation >= stage->animationCount) return false;
+    int frameCount = stage->animations[request.animation].frameCount;
+    if (frameCount <= 0) return false;
+    
+    float frame = fmodf(request.frame, (float)frameCount);
+    if (frame < 0.0f) frame += (float)frameCount;
+    *frame0 = (int)frame;
+    if (*frame0 >= frameCount) *frame0 = frameCount - 1;
+    *frame1 = (*frame0 + 1) % frameCount;
+    *weight = frame - (float)*frame0;
+    return true;
+}
+
+void EvaluateAnimPoseReference(const AnimPoseStage* stage, AnimPoseRequest request, Matrix* out) {
+    int frame0, frame1;
+    float weight;
+    if (!ResolveFrames(stage, request, &frame0, &frame1, &weight)) {
+        for (int b = 0; b < stage->boneCount; b++) out[b] = MatrixIdentity();
+        return;
+    }
+    
+    const ModelAnimation* animation = &stage->animations[request.animation];
+    int boneCount = (animation->boneCount < stage->boneCount) ? animation->boneCount : stage->boneCount;
+    for (int b = 0; b < boneCount; b++) {
+        Transform pose = animation->framePoses[frame0][b];
+        if (weight > 0.0f) {
+            Transform next = animation->framePoses[frame1][b];
+            Quaternion q = next.rotation;
+            // Take the short way round
+            if (pose.rotation.x*q.x + pose.rotation.y*q.y + pose.rotation.z*q.z + pose.rotation.w*q.w < 0.0f) {
+                q = (Quaternion){ -q.x, -q.y, -q.z, -q.w };
+            }
+            pose.translation = Vector3Lerp(pose.translation, next.translation, weight);
+            pose.rotation = QuaternionNormalize(QuaternionLerp(pose.rotation, q, weight));
+            pose.scale = Vector3Lerp(pose.scale, next.scale, weight);
+        }
+        Matrix target = MatrixMultiply(MatrixMultiply(MatrixScale(pose.scale.x, pose.scale.y, pose.scale.z),
+                                                      QuaternionToMatrix(pose.rotation)),
+                                       MatrixTranslate(pose.translation.x, pose.translation.y, pose.translation.z));
+        out[b] = MatrixMultiply(stage->bindInverse[b], target);
+    }
+    for (int b = boneCount; b < stage->boneCount; b++) out[b] = MatrixIdentity();
+}
+
+// Scale, then rotate, then translate, written out directly instead of
+// multiplying three matrices
+static Matrix ComposeBoneMatrix(Vector3 translation, Quaternion q, Vector3 scale) {
+    float a2 = q.x*q.x, b2 = q.y*q.y, c2 = q.z*q.z;
+    float ac = q.x*q.z, ab = q.x*q.y, bc = q.y*q.z;
+    float ad = q.w*q.x, bd = q.w*q.y, cd = q.w*q.z;
+    
+    Matrix m = { 0 };
+    m.m0 = (1.0f - 2.0f*(b2 + c2))*scale.x;
+    m.m1 = 2.0f*(ab + cd)*scale.x;
+    m.m2 = 2.0f*(ac - bd)*scale.x;
+    m.m4 = 2.0f*(ab - cd)*scale.y;
+    m.m5 = (1.0f - 2.0f*(a2 + c2))*scale.y;
+    m.m6 = 2.0f*(bc + ad)*scale.y;
+    m.m8 = 2.0f*(ac + bd)*scale.z;
+    m.m9 = 2.0f*(bc - ad)*scale.z;
+    m.m10 = (1.0f - 2.0f*(a2 + b2))*scale.z;
+    m.m12 = translation.x;
+    m.m13 = translation.y;
+    m.m14 = translation.z;
+    m.m15 = 1.0f;
+    return m;
+}
+
+#if defined(ANIM_POSE_SSE2)
+// Matrix is stored m0 m4 m8 m12 | m1 m5 m9 m13 | ..., so MatrixMultiply(left,
+// right) is right * left over those memory rows
+static void MultiplyMatrices(const Matrix* left, const Matrix* right, Matrix* out) {
+    const float* l = (const float*)left;
+    const float* r = (const float*)right;
+    float* o = (float*)out;
+    __m128 row0 = _mm_loadu_ps(l);
+    __m128 row1 = _mm_loadu_ps(l + 4);
+    __m128 row2 = _mm_loadu_ps(l + 8);
+    __m128 row3 = _mm_loadu_ps(l + 12);
+    for (int i = 0; i < 4; i++) {
+        __m128 sum = _mm_mul_ps(_mm_set1_ps(r[i*4 + 0]), row0);
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(r[i*4 + 1]), row1));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(r[i*4 + 2]), row2));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(r[i*4 + 3]), row3));
+        _mm_storeu_ps(o + i*4, sum);
+    }
+}
+
+static Quaternion BlendRotation(Quaternion from, Quaternion to, float weight) {
+    __m128 a = _mm_loadu_ps(&from.x);
+    __m128 b = _mm_loadu_ps(&to.x);
+    
+    // Horizontal dot product; flip b when it's on the far hemisphere
+    __m128 dot = _mm_mul_ps(a, b);
+    dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(2, 3, 0, 1)));
+    dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(1, 0, 3, 2)));
+    __m128 sign = _mm_and_ps(_mm_cmplt_ps(dot, _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+    b = _mm_xor_ps(b, sign);
+    
+    __m128 q = _mm_add_ps(a, _mm_mul_ps(_mm_set1_ps(weight), _mm_sub_ps(b, a)));
+    __m128 length = _mm_mul_ps(q, q);
+    length = _mm_add_ps(length, _mm_shuffle_ps(length, length, _MM_SHUFFLE(2, 3, 0, 1)));
+    length = _mm_add_ps(length, _mm_shuffle_ps(length, length, _MM_SHUFFLE(1, 0, 3, 2)));
+    length = _mm_sqrt_ps(length);
+    q = _mm_div_ps(q, _mm_max_ps(length, _mm_set1_ps(1e-12f)));
+    
+    Quaternion result;
+    _mm_storeu_ps(&result.x, q);
+    return result;
+}
+#else
+static void MultiplyMatrices(const Matrix* left, const Matrix* right, Matrix* out) {
+    *out = MatrixMultiply(*left, *right);
+}
+
+static Quaternion BlendRotation(Quaternion from, Quaternion to, float weight) {
+    if (from.x*to.x + from.y*to.y + from.z*to.z + from.w*to.w < 0.0f) {
+        to = (Quaternion){ -to.x, -to.y, -to.z, -to.w };
+    }
+    return QuaternionNormalize(QuaternionLerp(from, to, weight));
+}
+#endif
+
+static void EvaluatePose(const AnimPoseStage* stage, AnimPoseRequest request, Matrix* out) {
+    int frame0, frame1;
+    float weight;
+    if (!ResolveFrames(stage, request, &frame0, &frame1, &weight)) {
+        for (int b = 0; b < stage->boneCount; b++) out[b] = MatrixIdentity();
+        return;
+    }
+    
+    const ModelAnimation* animation = &stage->animations[request.animation];
+    int boneCount = (animation->boneCount < stage->boneCount) ? animation->boneCount : stage->boneCount;
+    const Transform* poses0 = animation->framePoses[frame0];
+    const Transform* poses1 = animation->framePoses[frame1];
+    
+    for (int b = 0; b < boneCount; b++) {
+        Vector3 translation = poses0[b].translation;
+        Quaternion rotation = poses0[b].rotation;
+        Vector3 scale = poses0[b].scale;
+        // Whole frames use the stored pose untouched, like UpdateModelAnimationBones
+        if (weight > 0.0f) {
+            translation = Vector3Lerp(translation, poses1[b].translation, weight);
+            rotation = BlendRotation(rotation, poses1[b].rotation, weight);
+            scale = Vector3Lerp(scale, poses1[b].scale, weight);
+        }
+        Matrix target = ComposeBoneMatrix(translation, rotation, scale);
+        MultiplyMatrices(&stage->bindInverse[b], &target, &out[b]);
+    }
+    for (int b = boneCount; b < stage->boneCount; b++) out[b] = MatrixIdentity();
+}
+
+static void EvaluatePoseBatch(void* userData, int begin, int end) {
+    AnimPoseStage* stage = userData;
+    const AnimPoseRequest* requests = stage->requests[stage->front ^ 1];
+    Matrix* back = stage->poses[stage->front ^ 1];
+    for (int i = begin; i < end; i++) {
+        EvaluatePose(stage, requests[i], &back[i * stage->boneCount]);
+    }
+}
+
+void FlushAnimPoses(AnimPoseStage* stage) {
+    if (!stage->pending) return;
+    WaitForJobs(stage->jobs, &stage->counter);
+    stage->front ^= 1;
+    stage->pending = false;
+}
+
+void KickAnimPoses(AnimPoseStage* stage, const AnimPoseRequest* requests, int count) {
+    FlushAnimPoses(stage);
+    if (count > stage->capacity) count = stage->capacity;
+    if (count <= 0) return;
+    
+    for (int i = 0; i < count; i++) stage->requests[stage->front ^ 1][i] = requests[i];
+    stage->requestCount = count;
+    stage->pending = true;
+    SubmitJobs(stage->jobs, EvaluatePoseBatch, stage, count, POSE_BATCH_SIZE, &stage->counter);
+}
+
+const Matrix* GetAnimPose(const AnimPoseStage* stage, int instance) {
+    if (instance < 0 || instance >= stage->capacity) instance = 0;
+    return &stage->poses[stage->front][instance * stage->boneCount];
+}
+
+AnimPoseRequest GetAnimPoseRequest(const AnimPoseStage* stage, int instance) {
+    if (instance < 0 || instance >= stage->capacity) instance = 0;
+    return stage->requests[stage->front][instance];
+}
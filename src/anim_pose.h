@@ -0,0 +1,61 @@
+#ifndef ANIM_POSE_H
+#define ANIM_POSE_H
+
+#include "raylib.h"
+#include "job_system.h"
+
+// Which pose one animated instance wants this tick
+typedef struct {
+    int animation;
+    float frame;          // Fractional frames blend toward the next frame
+} AnimPoseRequest;
+
+// Evaluates skinning matrices (inverse bind pose * animated bone transform,
+// the same matrices UpdateModelAnimationBones writes) for many instances on
+// the job system. Results are double buffered: KickAnimPoses publishes the
+// previous job's output and starts the next one, so the renderer reads the
+// front buffer while workers fill the back one, without locks. The
+// requests travel with their buffer, so whatever has to line up with a
+// drawn pose (equipment sockets) can ask which frame it shows.
+typedef struct {
+    int boneCount;
+    Matrix* bindInverse;          // Per bone, fixed for the model
+    const ModelAnimation* animations;
+    int animationCount;
+    
+    int capacity;                 // Max instances
+    AnimPoseRequest* requests[2]; // What each buffer holds, or is being evaluated into
+    int requestCount;
+    Matrix* poses[2];             // [instance * boneCount + bone]
+    int front;                    // Buffer the renderer reads
+    bool pending;                 // A job is writing the back buffer
+    
+    JobSystem* jobs;
+    JobCounter counter;           // Batches of the job in flight
+} AnimPoseStage;
+
+// bindPose may come from the model, or from frame 0 of an animation when no
+// model is loaded. Both buffers start out in bind pose (identity matrices).
+bool InitAnimPoseStage(AnimPoseStage* stage, const Transform* bindPose, int boneCount,
+                       const ModelAnimation* animations, int animationCount, int capacity, JobSystem* jobs);
+void FreeAnimPoseStage(AnimPoseStage* stage);
+
+// Wait for the job in flight, make its output the front buffer and start
+// evaluating these requests into the back buffer
+void KickAnimPoses(AnimPoseStage* stage, const AnimPoseRequest* requests, int count);
+
+// Wait for the job in flight and publish it
+void FlushAnimPoses(AnimPoseStage* stage);
+
+// Bone matrices of an instance from the front buffer
+const Matrix* GetAnimPose(const AnimPoseStage* stage, int instance);
+// The request those matrices were evaluated from; animation -1 while the
+// instance is still in bind pose
+AnimPoseRequest GetAnimPoseRequest(const AnimPoseStage* stage, int instance);
+
+// Evaluate one instance with plain raymath, for checking the fast path
+void EvaluateAnimPoseReference(const AnimPoseStage* stage, AnimPoseRequest request, Matrix* out);
+
+const char* AnimPoseKernelName(void);
+
+#endif // ANIM_POSE_H
@@ -0,0 +1,196 @@
+#include "raylib.h"
+#include "asset_loader.h"
+#include "logger.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* assetPaths[ASSET_COUNT] = {
+    "assets/models/greenman.glb",
+    "assets/models/greenman_hat.glb",
+    "assets/models/greenman_sword.glb",
+    "assets/models/greenman_shield.glb"
+};
+
+// raylib's file callback has no user pointer
+static AssetLoader* activeLoader = NULL;
+
+static unsigned char* ReadWholeFile(const char* path, int* size) {
+    *size = 0;
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    
+    unsigned char* data = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long length = ftell(file);
+        if (length > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data = malloc((size_t)length);
+            if (data && fread(data, 1, (size_t)length, file) == (size_t)length) {
+                *size = (int)length;
+            } else {
+                free(data);
+                data = NULL;
+            }
+        }
+    }
+    fclose(file);
+    return data;
+}
+
+// Serves preloaded files to raylib's loaders. raylib frees what it gets
+// back, so this always returns a copy; anything else comes from disk.
+static unsigned char* LoadPreloadedFile(const char* fileName, int* dataSize) {
+    if (activeLoader != NULL) {
+        for (int i = 0; i < ASSET_COUNT; i++) {
+            // Only slots whose bytes have been published: ready ones, and the
+            // one the loader thread is parsing right now
+            AssetSlot* slot = &activeLoader->slots[i];
+            bool published = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) == ASSET_READY ||
+                             __atomic_load_n(&activeLoader->parsing, __ATOMIC_ACQUIRE) == i;
+            if (published && slot->data != NULL && strcmp(slot->path, fileName) == 0) {
+                unsigned char* copy = malloc(slot->dataSize);
+                if (copy == NULL) break;
+                memcpy(copy, slot->data, slot->dataSize);
+                *dataSize = slot->dataSize;
+                return copy;
+            }
+        }
+    }
+    return ReadWholeFile(fileName, dataSize);
+}
+
+static void SetAssetState(AssetSlot* slot, AssetState state) {
+    __atomic_store_n(&slot->state, (int)state, __ATOMIC_RELEASE);
+}
+
+// The character goes first and is the only one parsed here: raylib's
+// string helpers use static buffers, so the thread must be done calling
+// into raylib before the main thread starts loading models from it.
+// Cached assets need no raylib calls at all.
+static void* LoaderMain(void* arg) {
+    AssetLoader* loader = arg;
+    
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        AssetSlot* slot = &loader->slots[i];
+        char cachePath[256];
+        GetModelCachePath(slot->path, cachePath, sizeof(cachePath));
+        if (OpenModelCache(&slot->cache, cachePath, slot->path)) {
+            slot->cached = true;
+            if (i == ASSET_CHARACTER) slot->animations = LoadCachedAnimations(&slot->cache, &slot->animationCount);
+            slot->readySeconds = GetMonotonicSeconds() - loader->startSeconds;
+            SetAssetState(slot, ASSET_READY);
+            continue;
+        }
+        
+        slot->data = ReadWholeFile(slot->path, &slot->dataSize);
+        if (slot->data == NULL) {
+            slot->readySeconds = GetMonotonicSeconds() - loader->startSeconds;
+            SetAssetState(slot, ASSET_MISSING);
+            continue;
+        }
+        if (i == ASSET_CHARACTER) {
+            __atomic_store_n(&loader->parsing, i, __ATOMIC_RELEASE);
+            slot->animations = LoadModelAnimations(slot->path, &slot->animationCount);
+            __atomic_store_n(&loader->parsing, -1, __ATOMIC_RELEASE);
+        }
+        slot->readySeconds = GetMonotonicSeconds() - loader->startSeconds;
+        SetAssetState(slot, ASSET_READY);
+    }
+    return NULL;
+}
+
+void StartAssetLoader(AssetLoader* loader) {
+    *loader = (AssetLoader){ 0 };
+    for (int i = 0; i < ASSET_COUNT; i++) loader->slots[i].path = assetPaths[i];
+    loader->parsing = -1;
+    loader->startSeconds = GetMonotonicSeconds();
+    
+    activeLoader = loader;
+    SetLoadFileDataCallback(LoadPreloadedFile);
+    
+    if (pthread_create(&loader->thread, NULL, LoaderMain, loader) == 0) {
+        loader->threadStarted = true;
+    } else {
+        LOGW(LOG_CAT_ASSETS, "Could not start the asset loader thread, loading in place");
+        LoaderMain(loader);
+    }
+}
+
+void StopAssetLoader(AssetLoader* loader) {
+    if (loader->threadStarted) pthread_join(loader->thread, NULL);
+    
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        AssetSlot* slot = &loader->slots[i];
+        free(slot->data);
+        UnloadAnimationAssets(loader, (AssetId)i, slot->animations, slot->animationCount);
+        CloseModelCache(&slot->cache);
+    }
+    
+    SetLoadFileDataCallback(NULL);
+    activeLoader = NULL;
+    *loader = (AssetLoader){ 0 };
+}
+
+const char* GetAssetPath(AssetId id) {
+    return assetPaths[id];
+}
+
+AssetState GetAssetState(const AssetLoader* loader, AssetId id) {
+    return (AssetState)__atomic_load_n(&loader->slots[id].state, __ATOMIC_ACQUIRE);
+}
+
+bool AllAssetsSettled(const AssetLoader* loader) {
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        AssetState state = GetAssetState(loader, (AssetId)i);
+        if (state == ASSET_LOADING || state == ASSET_READY) return false;
+    }
+    return true;
+}
+
+Model TakeModelAsset(AssetLoader* loader, AssetId id, ModelAnimation** animations, int* animationCount) {
+    AssetSlot* slot = &loader->slots[id];
+    Model model = { 0 };
+    if (GetAssetState(loader, id) != ASSET_READY) return model;
+    
+    model = slot->cached ? LoadCachedModel(&slot->cache) : LoadModel(slot->path);
+    free(slot->data);
+    slot->data = NULL;
+    
+    if (animations != NULL) {
+        *animations = slot->animations;
+        *animationCount = slot->animationCount;
+        slot->animations = NULL;
+        slot->animationCount = 0;
+    }
+    SetAssetState(slot, ASSET_TAKEN);
+    return model;
+}
+
+Model ReloadModelAsset(const AssetLoader* loader, AssetId id) {
+    const AssetSlot* slot = &loader->slots[id];
+    return slot->cached ? LoadCachedModel(&slot->cache) : LoadModel(slot->path);
+}
+
+ModelAnimation* ReloadAnimationAssets(const AssetLoader* loader, AssetId id, int* animationCount) {
+    const AssetSlot* slot = &loader->slots[id];
+    *animationCount = 0;
+    return slot->cached ? LoadCachedAnimations(&slot->cache, animationCount) : LoadModelAnimations(slot->path, animationCount);
+}
+
+void UnloadModelAsset(const AssetLoader* loader, AssetId id, Model model) {
+    if (loader->slots[id].cached) {
+        UnloadCachedModel(model);
+    } else {
+        UnloadModel(model);
+    }
+}
+
+void UnloadAnimationAssets(const AssetLoader* loader, AssetId id, ModelAnimation* animations, int animationCount) {
+    if (animations == NULL) return;
+    if (loader->slots[id].cached) {
+        UnloadCachedAnimations(animations, animationCount);
+    } else {
+        UnloadModelAnimations(animations, animationCount);
+    }
+}
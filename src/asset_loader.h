@@ -0,0 +1,68 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include "raylib.h"
+#include "model_cache.h"
+#include <stdbool.h>
+#include <pthread.h>
+
+typedef enum {
+    ASSET_CHARACTER = 0,
+    ASSET_HAT,
+    ASSET_SWORD,
+    ASSET_SHIELD,
+    ASSET_COUNT
+} AssetId;
+
+typedef enum {
+    ASSET_LOADING = 0,    // Background thread still reading/parsing
+    ASSET_READY,          // CPU side done, waiting for the main thread to upload
+    ASSET_TAKEN,          // Uploaded (or handed over) on the main thread
+    ASSET_MISSING         // File not found or unreadable
+} AssetState;
+
+typedef struct {
+    const char* path;
+    unsigned char* data;  // Whole file, served to LoadModel from memory
+    int dataSize;
+    ModelCache cache;     // Mapped cooked file, used instead of data when current
+    bool cached;
+    ModelAnimation* animations;   // Character only
+    int animationCount;
+    int state;            // AssetState, read and written atomically
+    double readySeconds;  // Since StartAssetLoader
+} AssetSlot;
+
+// Maps the cooked caches of the character and equipment (or reads and
+// parses the GLBs when a cache is missing or stale) on a background thread. GPU work has to stay on the main
+// thread, so models are created there with TakeModelAsset once ready.
+typedef struct {
+    pthread_t thread;
+    bool threadStarted;
+    AssetSlot slots[ASSET_COUNT];
+    int parsing;          // Slot the thread is parsing with raylib, -1 if none (atomic)
+    double startSeconds;
+} AssetLoader;
+
+void StartAssetLoader(AssetLoader* loader);
+void StopAssetLoader(AssetLoader* loader);
+
+const char* GetAssetPath(AssetId id);
+AssetState GetAssetState(const AssetLoader* loader, AssetId id);
+bool AllAssetsSettled(const AssetLoader* loader);
+
+// Main thread, once the asset is ready: build the model from the cache or the
+// preloaded bytes (no disk access) and hand over the animations if any
+Model TakeModelAsset(AssetLoader* loader, AssetId id, ModelAnimation** animations, int* animationCount);
+
+// Main thread, after TakeModelAsset: build them again once they've been
+// unloaded, from the cache when there is one and from the GLB otherwise
+Model ReloadModelAsset(const AssetLoader* loader, AssetId id);
+ModelAnimation* ReloadAnimationAssets(const AssetLoader* loader, AssetId id, int* animationCount);
+
+// Models and animations from a cache point into its mapping, so they have to
+// be released through these, before StopAssetLoader unmaps it
+void UnloadModelAsset(const AssetLoader* loader, AssetId id, Model model);
+void UnloadAnimationAssets(const AssetLoader* loader, AssetId id, ModelAnimation* animations, int animationCount);
+
+#endif // ASSET_LOADER_H
@@ -0,0 +1,744 @@
+#include "raylib.h"
+#include "raymath.h"
+#include "game.h"
+#include "bench.h"
+#include "timer.h"
+#include "anim_pose.h"
+#include "job_system.h"
+#include "model_cache.h"
+#include "logger.h"
+#include "server.h"
+#include "net_client.h"
+#include "save_game.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_QUERIES 20000
+#define BENCH_VIEW_RADIUS 30.0f
+#define BENCH_AREA_PER_TREE 36.0f   // Same density as the 6-unit start grid
+#define BENCH_ANIM_EVALUATIONS 200000 // Instance poses evaluated per crowd size
+#define BENCH_SYNTHETIC_BONES 40
+#define BENCH_SYNTHETIC_FRAMES 60
+#define BENCH_NET_TICKS 1200        // 20 s of play per client count
+#define BENCH_SAVE_TICKS 600        // Played before saving, and again after resuming
+#define BENCH_SAVE_RUNS 5
+#define BENCH_SAVE_PATH "bench_save.sav"
+
+static float RandomRange(float min, float max) {
+    return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+// Queries follow a wandering walker, as they do in the game, rather than
+// jumping to a random spot each time
+static void GenerateWalkerPath(Player* players, int count, float halfSize) {
+    Vector3 walker = { 0.0f, 0.0f, 0.0f };
+    float heading = 0.0f;
+    for (int q = 0; q < count; q++) {
+        heading += RandomRange(-20.0f, 20.0f);
+        walker.x += sinf(heading * DEG2RAD) * 0.5f;
+        walker.z += cosf(heading * DEG2RAD) * 0.5f;
+        if (fabsf(walker.x) > halfSize || fabsf(walker.z) > halfSize) {
+            heading += 180.0f;
+            walker.x = Clamp(walker.x, -halfSize, halfSize);
+            walker.z = Clamp(walker.z, -halfSize, halfSize);
+        }
+        players[q] = (Player){ .position = walker, .rotationY = heading };
+    }
+}
+
+// Chop and visibility query cost as the forest grows at constant density:
+// the linear scan grows with the tree count, the grid should stay flat.
+static int RunGridBenchmark(void) {
+    const int treeCounts[] = { 20, 100, 1000, 10000, 100000 };
+    const int sizeCount = sizeof(treeCounts) / sizeof(treeCounts[0]);
+    int mismatches = 0;
+    
+    srand(1);
+    
+    printf("Tree query benchmark: %d queries per size, view radius %.0f\n", BENCH_QUERIES, BENCH_VIEW_RADIUS);
+    printf("%8s %10s | %12s %12s | %12s %12s %10s\n",
+           "trees", "world", "chop scan", "chop grid", "view scan", "view grid", "visible");
+    
+    for (int s = 0; s < sizeCount; s++) {
+        int treeCount = treeCounts[s];
+        float halfSize = sqrtf(treeCount * BENCH_AREA_PER_TREE) * 0.5f;
+        
+        Tree* trees = malloc(sizeof(Tree) * treeCount);
+        int* results = malloc(sizeof(int) * treeCount);
+        Player* players = malloc(sizeof(Player) * BENCH_QUERIES);
+        TreeGrid grid;
+        if (!trees || !results || !players || !InitTreeGrid(&grid, treeCount, TREE_GRID_CELL_SIZE)) {
+            printf("Out of memory at %d trees\n", treeCount);
+            free(trees);
+            free(results);
+            free(players);
+            return 1;
+        }
+        
+        for (int i = 0; i < treeCount; i++) {
+            trees[i] = (Tree){
+                .position = { RandomRange(-halfSize, halfSize), 0.0f, RandomRange(-halfSize, halfSize) },
+                .exists = true,
+                .answerNumber = 0
+            };
+            TreeGridInsert(&grid, i, trees[i].position);
+        }
+        GenerateWalkerPath(players, BENCH_QUERIES, halfSize);
+        
+        // Chop queries, checking the grid picks the same tree as the scan
+        long long scanSum = 0;
+        double start = GetMonotonicSeconds();
+        for (int q = 0; q < BENCH_QUERIES; q++) {
+            scanSum += FindChopTargetLinear(&players[q], trees, treeCount);
+        }
+        double chopScan = GetMonotonicSeconds() - start;
+        
+        long long gridSum = 0;
+        start = GetMonotonicSeconds();
+        for (int q = 0; q < BENCH_QUERIES; q++) {
+            gridSum += FindChopTarget(&players[q], trees, &grid, results, treeCount);
+        }
+        double chopGrid = GetMonotonicSeconds() - start;
+        
+        for (int q = 0; q < BENCH_QUERIES; q++) {
+            if (FindChopTargetLinear(&players[q], trees, treeCount) != FindChopTarget(&players[q], trees, &grid, results, treeCount)) {
+                mismatches++;
+            }
+        }
+        
+        // Visibility queries around each player
+        long long scanVisible = 0;
+        float radiusSqr = BENCH_VIEW_RADIUS * BENCH_VIEW_RADIUS;
+        start = GetMonotonicSeconds();
+        for (int q = 0; q < BENCH_QUERIES; q++) {
+            Vector3 center = players[q].position;
+            for (int i = 0; i < treeCount; i++) {
+                float dx = trees[i].position.x - center.x;
+                float dz = trees[i].position.z - center.z;
+                if (trees[i].exists && dx * dx + dz * dz <= radiusSqr) scanVisible++;
+            }
+        }
+        double viewScan = GetMonotonicSeconds() - start;
+        
+        long long gridVisible = 0;
+        start = GetMonotonicSeconds();
+        for (int q = 0; q < BENCH_QUERIES; q++) {
+            gridVisible += QueryTreesInRadius(trees, &grid, players[q].position, BENCH_VIEW_RADIUS, results, treeCount);
+        }
+        double viewGrid = GetMonotonicSeconds() - start;
+        
+        if (scanSum != gridSum || scanVisible != gridVisible) mismatches++;
+        
+        printf("%8d %10.0f | %9.1f ns %9.1f ns | %9.1f ns %9.1f ns %10.1f\n",
+               treeCount, halfSize * 2.0f,
+               chopScan * 1e9 / BENCH_QUERIES, chopGrid * 1e9 / BENCH_QUERIES,
+               viewScan * 1e9 / BENCH_QUERIES, viewGrid * 1e9 / BENCH_QUERIES,
+               (double)gridVisible / BENCH_QUERIES);
+        
+        FreeTreeGrid(&grid);
+        free(trees);
+        free(results);
+        free(players);
+    }
+    
+    if (mismatches > 0) {
+        printf("MISMATCH: grid and linear scan disagreed on %d queries\n", mismatches);
+        return 1;
+    }
+    printf("Grid and linear scan agree on every query\n");
+    return 0;
+}
+
+static const char* ChopQueryName(ChopQuery query) {
+    switch (query) {
+        case CHOP_QUERY_SCAN: return "scan";
+        case CHOP_QUERY_GRID: return "grid";
+        case CHOP_QUERY_SIMD: return "simd";
+        default: return "auto";
+    }
+}
+
+// The chop query as the game runs it: a default world, streamed around a
+// walker inside the loaded chunks, once per mode. Returns the mismatches.
+static int RunDefaultWorldChopBenchmark(void) {
+    unsigned int logMask = logCategoryMask;
+    logCategoryMask = 0;
+    SimulationConfig config = DefaultSimulationConfig();
+    config.botCount = 0;
+    
+    // What AUTO resolves to; the timed world runs SIMD so the SoA mirror is kept
+    Simulation sim;
+    ChopQuery picked = CHOP_QUERY_AUTO;
+    if (AllocateSimulation(&sim, &config)) {
+        picked = sim.chopQuery;
+        FreeSimulation(&sim);
+    }
+    config.chopQuery = CHOP_QUERY_SIMD;
+    
+    Player* players = malloc(sizeof(Player) * BENCH_QUERIES);
+    int* expected = malloc(sizeof(int) * BENCH_QUERIES);
+    if (!players || !expected || !InitSimulation(&sim, &config)) {
+        logCategoryMask = logMask;
+        printf("Out of memory for the default world\n");
+        free(players);
+        free(expected);
+        return 1;
+    }
+    logCategoryMask = logMask;
+    
+    GenerateWalkerPath(players, BENCH_QUERIES, CHUNK_SIZE * (CHUNK_LOAD_RADIUS + 0.5f));
+    const ChopQuery modes[] = { CHOP_QUERY_SCAN, CHOP_QUERY_GRID, CHOP_QUERY_SIMD };
+    double times[3];
+    int mismatches = 0;
+    int hits = 0;
+    for (int m = 0; m < 3; m++) {
+        sim.chopQuery = modes[m];
+        double start = GetMonotonicSeconds();
+        for (int q = 0; q < BENCH_QUERIES; q++) {
+            sim.player.position = players[q].position;
+            sim.player.rotationY = players[q].rotationY;
+            int target = FindSimulationChopTarget(&sim, &sim.player);
+            if (m == 0) expected[q] = target;
+            else mismatches += (target != expected[q]);
+        }
+        times[m] = GetMonotonicSeconds() - start;
+    }
+    for (int q = 0; q < BENCH_QUERIES; q++) hits += (expected[q] >= 0);
+    
+    printf("Default world (%d tree slots, %d per chunk): %.1f ns scan, %.1f ns grid, %.1f ns simd, %d hits; auto picks %s\n",
+           sim.treeCount, sim.chunks.treesPerChunk, times[0] * 1e9 / BENCH_QUERIES, times[1] * 1e9 / BENCH_QUERIES,
+           times[2] * 1e9 / BENCH_QUERIES, hits, ChopQueryName(picked));
+    
+    FreeSimulation(&sim);
+    free(players);
+    free(expected);
+    return mismatches;
+}
+
+// Scalar scan vs. SIMD kernel vs. grid for the chop query, plus a sweep of
+// trees placed right on the range and cone boundaries where rounding differs
+static int RunChopBenchmark(void) {
+    const int treeCounts[] = { 20, 100, 1000, 10000, 100000 };
+    const int sizeCount = sizeof(treeCounts) / sizeof(treeCounts[0]);
+    int mismatches = 0;
+    
+    srand(1);
+    
+    printf("Chop query benchmark (%s kernel): %d queries per size\n", TreeSoAKernelName(), BENCH_QUERIES);
+    printf("%8s | %12s %12s %12s | %8s\n", "trees", "scalar scan", "simd scan", "grid", "hits");
+    
+    for (int s = 0; s < sizeCount; s++) {
+        int treeCount = treeCounts[s];
+        float halfSize = sqrtf(treeCount * BENCH_AREA_PER_TREE) * 0.5f;
+        
+        Tree* trees = malloc(sizeof(Tree) * treeCount);
+        int* results = malloc(sizeof(int) * treeCount);
+        int* expected = malloc(sizeof(int) * BENCH_QUERIES);
+        Player* players = malloc(sizeof(Player) * BENCH_QUERIES);
+        Vector3* forwards = malloc(sizeof(Vector3) * BENCH_QUERIES);
+        TreeGrid grid;
+        TreeSoA store;
+        if (!trees || !results || !expected || !players || !forwards ||
+            !InitTreeGrid(&grid, treeCount, TREE_GRID_CELL_SIZE) || !InitTreeSoA(&store, treeCount)) {
+            printf("Out of memory at %d trees\n", treeCount);
+            return 1;
+        }
+        
+        for (int i = 0; i < treeCount; i++) {
+            trees[i] = (Tree){
+                .position = { RandomRange(-halfSize, halfSize), 0.0f, RandomRange(-halfSize, halfSize) },
+                .exists = (rand() % 8) != 0, // Some gaps, as after chops
+                .answerNumber = 0
+            };
+            TreeGridInsert(&grid, i, trees[i].position);
+            TreeSoASet(&store, i, trees[i].position, trees[i].exists, 0);
+        }
+        GenerateWalkerPath(players, BENCH_QUERIES, halfSize);
+        for (int q = 0; q < BENCH_QUERIES; q++) forwards[q] = PlayerForward(&players[q]);
+        
+        int hits = 0;
+        double start = GetMonotonicSeconds();
+        for (int q = 0; q < BENCH_QUERIES; q++) {
+            expected[q] = FindChopTargetLinear(&players[q], trees, treeCount);
+        }
+        double scanTime = GetMonotonicSeconds() - start;
+        
+        int simdMismatches = 0;
+        start = GetMonotonicSeconds();
+        for (int q = 0; q < BENCH_QUERIES; q++) {
+            simdMismatches += (TreeSoAFindChopTarget(&store, players[q].position, forwards[q]) != expected[q]);
+        }
+        double simdTime = GetMonotonicSeconds() - start;
+        
+        int gridMismatches = 0;
+        start = GetMonotonicSeconds();
+        for (int q = 0; q < BENCH_QUERIES; q++) {
+            gridMismatches += (FindChopTarget(&players[q], trees, &grid, results, treeCount) != expected[q]);
+        }
+        double gridTime = GetMonotonicSeconds() - start;
+        
+        for (int q = 0; q < BENCH_QUERIES; q++) hits += (expected[q] >= 0);
+        mismatches += simdMismatches + gridMismatches;
+        
+        printf("%8d | %9.1f ns %9.1f ns %9.1f ns | %8d\n", treeCount,
+               scanTime * 1e9 / BENCH_QUERIES, simdTime * 1e9 / BENCH_QUERIES, gridTime * 1e9 / BENCH_QUERIES, hits);
+        
+        FreeTreeGrid(&grid);
+        FreeTreeSoA(&store);
+        free(trees);
+        free(results);
+        free(expected);
+        free(players);
+        free(forwards);
+    }
+    
+    // Boundary sweep: trees a hair either side of the range and cone limits
+    const int edgeCases = 200000;
+    const int ringSize = 4;
+    Tree ring[4];
+    TreeSoA store;
+    if (!InitTreeSoA(&store, ringSize)) return 1;
+    
+    int edgeMismatches = 0;
+    int edgeHits = 0;
+    for (int c = 0; c < edgeCases; c++) {
+        Player player = {
+            .position = { RandomRange(-50.0f, 50.0f), 0.0f, RandomRange(-50.0f, 50.0f) },
+            .rotationY = RandomRange(-180.0f, 180.0f)
+        };
+        for (int i = 0; i < ringSize; i++) {
+            float distance = CHOP_RANGE * (1.0f + RandomRange(-4e-6f, 4e-6f));
+            float side = (rand() % 2) ? 1.0f : -1.0f;
+            float angle = (player.rotationY + side * (60.0f + RandomRange(-1e-3f, 1e-3f))) * DEG2RAD;
+            ring[i] = (Tree){
+                .position = { player.position.x + sinf(angle) * distance, 0.0f, player.position.z + cosf(angle) * distance },
+                .exists = true
+            };
+            TreeSoASet(&store, i, ring[i].position, true, 0);
+        }
+        int scalar = FindChopTargetLinear(&player, ring, ringSize);
+        int simd = TreeSoAFindChopTarget(&store, player.position, PlayerForward(&player));
+        edgeMismatches += (scalar != simd);
+        edgeHits += (scalar >= 0);
+    }
+    FreeTreeSoA(&store);
+    mismatches += edgeMismatches;
+    printf("Boundary sweep: %d cases, %d hits, %d mismatches\n", edgeCases, edgeHits, edgeMismatches);
+    
+    mismatches += RunDefaultWorldChopBenchmark();
+    
+    if (mismatches > 0) {
+        printf("MISMATCH: SIMD or grid disagreed with the scalar scan %d times\n", mismatches);
+        return 1;
+    }
+    printf("SIMD kernel and grid match the scalar scan exactly\n");
+    return 0;
+}
+
+static Transform RandomBoneTransform(void) {
+    Quaternion rotation = QuaternionNormalize((Quaternion){
+        RandomRange(-1.0f, 1.0f), RandomRange(-1.0f, 1.0f), RandomRange(-1.0f, 1.0f), RandomRange(-1.0f, 1.0f)
+    });
+    return (Transform){
+        .translation = { RandomRange(-1.0f, 1.0f), RandomRange(0.0f, 2.0f), RandomRange(-1.0f, 1.0f) },
+        .rotation = rotation,
+        .scale = { 1.0f, 1.0f, 1.0f }
+    };
+}
+
+// Two looping clips on a made-up skeleton, for when the glTF isn't around
+static ModelAnimation* GenerateSyntheticAnimations(int* count) {
+    ModelAnimation* animations = calloc(2, sizeof(ModelAnimation));
+    if (!animations) return NULL;
+    for (int a = 0; a < 2; a++) {
+        animations[a].boneCount = BENCH_SYNTHETIC_BONES;
+        animations[a].frameCount = BENCH_SYNTHETIC_FRAMES;
+        animations[a].framePoses = malloc(sizeof(Transform*) * BENCH_SYNTHETIC_FRAMES);
+        for (int f = 0; f < BENCH_SYNTHETIC_FRAMES; f++) {
+            animations[a].framePoses[f] = malloc(sizeof(Transform) * BENCH_SYNTHETIC_BONES);
+            for (int b = 0; b < BENCH_SYNTHETIC_BONES; b++) animations[a].framePoses[f][b] = RandomBoneTransform();
+        }
+    }
+    *count = 2;
+    return animations;
+}
+
+static void FreeSyntheticAnimations(ModelAnimation* animations, int count) {
+    for (int a = 0; a < count; a++) {
+        for (int f = 0; f < animations[a].frameCount; f++) free(animations[a].framePoses[f]);
+        free(animations[a].framePoses);
+    }
+    free(animations);
+}
+
+static float MaxMatrixDifference(const Matrix* a, const Matrix* b, int count) {
+    float maxDifference = 0.0f;
+    for (int i = 0; i < count; i++) {
+        const float* x = (const float*)&a[i];
+        const float* y = (const float*)&b[i];
+        for (int k = 0; k < 16; k++) {
+            float difference = fabsf(x[k] - y[k]);
+            if (difference > maxDifference) maxDifference = difference;
+        }
+    }
+    return maxDifference;
+}
+
+// Skinning matrices for crowds of animated characters: raymath the way
+// UpdateModelAnimationBones does it, the SIMD kernel on one thread, and the
+// SIMD kernel spread over the job system.
+static int RunAnimationBenchmark(void) {
+    const int crowdSizes[] = { 1, 100, 1000 };
+    const int sizeCount = sizeof(crowdSizes) / sizeof(crowdSizes[0]);
+    const char* modelPath = "assets/models/greenman.glb";
+    int mismatches = 0;
+    
+    srand(1);
+    
+    // No window here, so the bind pose is taken from the first frame
+    int animationCount = 0;
+    bool synthetic = !FileExists(modelPath);
+    ModelAnimation* animations = synthetic ? GenerateSyntheticAnimations(&animationCount)
+                                           : LoadModelAnimations(modelPath, &animationCount);
+    if (!animations || animationCount == 0 || animations[0].frameCount == 0) {
+        printf("No animations to benchmark\n");
+        return 1;
+    }
+    int boneCount = animations[0].boneCount;
+    const Transform* bindPose = animations[0].framePoses[0];
+    
+    JobSystem serialJobs, workerJobs;
+    InitJobSystem(&serialJobs, 0);
+    InitJobSystem(&workerJobs, -1);
+    
+    printf("Animation benchmark (%s kernel, %d workers + caller): %s, %d bones, %d clips\n",
+           AnimPoseKernelName(), workerJobs.workerCount, synthetic ? "synthetic skeleton" : modelPath,
+           boneCount, animationCount);
+    printf("%9s | %12s %12s %12s | %8s %10s\n", "instances", "raymath", "simd", "simd+jobs", "speedup", "max error");
+    
+    for (int s = 0; s < sizeCount; s++) {
+        int instances = crowdSizes[s];
+        int iterations = BENCH_ANIM_EVALUATIONS / instances;
+        
+        AnimPoseStage serialStage, jobStage;
+        AnimPoseRequest* requests = malloc(sizeof(AnimPoseRequest) * instances);
+        Matrix* reference = malloc(sizeof(Matrix) * boneCount * instances);
+        if (!requests || !reference ||
+            !InitAnimPoseStage(&serialStage, bindPose, boneCount, animations, animationCount, instances, &serialJobs)) {
+            printf("Out of memory at %d instances\n", instances);
+            free(requests);
+            free(reference);
+            break;
+        }
+        if (!InitAnimPoseStage(&jobStage, bindPose, boneCount, animations, animationCount, instances, &workerJobs)) {
+            printf("Out of memory at %d instances\n", instances);
+            FreeAnimPoseStage(&serialStage);
+            free(requests);
+            free(reference);
+            break;
+        }
+        for (int i = 0; i < instances; i++) {
+            requests[i] = (AnimPoseRequest){ i % animationCount, RandomRange(0.0f, (float)animations[i % animationCount].frameCount) };
+        }
+        
+        double start = GetMonotonicSeconds();
+        for (int it = 0; it < iterations; it++) {
+            for (int i = 0; i < instances; i++) {
+                EvaluateAnimPoseReference(&serialStage, requests[i], &reference[i * boneCount]);
+            }
+        }
+        double referenceTime = GetMonotonicSeconds() - start;
+        
+        start = GetMonotonicSeconds();
+        for (int it = 0; it < iterations; it++) {
+            KickAnimPoses(&serialStage, requests, instances);
+            FlushAnimPoses(&serialStage);
+        }
+        double serialTime = GetMonotonicSeconds() - start;
+        
+        start = GetMonotonicSeconds();
+        for (int it = 0; it < iterations; it++) {
+            KickAnimPoses(&jobStage, requests, instances);
+            FlushAnimPoses(&jobStage);
+        }
+        double jobTime = GetMonotonicSeconds() - start;
+        
+        float error = fmaxf(MaxMatrixDifference(reference, GetAnimPose(&serialStage, 0), boneCount * instances),
+                            MaxMatrixDifference(reference, GetAnimPose(&jobStage, 0), boneCount * instances));
+        if (error > 1e-4f) mismatches++;
+        
+        printf("%9d | %9.1f us %9.1f us %9.1f us | %7.1fx %10.2g\n", instances,
+               referenceTime * 1e6 / iterations, serialTime * 1e6 / iterations, jobTime * 1e6 / iterations,
+               referenceTime / jobTime, error);
+        
+        FreeAnimPoseStage(&serialStage);
+        FreeAnimPoseStage(&jobStage);
+        free(requests);
+        free(reference);
+    }
+    
+    FreeJobSystem(&serialJobs);
+    FreeJobSystem(&workerJobs);
+    if (synthetic) FreeSyntheticAnimations(animations, animationCount);
+    else UnloadModelAnimations(animations, animationCount);
+    
+    if (mismatches > 0) {
+        printf("MISMATCH: SIMD poses differ from raymath at %d crowd sizes\n", mismatches);
+        return 1;
+    }
+    printf("SIMD poses match raymath\n");
+    return 0;
+}
+
+// Warm-cache comparison of getting the character's animations from the GLB
+// versus the cooked file. Meshes need a GL context, so they aren't timed
+// here; the game logs both paths' startup times.
+static int RunLoadBenchmark(void) {
+    const char* modelPath = "assets/models/greenman.glb";
+    const int iterations = 20;
+    char cachePath[256];
+    GetModelCachePath(modelPath, cachePath, sizeof(cachePath));
+    
+    ModelCache cache;
+    if (!FileExists(modelPath) || !OpenModelCache(&cache, cachePath, modelPath)) {
+        printf("Load benchmark needs %s and a current %s (run `make cook`)\n", modelPath, cachePath);
+        return 1;
+    }
+    CloseModelCache(&cache);
+    
+    double start = GetMonotonicSeconds();
+    for (int it = 0; it < iterations; it++) {
+        int count = 0;
+        ModelAnimation* animations = LoadModelAnimations(modelPath, &count);
+        UnloadModelAnimations(animations, count);
+    }
+    double glbTime = (GetMonotonicSeconds() - start) / iterations;
+    
+    start = GetMonotonicSeconds();
+    for (int it = 0; it < iterations; it++) {
+        int count = 0;
+        OpenModelCache(&cache, cachePath, modelPath);
+        ModelAnimation* animations = LoadCachedAnimations(&cache, &count);
+        UnloadCachedAnimations(animations, count);
+        CloseModelCache(&cache);
+    }
+    double cacheTime = (GetMonotonicSeconds() - start) / iterations;
+    
+    // Every frame pose has to come back bit for bit
+    int glbCount = 0, cachedCount = 0, mismatches = 0;
+    ModelAnimation* glbAnimations = LoadModelAnimations(modelPath, &glbCount);
+    OpenModelCache(&cache, cachePath, modelPath);
+    ModelAnimation* cachedAnimations = LoadCachedAnimations(&cache, &cachedCount);
+    if (glbCount != cachedCount) mismatches++;
+    for (int a = 0; a < glbCount && a < cachedCount; a++) {
+        const ModelAnimation* expected = &glbAnimations[a];
+        const ModelAnimation* actual = &cachedAnimations[a];
+        if (expected->frameCount != actual->frameCount || expected->boneCount != actual->boneCount) {
+            mismatches++;
+            continue;
+        }
+        for (int f = 0; f < expected->frameCount; f++) {
+            if (memcmp(expected->framePoses[f], actual->framePoses[f], sizeof(Transform) * expected->boneCount) != 0) mismatches++;
+        }
+    }
+    
+    printf("Load benchmark (warm page cache, %d runs): %d animations\n", iterations, glbCount);
+    printf("  GLB parse:   %8.2f ms\n", glbTime * 1000.0);
+    printf("  cache mmap:  %8.3f ms (%.0fx faster, %.1f KB mapped)\n", cacheTime * 1000.0, glbTime / cacheTime, cache.size / 1024.0);
+    
+    UnloadCachedAnimations(cachedAnimations, cachedCount);
+    CloseModelCache(&cache);
+    UnloadModelAnimations(glbAnimations, glbCount);
+    
+    if (mismatches > 0) {
+        printf("MISMATCH: %d animations/frames differ between the GLB and the cache\n", mismatches);
+        return 1;
+    }
+    printf("Cached animations match the GLB\n");
+    return 0;
+}
+
+// Server tick cost and snapshot traffic as clients join, all in this
+// process over loopback, on a clean link and through the loss/latency shim.
+// Time is simulated (one tick per loop), so the run is as fast as the CPU
+// allows and the shim's delays are in game time.
+static int RunNetBenchmark(void) {
+    const int clientCounts[] = { 1, 2, 4, 8, 16, 32 };
+    const int countCount = sizeof(clientCounts) / sizeof(clientCounts[0]);
+    const NetShimConfig links[] = { { 0.0f, 0.0f, 0.0f }, { 5.0f, 50.0f, 10.0f } };
+    const char* linkNames[] = { "clean", "lossy" };
+    int mismatches = 0;
+    
+    // Connects, chops and new problems would drown the table
+    unsigned int logMask = logCategoryMask;
+    logCategoryMask = 0;
+    
+    NetServer* server = malloc(sizeof(NetServer));
+    NetClient* clients = malloc(sizeof(NetClient) * NET_MAX_CLIENTS);
+    if (!server || !clients) {
+        printf("Out of memory\n");
+        free(server);
+        free(clients);
+        logCategoryMask = logMask;
+        return 1;
+    }
+    
+    printf("Network benchmark: %d ticks at %d Hz, snapshots every %d ticks, interest radius %.0f\n",
+           BENCH_NET_TICKS, DEFAULT_TICK_RATE, NET_SNAPSHOT_INTERVAL, NET_INTEREST_RADIUS);
+    printf("%6s %8s | %12s %10s %12s | %10s %10s %8s %8s\n",
+           "link", "clients", "bytes/tick", "kbit/s", "server tick", "snapshots", "corrected", "largest", "rtt");
+    
+    for (int l = 0; l < 2; l++) {
+        for (int n = 0; n < countCount; n++) {
+            int clientCount = clientCounts[n];
+            SimulationConfig config = DefaultSimulationConfig();
+            if (!InitNetServer(server, &config, 0, &links[l])) {
+                printf("Could not start a server\n");
+                free(server);
+                free(clients);
+                logCategoryMask = logMask;
+                return 1;
+            }
+            int opened = 0;
+            while (opened < clientCount &&
+                   InitNetClient(&clients[opened], NetLoopback(server->socket.port), &links[l], 100 + opened)) opened++;
+            
+            for (unsigned int tick = 0; tick < BENCH_NET_TICKS && opened == clientCount; tick++) {
+                double now = (double)tick / DEFAULT_TICK_RATE;
+                for (int c = 0; c < clientCount; c++) {
+                    // Everyone walks the same loops, started at different points
+                    InputState input = ScriptedInput(tick + (unsigned int)c * 131);
+                    ClientTick(&clients[c], &input, now);
+                }
+                ServerTick(server, now);
+            }
+            
+            // Each client's latest view has to be exactly what the server sent
+            unsigned int corrections = 0, snapshots = 0;
+            float largest = 0.0f;
+            double rtt = 0.0;
+            for (int c = 0; c < opened; c++) {
+                const NetClient* client = &clients[c];
+                corrections += client->corrections;
+                snapshots += client->snapshots;
+                if (client->maxCorrection > largest) largest = client->maxCorrection;
+                rtt += client->rttSeconds / clientCount;
+                
+                const NetServerClient* serverClient = &server->clients[client->slot];
+                const NetView* sent = &serverClient->views[client->latestSnapshot % NET_VIEW_HISTORY];
+                if (!client->connected || client->view == NULL || sent->sequence != client->latestSnapshot ||
+                    !NetViewsEqual(client->view, sent, server->sim.treeCount)) mismatches++;
+            }
+            
+            double bytesPerTick = ServerBytesPerClientTick(server);
+            printf("%6s %8d | %12.1f %10.1f %9.3f ms | %10u %10u %8.3f %5.0f ms\n",
+                   linkNames[l], clientCount, bytesPerTick, bytesPerTick * DEFAULT_TICK_RATE * 8.0 / 1000.0,
+                   server->tickSeconds * 1000.0 / server->ticks, snapshots, corrections, largest, rtt * 1000.0);
+            
+            for (int c = 0; c < opened; c++) FreeNetClient(&clients[c]);
+            FreeNetServer(server);
+        }
+    }
+    
+    free(server);
+    free(clients);
+    logCategoryMask = logMask;
+    
+    if (mismatches > 0) {
+        printf("MISMATCH: %d client views differ from what the server sent\n", mismatches);
+        return 1;
+    }
+    printf("Every client view matches the server's\n");
+    return 0;
+}
+
+// Save and resume worlds from a few hundred to over 100k trees: capture
+// (what the simulation job pays), write, and load. The resumed world then
+// plays on next to the original, and both have to end up the same.
+static int RunSaveBenchmark(void) {
+    const int treeCounts[] = { 20, 500, 2100 };
+    const int countCount = sizeof(treeCounts) / sizeof(treeCounts[0]);
+    const int botCount = 100;
+    int mismatches = 0;
+    
+    unsigned int logMask = logCategoryMask;
+    logCategoryMask = 0;
+    
+    printf("Save benchmark: %d bots, %d ticks played, then saved, resumed and played %d more\n",
+           botCount, BENCH_SAVE_TICKS, BENCH_SAVE_TICKS);
+    printf("%10s %10s | %10s %10s %10s | %s\n", "trees", "size", "capture", "write", "load", "resumed");
+    
+    for (int n = 0; n < countCount; n++) {
+        SimulationConfig config = DefaultSimulationConfig();
+        config.treesPerChunk = treeCounts[n];
+        config.botCount = botCount;
+        Simulation sim;
+        if (!InitSimulation(&sim, &config)) {
+            printf("Out of memory\n");
+            logCategoryMask = logMask;
+            return 1;
+        }
+        for (unsigned int tick = 0; tick < BENCH_SAVE_TICKS; tick++) {
+            InputState input = ScriptedInput(sim.tick);
+            StepSimulation(&sim, &input);
+        }
+        
+        SaveBuffer buffer = { 0 };
+        double captureSeconds = 0.0, writeSeconds = 0.0, loadSeconds = 0.0;
+        bool saved = true;
+        Simulation resumed = { 0 };
+        bool loaded = false;
+        for (int run = 0; run < BENCH_SAVE_RUNS && saved; run++) {
+            double start = GetMonotonicSeconds();
+            saved = CaptureSave(&buffer, &sim);
+            double captured = GetMonotonicSeconds();
+            saved = saved && WriteSaveFile(&buffer, BENCH_SAVE_PATH);
+            double written = GetMonotonicSeconds();
+            if (loaded) FreeSimulation(&resumed);
+            loaded = saved && LoadSimulation(&resumed, BENCH_SAVE_PATH, NULL);
+            captureSeconds += captured - start;
+            writeSeconds += written - captured;
+            loadSeconds += GetMonotonicSeconds() - written;
+        }
+        remove(BENCH_SAVE_PATH);
+        
+        bool same = loaded;
+        for (unsigned int tick = 0; tick < BENCH_SAVE_TICKS && same; tick++) {
+            InputState input = ScriptedInput(sim.tick);
+            StepSimulation(&sim, &input);
+            StepSimulation(&resumed, &input);
+        }
+        same = same && SimulationChecksum(&sim) == SimulationChecksum(&resumed);
+        if (!same) mismatches++;
+        
+        printf("%10d %7.1f MB | %7.2f ms %7.2f ms %7.2f ms | %s\n", sim.treeCount, buffer.size / (1024.0 * 1024.0),
+               captureSeconds * 1000.0 / BENCH_SAVE_RUNS, writeSeconds * 1000.0 / BENCH_SAVE_RUNS,
+               loadSeconds * 1000.0 / BENCH_SAVE_RUNS, same ? "same" : "DIFFERENT");
+        
+        FreeSaveBuffer(&buffer);
+        if (loaded) FreeSimulation(&resumed);
+        FreeSimulation(&sim);
+    }
+    logCategoryMask = logMask;
+    
+    if (mismatches > 0) {
+        printf("MISMATCH: %d resumed worlds played on differently\n", mismatches);
+        return 1;
+    }
+    printf("Every resumed world plays on exactly like the one saved\n");
+    return 0;
+}
+
+int RunBenchmark(const char* name) {
+    if (strcmp(name, "grid") == 0) return RunGridBenchmark();
+    if (strcmp(name, "chop") == 0) return RunChopBenchmark();
+    if (strcmp(name, "anim") == 0) return RunAnimationBenchmark();
+    if (strcmp(name, "load") == 0) return RunLoadBenchmark();
+    if (strcmp(name, "net") == 0) return RunNetBenchmark();
+    if (strcmp(name, "save") == 0) return RunSaveBenchmark();
+    
+    printf("Unknown benchmark: %s (available: grid, chop, anim, load, net, save)\n", name);
+    return 1;
+}
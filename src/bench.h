@@ -0,0 +1,8 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Run a named micro-benchmark without a window and print the results.
+// Returns the process exit code (non-zero for an unknown name or a mismatch).
+int RunBenchmark(const char* name);
+
+#endif // BENCH_H
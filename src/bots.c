@@ -0,0 +1,143 @@
+#include "raylib.h"
+#include "raymath.h"
+#include "bots.h"
+#include "logger.h"
+#include "timer.h"
+#include <math.h>
+
+#define BOT_STREAM 3              // Rng stream for spawning, apart from the world's and the problems'
+#define STEER_THRESHOLD 0.38f     // sin(22.5 degrees): press the keys of the nearest of 8 directions
+
+static float DistanceXZ(Vector3 a, Vector3 b) {
+    float dx = b.x - a.x;
+    float dz = b.z - a.z;
+    return sqrtf(dx * dx + dz * dz);
+}
+
+void SpawnBots(Bot* bots, int count, unsigned int seed) {
+    Rng rng;
+    SeedRng(&rng, seed, BOT_STREAM);
+    for (int i = 0; i < count; i++) {
+        float angle = RngFloat(&rng) * 2.0f * PI;
+        float radius = BOT_SPAWN_RADIUS * sqrtf(RngFloat(&rng));
+        bots[i] = (Bot){
+            .player = {
+                .position = (Vector3){ cosf(angle) * radius, 0.0f, sinf(angle) * radius },
+                .speed = 6.0f + 3.0f * RngFloat(&rng), // A bit slower than the player
+                .rotationY = RngFloat(&rng) * 360.0f
+            },
+            .target = -1,
+            .pendingChop = -1
+        };
+    }
+}
+
+// The same keys a player would hold to walk from one point to another
+static void Steer(InputState* input, Vector3 from, Vector3 to) {
+    float dx = to.x - from.x;
+    float dz = to.z - from.z;
+    float length = sqrtf(dx * dx + dz * dz);
+    if (length <= 0.0f) return;
+    dx /= length;
+    dz /= length;
+    input->moveRight = dx > STEER_THRESHOLD;
+    input->moveLeft = dx < -STEER_THRESHOLD;
+    input->moveBack = dz > STEER_THRESHOLD;
+    input->moveForward = dz < -STEER_THRESHOLD;
+}
+
+static bool IsTargetValid(const Simulation* sim, int target) {
+    return target >= 0 && sim->trees[target].exists &&
+           sim->trees[target].answerNumber == sim->gameState.currentProblem.correctAnswer;
+}
+
+// The right answer among the trees in sight, if there is one
+static int FindBotTarget(Simulation* sim, const Bot* bot) {
+    int count = QueryTreesInRadius(sim->trees, &sim->treeGrid, bot->player.position, BOT_SIGHT_RADIUS,
+                                   sim->queryResults, sim->treeCount);
+    for (int k = 0; k < count; k++) {
+        if (IsTargetValid(sim, sim->queryResults[k])) return sim->queryResults[k];
+    }
+    return -1;
+}
+
+void StepBots(Simulation* sim) {
+    if (sim->botCount <= 0) return;
+    float deltaTime = 1.0f / sim->tickRate;
+    BotStats* stats = &sim->botStats;
+
+    // Move: walk at the target until in reach, or toward the player
+    // while there's nothing to go for
+    double start = GetMonotonicSeconds();
+    for (int i = 0; i < sim->botCount; i++) {
+        Bot* bot = &sim->bots[i];
+        if (bot->cooldown > 0) bot->cooldown--;
+        if (!IsTargetValid(sim, bot->target)) bot->target = -1;
+
+        InputState input = { 0 };
+        Vector3 position = bot->player.position;
+        if (bot->target >= 0) {
+            Vector3 target = sim->trees[bot->target].position;
+            if (bot->turn || DistanceXZ(position, target) > BOT_STOP_DISTANCE) Steer(&input, position, target);
+            bot->turn = false;
+        } else if (DistanceXZ(position, sim->player.position) > BOT_GATHER_RADIUS) {
+            Steer(&input, position, sim->player.position);
+        }
+        bot->moveFrom = position;
+        UpdatePlayer(&bot->player, &sim->gameCamera, &input, deltaTime);
+    }
+    double stepped = GetMonotonicSeconds();
+
+    // Collide: one pass over every bot, so the broadphase grid and the
+    // narrowphase scratch stay hot in cache
+    for (int i = 0; i < sim->botCount; i++) {
+        Bot* bot = &sim->bots[i];
+        bot->player.position = CollideMover(&sim->collision, bot->moveFrom, bot->player.position, PLAYER_RADIUS);
+    }
+    double moved = GetMonotonicSeconds();
+
+    // Query: bots without a target look around on their turn; bots standing
+    // in reach swing with the same chop query as the player
+    for (int i = 0; i < sim->botCount; i++) {
+        Bot* bot = &sim->bots[i];
+        bot->pendingChop = -1;
+        if (bot->target < 0 && (sim->tick + i) % BOT_REPLAN_TICKS == 0) bot->target = FindBotTarget(sim, bot);
+        if (bot->target < 0 || bot->cooldown > 0 || bot->player.isMoving) continue;
+        if (DistanceXZ(bot->player.position, sim->trees[bot->target].position) > CHOP_RANGE) continue;
+
+        bot->pendingChop = FindSimulationChopTarget(sim, &bot->player);
+        bot->cooldown = BOT_CHOP_COOLDOWN;
+        if (bot->pendingChop < 0) bot->turn = true; // Facing off to the side
+    }
+    double queried = GetMonotonicSeconds();
+
+    // Score, in bot order. An earlier bot may have felled the same tree this
+    // tick (it has regrown elsewhere by now), so each swing is checked again.
+    for (int i = 0; i < sim->botCount; i++) {
+        Bot* bot = &sim->bots[i];
+        int tree = bot->pendingChop;
+        if (tree < 0) continue;
+        if (!sim->trees[tree].exists ||
+            !IsTreeInChopRange(bot->player.position, PlayerForward(&bot->player), sim->trees[tree].position)) continue;
+
+        stats->chops++;
+        if (ChopTree(sim, &bot->player, tree, &bot->score)) stats->correctChops++;
+    }
+    double scored = GetMonotonicSeconds();
+
+    stats->moveSeconds += stepped - start;
+    sim->collision.stats.seconds += moved - stepped;
+    stats->querySeconds += queried - moved;
+    stats->scoreSeconds += scored - queried;
+    stats->ticks++;
+}
+
+void PrintBotStats(const BotStats* stats, int botCount) {
+    if (botCount <= 0 || stats->ticks == 0) return;
+    double msPerTick = 1000.0 / stats->ticks;
+    double total = stats->moveSeconds + stats->querySeconds + stats->scoreSeconds;
+    LOGI(LOG_CAT_BOTS, "Bots: %d, %u chops (%u right) in %u ticks", botCount, stats->chops, stats->correctChops, stats->ticks);
+    LOGI(LOG_CAT_BOTS, "Bot cost per tick: move %.3f ms, query %.3f ms, score %.3f ms, total %.3f ms (%.3f us per bot)",
+         stats->moveSeconds * msPerTick, stats->querySeconds * msPerTick, stats->scoreSeconds * msPerTick,
+         total * msPerTick, total * msPerTick * 1000.0 / botCount);
+}
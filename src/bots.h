@@ -0,0 +1,23 @@
+#ifndef BOTS_H
+#define BOTS_H
+
+#include "game.h"
+
+#define BOT_SPAWN_RADIUS 24.0f    // Bots start scattered over a disc around the origin
+#define BOT_SIGHT_RADIUS 24.0f    // How far a bot looks for the right answer
+#define BOT_GATHER_RADIUS 12.0f   // Without a target, bots close in on the player (answers are near them)
+#define BOT_STOP_DISTANCE 2.5f    // Close enough to swing at the target
+#define BOT_REPLAN_TICKS 10       // A bot looks around every this many ticks, staggered across bots
+#define BOT_CHOP_COOLDOWN 15      // Ticks between swings, as fast as the scripted player
+
+// Scatter the bots around the start from their own random stream
+void SpawnBots(Bot* bots, int count, unsigned int seed);
+
+// One tick for every bot, in three timed phases: steer and move, look for
+// targets and chop targets, then score the chops in bot order
+void StepBots(Simulation* sim);
+
+// Average per-tick cost of each phase, in milliseconds
+void PrintBotStats(const BotStats* stats, int botCount);
+
+#endif // BOTS_H
@@ -0,0 +1,17 @@
+#include "raylib.h"
+#include "raymath.h"
+#include "chop.h"
+
+bool IsTreeInChopRange(Vector3 playerPosition, Vector3 forward, Vector3 treePosition) {
+    Vector3 toTree = Vector3Subtract(treePosition, playerPosition);
+    float distance = Vector3Length(toTree);
+    
+    // Check if tree is within range
+    if (distance > CHOP_RANGE) return false;
+    
+    // Check if tree is roughly in front of player
+    Vector3 normalizedToTree = Vector3Normalize(toTree);
+    float dot = Vector3DotProduct(forward, normalizedToTree);
+    
+    return dot > CHOP_CONE_COS;
+}
@@ -0,0 +1,14 @@
+#ifndef CHOP_H
+#define CHOP_H
+
+#include "raylib.h"
+#include <stdbool.h>
+
+#define CHOP_RANGE 4.0f
+#define CHOP_CONE_COS 0.5f        // Trees count as in front within ~60 degrees of facing
+
+// Exact chop test: within CHOP_RANGE and inside the facing cone. The
+// simulation and the SIMD kernel in tree_soa.c both settle on this.
+bool IsTreeInChopRange(Vector3 playerPosition, Vector3 forward, Vector3 treePosition);
+
+#endif // CHOP_H
@@ -0,0 +1,225 @@
+#include "raylib.h"
+#include "collision.h"
+#include "logger.h"
+#include <math.h>
+#include <stdlib.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define COLLISION_AVX2
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define COLLISION_SSE2
+#endif
+
+// The wide test only picks lanes for the exact one; widening it a little
+// keeps it a superset whatever the rounding
+#define OVERLAP_MARGIN 1.0001f
+#define FAR_AWAY 1e30f            // Padding boxes, never near anything
+#define SEPARATION 1e-4f          // Pushed out this much past touching, so the next step starts clear
+
+bool InitCollisionWorld(CollisionWorld* world, int capacity) {
+    *world = (CollisionWorld){ 0 };
+    int padded = ((capacity > 0 ? capacity : 1) + 7) & ~7;
+
+    world->minX = malloc(sizeof(float) * padded);
+    world->minZ = malloc(sizeof(float) * padded);
+    world->maxX = malloc(sizeof(float) * padded);
+    world->maxZ = malloc(sizeof(float) * padded);
+    world->candidates = malloc(sizeof(int) * padded);
+    world->batchMinX = malloc(sizeof(float) * padded);
+    world->batchMinZ = malloc(sizeof(float) * padded);
+    world->batchMaxX = malloc(sizeof(float) * padded);
+    world->batchMaxZ = malloc(sizeof(float) * padded);
+    if (!world->minX || !world->minZ || !world->maxX || !world->maxZ || !world->candidates ||
+        !world->batchMinX || !world->batchMinZ || !world->batchMaxX || !world->batchMaxZ ||
+        !InitTreeGrid(&world->grid, padded, COLLISION_CELL_SIZE)) {
+        FreeCollisionWorld(world);
+        return false;
+    }
+
+    world->capacity = capacity;
+    return true;
+}
+
+void FreeCollisionWorld(CollisionWorld* world) {
+    free(world->minX);
+    free(world->minZ);
+    free(world->maxX);
+    free(world->maxZ);
+    free(world->candidates);
+    free(world->batchMinX);
+    free(world->batchMinZ);
+    free(world->batchMaxX);
+    free(world->batchMaxZ);
+    FreeTreeGrid(&world->grid);
+    *world = (CollisionWorld){ 0 };
+}
+
+void SetObstacle(CollisionWorld* world, int index, Vector3 center, float halfSize) {
+    if (index < 0 || index >= world->capacity) return;
+    world->minX[index] = center.x - halfSize;
+    world->minZ[index] = center.z - halfSize;
+    world->maxX[index] = center.x + halfSize;
+    world->maxZ[index] = center.z + halfSize;
+    TreeGridRemove(&world->grid, index);
+    TreeGridInsert(&world->grid, index, center);
+}
+
+void RemoveObstacle(CollisionWorld* world, int index) {
+    TreeGridRemove(&world->grid, index);
+}
+
+// Boxes [base, base + 8) of the batch whose nearest point may be within the
+// radius of (px, pz), one bit per box
+static unsigned int OverlapMask(const CollisionWorld* world, int base, float px, float pz, float radiusSqr) {
+#if defined(COLLISION_AVX2)
+    __m256 x = _mm256_set1_ps(px);
+    __m256 z = _mm256_set1_ps(pz);
+    __m256 dx = _mm256_sub_ps(x, _mm256_min_ps(_mm256_max_ps(x, _mm256_loadu_ps(world->batchMinX + base)),
+                                               _mm256_loadu_ps(world->batchMaxX + base)));
+    __m256 dz = _mm256_sub_ps(z, _mm256_min_ps(_mm256_max_ps(z, _mm256_loadu_ps(world->batchMinZ + base)),
+                                               _mm256_loadu_ps(world->batchMaxZ + base)));
+    __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dz, dz));
+    return (unsigned int)_mm256_movemask_ps(_mm256_cmp_ps(d2, _mm256_set1_ps(radiusSqr), _CMP_LT_OQ));
+#elif defined(COLLISION_SSE2)
+    __m128 x = _mm_set1_ps(px);
+    __m128 z = _mm_set1_ps(pz);
+    __m128 limit = _mm_set1_ps(radiusSqr);
+
+    // Two 4-wide halves make up one block of 8
+    unsigned int mask = 0;
+    for (int half = 0; half < 2; half++) {
+        int offset = base + half * 4;
+        __m128 dx = _mm_sub_ps(x, _mm_min_ps(_mm_max_ps(x, _mm_loadu_ps(world->batchMinX + offset)),
+                                             _mm_loadu_ps(world->batchMaxX + offset)));
+        __m128 dz = _mm_sub_ps(z, _mm_min_ps(_mm_max_ps(z, _mm_loadu_ps(world->batchMinZ + offset)),
+                                             _mm_loadu_ps(world->batchMaxZ + offset)));
+        __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+        mask |= (unsigned int)_mm_movemask_ps(_mm_cmplt_ps(d2, limit)) << (half * 4);
+    }
+    return mask;
+#else
+    unsigned int mask = 0;
+    for (int lane = 0; lane < 8; lane++) {
+        float dx = px - fminf(fmaxf(px, world->batchMinX[base + lane]), world->batchMaxX[base + lane]);
+        float dz = pz - fminf(fmaxf(pz, world->batchMinZ[base + lane]), world->batchMaxZ[base + lane]);
+        if (dx * dx + dz * dz < radiusSqr) mask |= 1u << lane;
+    }
+    return mask;
+#endif
+}
+
+// Exact circle against one box: how deep it's in and which way is out
+static float Penetration(const CollisionWorld* world, int b, Vector2 p, float radius, Vector2* normal) {
+    float minX = world->batchMinX[b], maxX = world->batchMaxX[b];
+    float minZ = world->batchMinZ[b], maxZ = world->batchMaxZ[b];
+    float dx = p.x - fminf(fmaxf(p.x, minX), maxX);
+    float dz = p.y - fminf(fmaxf(p.y, minZ), maxZ);
+    float d2 = dx * dx + dz * dz;
+    if (d2 >= radius * radius) return 0.0f;
+
+    if (d2 > 0.0f) {
+        float distance = sqrtf(d2);
+        *normal = (Vector2){ dx / distance, dz / distance };
+        return radius - distance;
+    }
+
+    // Center inside the box: out through the nearest side
+    float left = p.x - minX, right = maxX - p.x, back = p.y - minZ, front = maxZ - p.y;
+    float nearest = fminf(fminf(left, right), fminf(back, front));
+    if (nearest == left) *normal = (Vector2){ -1.0f, 0.0f };
+    else if (nearest == right) *normal = (Vector2){ 1.0f, 0.0f };
+    else if (nearest == back) *normal = (Vector2){ 0.0f, -1.0f };
+    else *normal = (Vector2){ 0.0f, 1.0f };
+    return nearest + radius;
+}
+
+// Push out of the deepest overlap, a few times over; each push keeps the
+// motion along the surface and removes only the part into it
+static Vector2 ResolveStep(CollisionWorld* world, Vector2 p, float radius, int batchCount) {
+    float radiusSqr = radius * radius * OVERLAP_MARGIN;
+    for (int iteration = 0; iteration < COLLISION_ITERATIONS; iteration++) {
+        float deepest = 0.0f;
+        Vector2 normal = { 0.0f, 0.0f };
+        for (int base = 0; base < batchCount; base += 8) {
+            unsigned int mask = OverlapMask(world, base, p.x, p.y, radiusSqr);
+            while (mask != 0) {
+                int lane = __builtin_ctz(mask);
+                Vector2 laneNormal;
+                float depth = Penetration(world, base + lane, p, radius, &laneNormal);
+                if (depth > deepest) {
+                    deepest = depth;
+                    normal = laneNormal;
+                }
+                mask &= mask - 1;
+            }
+        }
+        if (deepest <= 0.0f) break;
+
+        p.x += normal.x * (deepest + SEPARATION);
+        p.y += normal.y * (deepest + SEPARATION);
+        world->stats.contacts++;
+    }
+    return p;
+}
+
+Vector3 CollideMover(CollisionWorld* world, Vector3 from, Vector3 to, float radius) {
+    float moveX = to.x - from.x;
+    float moveZ = to.z - from.z;
+    world->stats.moves++;
+
+    // Broadphase: everything whose cell meets the swept bounds, grown by the
+    // largest obstacle and twice the radius (a push-out can carry the
+    // mover a radius past the path)
+    float reach = 2.0f * radius + COLLISION_MAX_HALF_SIZE;
+    int count = TreeGridQueryRect(&world->grid, fminf(from.x, to.x) - reach, fminf(from.z, to.z) - reach,
+                                  fmaxf(from.x, to.x) + reach, fmaxf(from.z, to.z) + reach,
+                                  world->candidates, world->capacity);
+    world->stats.candidates += (unsigned long long)count;
+    if (count == 0) return to;
+
+    // Gather the candidates contiguously for the narrowphase
+    int batchCount = (count + 7) & ~7;
+    for (int k = 0; k < count; k++) {
+        int i = world->candidates[k];
+        world->batchMinX[k] = world->minX[i];
+        world->batchMinZ[k] = world->minZ[i];
+        world->batchMaxX[k] = world->maxX[i];
+        world->batchMaxZ[k] = world->maxZ[i];
+    }
+    for (int k = count; k < batchCount; k++) {
+        world->batchMinX[k] = world->batchMinZ[k] = FAR_AWAY;
+        world->batchMaxX[k] = world->batchMaxZ[k] = FAR_AWAY;
+    }
+
+    // Steps no longer than the radius can't skip over a box. A mover that
+    // stood still still gets one, in case a tree grew or loaded onto it.
+    float length = sqrtf(moveX * moveX + moveZ * moveZ);
+    int steps = (int)ceilf(length / radius);
+    if (steps < 1) steps = 1;
+    Vector2 p = { from.x, from.z };
+    for (int s = 0; s < steps; s++) {
+        p.x += moveX / steps;
+        p.y += moveZ / steps;
+        p = ResolveStep(world, p, radius, batchCount);
+    }
+    return (Vector3){ p.x, to.y, p.y };
+}
+
+void PrintCollisionStats(const CollisionStats* stats) {
+    if (stats->ticks == 0) return;
+    LOGI(LOG_CAT_PERF, "Collision (%s): %.3f ms per tick, %.1f movers, %.1f candidates and %.2f contacts per tick",
+         CollisionKernelName(), stats->seconds * 1000.0 / stats->ticks, (double)stats->moves / stats->ticks,
+         (double)stats->candidates / stats->ticks, (double)stats->contacts / stats->ticks);
+}
+
+const char* CollisionKernelName(void) {
+#if defined(COLLISION_AVX2)
+    return "AVX2";
+#elif defined(COLLISION_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
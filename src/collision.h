@@ -0,0 +1,63 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "raylib.h"
+#include "tree_grid.h"
+
+#define COLLISION_CELL_SIZE 2.0f  // Broadphase cells; obstacles are small and moves are short
+#define COLLISION_MAX_HALF_SIZE 0.5f  // No obstacle reaches further than this from its center
+#define COLLISION_ITERATIONS 4    // Push-outs per step, enough to settle into a corner between two boxes
+#define TRUNK_HALF_SIZE 0.25f     // The drawn trunk is 0.5 wide
+#define ROCK_HALF_SIZE 0.4f       // Rocks are 0.8 wide (static_scene.c)
+
+// What collision cost, summed over every tick so far. Seconds are added by
+// whoever runs the stage; the counters by CollideMover.
+typedef struct {
+    double seconds;
+    unsigned int ticks;
+    unsigned long long moves;        // Movers tested
+    unsigned long long candidates;   // Boxes the broadphase passed to the narrowphase
+    unsigned long long contacts;     // Push-outs
+} CollisionStats;
+
+// Static obstacles as axis-aligned boxes on the XZ plane. They all stand on
+// the ground and are shorter than a character's capsule, so capsule against
+// box reduces to circle against rectangle. The broadphase is a hashed grid
+// over box centers; the narrowphase tests 8 boxes at a time.
+typedef struct {
+    int capacity;
+    float* minX;          // Per obstacle
+    float* minZ;
+    float* maxX;
+    float* maxZ;
+    TreeGrid grid;        // Obstacles that exist, by center
+    int* candidates;      // Scratch for broadphase queries
+    float* batchMinX;     // The candidates' boxes gathered for the narrowphase, padded to 8
+    float* batchMinZ;
+    float* batchMaxX;
+    float* batchMaxZ;
+    CollisionStats stats;
+} CollisionWorld;
+
+bool InitCollisionWorld(CollisionWorld* world, int capacity);
+void FreeCollisionWorld(CollisionWorld* world);
+
+// Add an obstacle or move it; halfSize is its extent on X and Z
+void SetObstacle(CollisionWorld* world, int index, Vector3 center, float halfSize);
+void RemoveObstacle(CollisionWorld* world, int index);
+
+// Where a circle of the given radius moving from `from` toward `to` ends up.
+// The move is swept in steps no longer than the radius, so nothing is
+// tunneled through; each step pushes the circle out of the boxes it
+// overlaps, which keeps the motion along a surface (sliding) and drops the
+// part into it. A mover standing still is pushed out of whatever appeared
+// on it. Not thread safe: the world keeps one set of scratch arrays.
+Vector3 CollideMover(CollisionWorld* world, Vector3 from, Vector3 to, float radius);
+
+// Average per-tick cost and traffic of the stage
+void PrintCollisionStats(const CollisionStats* stats);
+
+// Which narrowphase kernel was compiled in ("AVX2", "SSE2" or "scalar")
+const char* CollisionKernelName(void);
+
+#endif // COLLISION_H
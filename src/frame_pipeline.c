@@ -0,0 +1,125 @@
+#include "frame_pipeline.h"
+#include "timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+static void CaptureFrame(FramePipeline* pipeline, FrameSnapshot* frame) {
+    const Simulation* sim = pipeline->sim;
+    frame->tick = sim->tick;
+    frame->ticks = pipeline->tickCount;
+    frame->player = InterpolatePlayer(&pipeline->previousPlayer, &sim->player, pipeline->alpha);
+    frame->camera = InterpolateCamera(&pipeline->previousCamera, &sim->gameCamera.camera, pipeline->alpha);
+    frame->gameState = sim->gameState;
+    frame->equipment = sim->equipment;
+    frame->currentAnimation = sim->currentAnimation;
+    frame->currentFrame = sim->currentFrame;
+
+    // Trees only change on a chop, so most frames skip the copy
+    if (frame->treesVersion != sim->treesVersion) {
+        memcpy(frame->trees, sim->trees, sizeof(Tree) * sim->treeCount);
+        frame->treesVersion = sim->treesVersion;
+    }
+    frame->treeCount = sim->treeCount;
+    if (frame->layoutVersion != sim->layoutVersion) {
+        frame->chunkCount = 0;
+        for (int s = 0; s < CHUNK_POOL_SIZE; s++) {
+            const Chunk* chunk = &sim->chunks.chunks[s];
+            if (chunk->state == CHUNK_LOADED) frame->chunks[frame->chunkCount++] = chunk->layout;
+        }
+        frame->layoutVersion = sim->layoutVersion;
+    }
+    for (int i = 0; i < sim->botCount; i++) frame->bots[i] = sim->bots[i].player;
+    frame->botCount = sim->botCount;
+    frame->botStats = sim->botStats;
+    frame->collisionStats = sim->collision.stats;
+
+    // The renderer's tree query, done here while the grid can't change under it
+    frame->visibleCount = QueryTreesInRadius(sim->trees, &sim->treeGrid, frame->camera.target, pipeline->drawDistance,
+                                             frame->visibleTrees, sim->treeCount);
+}
+
+static void SimulateFrame(void* userData, int begin, int end) {
+    (void)begin;
+    (void)end;
+    FramePipeline* pipeline = userData;
+    Simulation* sim = pipeline->sim;
+
+    for (int t = 0; t < pipeline->tickCount; t++) {
+        pipeline->previousPlayer = sim->player;
+        pipeline->previousCamera = sim->gameCamera.camera;
+        double start = GetMonotonicSeconds();
+        StepSimulation(sim, &pipeline->tickInputs[t]);
+        pipeline->tickSeconds[t] = GetMonotonicSeconds() - start;
+    }
+    if (pipeline->saveWriter != NULL) {
+        RequestSave(pipeline->saveWriter, sim);
+        pipeline->saveWriter = NULL;
+    }
+    CaptureFrame(pipeline, &pipeline->frames[pipeline->front ^ 1]);
+}
+
+bool InitFramePipeline(FramePipeline* pipeline, Simulation* sim, JobSystem* jobs, int maxTicksPerFrame, float drawDistance) {
+    *pipeline = (FramePipeline){ 0 };
+    pipeline->jobs = jobs;
+    pipeline->sim = sim;
+    pipeline->drawDistance = drawDistance;
+    pipeline->tickCapacity = (maxTicksPerFrame > 0) ? maxTicksPerFrame : 1;
+    pipeline->tickInputs = malloc(sizeof(InputState) * pipeline->tickCapacity);
+    pipeline->tickSeconds = malloc(sizeof(double) * pipeline->tickCapacity);
+
+    int treeSlots = (sim->treeCount > 0) ? sim->treeCount : 1;
+    int botSlots = (sim->botCount > 0) ? sim->botCount : 1;
+    bool allocated = pipeline->tickInputs && pipeline->tickSeconds;
+    for (int i = 0; i < 2; i++) {
+        FrameSnapshot* frame = &pipeline->frames[i];
+        frame->trees = malloc(sizeof(Tree) * treeSlots);
+        frame->visibleTrees = malloc(sizeof(int) * treeSlots);
+        frame->bots = malloc(sizeof(Player) * botSlots);
+        frame->treesVersion = sim->treesVersion - 1; // Copy on first capture
+        frame->layoutVersion = sim->layoutVersion - 1;
+        allocated = allocated && frame->trees && frame->visibleTrees && frame->bots;
+    }
+    if (!allocated) {
+        FreeFramePipeline(pipeline);
+        return false;
+    }
+
+    pipeline->previousPlayer = sim->player;
+    pipeline->previousCamera = sim->gameCamera.camera;
+    CaptureFrame(pipeline, &pipeline->frames[pipeline->front]);
+    return true;
+}
+
+void FreeFramePipeline(FramePipeline* pipeline) {
+    if (pipeline->jobs != NULL) WaitForJobs(pipeline->jobs, &pipeline->counter);
+    for (int i = 0; i < 2; i++) {
+        free(pipeline->frames[i].trees);
+        free(pipeline->frames[i].visibleTrees);
+        free(pipeline->frames[i].bots);
+    }
+    free(pipeline->tickInputs);
+    free(pipeline->tickSeconds);
+    *pipeline = (FramePipeline){ 0 };
+}
+
+void KickSimulationFrame(FramePipeline* pipeline, const InputState* inputs, int tickCount, float alpha) {
+    if (tickCount > pipeline->tickCapacity) tickCount = pipeline->tickCapacity;
+    if (tickCount < 0) tickCount = 0;
+    memcpy(pipeline->tickInputs, inputs, sizeof(InputState) * tickCount);
+    pipeline->tickCount = tickCount;
+    pipeline->alpha = alpha;
+    SubmitJob(pipeline->jobs, SimulateFrame, pipeline, &pipeline->counter);
+}
+
+void RequestFrameSave(FramePipeline* pipeline, SaveWriter* writer) {
+    pipeline->saveWriter = writer;
+}
+
+void FinishSimulationFrame(FramePipeline* pipeline) {
+    WaitForJobs(pipeline->jobs, &pipeline->counter);
+    pipeline->front ^= 1;
+}
+
+const FrameSnapshot* GetFrameSnapshot(const FramePipeline* pipeline) {
+    return &pipeline->frames[pipeline->front];
+}
@@ -0,0 +1,78 @@
+#ifndef FRAME_PIPELINE_H
+#define FRAME_PIPELINE_H
+
+#include "raylib.h"
+#include "game.h"
+#include "input.h"
+#include "job_system.h"
+#include "save_game.h"
+
+// What the main thread draws for one frame, copied out of the simulation
+// so the next ticks can run on a worker while this one is drawn
+typedef struct {
+    unsigned int tick;
+    int ticks;                // Ticks stepped to produce this frame
+    Player player;            // Blended between the last two ticks
+    Camera3D camera;          // Likewise
+    GameState gameState;
+    Equipment equipment;
+    int currentAnimation;
+    int currentFrame;
+
+    Tree* trees;              // Copied only when treesVersion changes
+    int treeCount;
+    unsigned int treesVersion;
+    ChunkLayout chunks[CHUNK_POOL_SIZE]; // Loaded chunks, copied only when layoutVersion changes
+    int chunkCount;
+    unsigned int layoutVersion;
+    Player* bots;             // As of the last tick, not blended
+    int botCount;
+    BotStats botStats;
+    CollisionStats collisionStats;
+
+    int* visibleTrees;        // Trees within the draw distance of the camera target
+    int visibleCount;
+} FrameSnapshot;
+
+// Two snapshots: the main thread draws the front one while a job steps the
+// simulation and captures the back one. The simulation belongs to that job
+// from KickSimulationFrame until FinishSimulationFrame returns.
+typedef struct {
+    JobSystem* jobs;
+    Simulation* sim;
+    FrameSnapshot frames[2];
+    int front;
+    JobCounter counter;
+    float drawDistance;
+
+    // Input of the job in flight
+    InputState* tickInputs;
+    int tickCapacity;
+    int tickCount;
+    float alpha;
+    Player previousPlayer;    // State before the last tick, to blend from
+    Camera3D previousCamera;
+    SaveWriter* saveWriter;   // Capture a save after the ticks, NULL for none
+
+    double* tickSeconds;      // How long each of those ticks took
+} FramePipeline;
+
+// The front snapshot starts out as the simulation's current state
+bool InitFramePipeline(FramePipeline* pipeline, Simulation* sim, JobSystem* jobs, int maxTicksPerFrame, float drawDistance);
+void FreeFramePipeline(FramePipeline* pipeline);
+
+// Queue a job that steps one tick per input, then captures the back
+// snapshot blended alpha of the way from the previous tick to the last
+void KickSimulationFrame(FramePipeline* pipeline, const InputState* inputs, int tickCount, float alpha);
+
+// Have the next job capture a save for writer once its ticks are done, so
+// the copy runs alongside drawing instead of before it
+void RequestFrameSave(FramePipeline* pipeline, SaveWriter* writer);
+
+// Wait for that job (helping with queued jobs meanwhile) and make its
+// snapshot the front one
+void FinishSimulationFrame(FramePipeline* pipeline);
+
+const FrameSnapshot* GetFrameSnapshot(const FramePipeline* pipeline);
+
+#endif // FRAME_PIPELINE_H
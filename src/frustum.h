@@ -0,0 +1,17 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "raylib.h"
+
+// Six planes (x, y, z = inward normal, w = distance) bounding what a camera
+// can see, in world space. Built with the same projection BeginMode3D uses.
+typedef struct {
+    Vector4 planes[6];    // Left, right, bottom, top, near, far
+} Frustum;
+
+Frustum GetCameraFrustum(Camera3D camera, float aspect);
+
+// Conservative: may keep a sphere just outside a corner, never drops a visible one
+bool IsSphereInFrustum(const Frustum* frustum, Vector3 center, float radius);
+
+#endif // FRUSTUM_H
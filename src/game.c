@@ -0,0 +1,644 @@
+#include "raylib.h"
+#include "raymath.h"
+#include "game.h"
+#include "bots.h"
+#include "logger.h"
+#include "profiler.h"
+#include "timer.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WORLD_STREAM 1            // Rng stream for respawns
+#define PROBLEMS_PER_TICK 1       // Pool refill on ticks without a chop
+
+SimulationConfig DefaultSimulationConfig(void) {
+    return (SimulationConfig){
+        .tickRate = DEFAULT_TICK_RATE,
+        .treesPerChunk = DEFAULT_TREES_PER_CHUNK,
+        .chopQuery = CHOP_QUERY_AUTO,
+        .seed = 1,
+        .difficulty = DIFFICULTY_NORMAL,
+        .botCount = 0
+    };
+}
+
+// The SoA store's copy of the labels, after a new problem or relabel
+static void SyncTreeAnswers(Simulation* sim) {
+    if (sim->treeStore.capacity == 0) return;
+    for (int i = 0; i < sim->treeCount; i++) {
+        sim->treeStore.answer[i] = sim->trees[i].answerNumber;
+    }
+}
+
+// Mirror chunk loads and unloads into the tree slots, the grid and the SoA
+// store. The labels follow the player into the new chunks.
+static void StreamChunks(Simulation* sim) {
+    ChunkChanges changes;
+    UpdateChunkPool(&sim->chunks, sim->player.position, sim->tick, &changes);
+    if (changes.unloadedCount == 0 && changes.loadedCount == 0) return;
+    
+    int treesPerChunk = sim->chunks.treesPerChunk;
+    for (int c = 0; c < changes.unloadedCount; c++) {
+        int first = changes.unloaded[c] * treesPerChunk;
+        for (int i = first; i < first + treesPerChunk; i++) {
+            if (!sim->trees[i].exists) continue;
+            sim->trees[i].exists = false;
+            TreeGridRemove(&sim->treeGrid, i);
+            TreeSoASet(&sim->treeStore, i, sim->trees[i].position, false, NO_ANSWER);
+            RemoveObstacle(&sim->collision, i);
+        }
+        for (int r = 0; r < CHUNK_MAX_ROCKS; r++) {
+            RemoveObstacle(&sim->collision, sim->treeCount + changes.unloaded[c] * CHUNK_MAX_ROCKS + r);
+        }
+    }
+    for (int c = 0; c < changes.loadedCount; c++) {
+        const Chunk* chunk = &sim->chunks.chunks[changes.loaded[c]];
+        int first = changes.loaded[c] * treesPerChunk;
+        for (int t = 0; t < chunk->treeCount; t++) {
+            Tree* tree = &sim->trees[first + t];
+            tree->position = (Vector3){ chunk->treePositions[t].x, 0.0f, chunk->treePositions[t].y };
+            tree->exists = true;
+            TreeGridInsert(&sim->treeGrid, first + t, tree->position);
+            TreeSoASet(&sim->treeStore, first + t, tree->position, true, NO_ANSWER);
+            SetObstacle(&sim->collision, first + t, tree->position, TRUNK_HALF_SIZE);
+        }
+        for (int r = 0; r < chunk->layout.rockCount; r++) {
+            SetObstacle(&sim->collision, sim->treeCount + changes.loaded[c] * CHUNK_MAX_ROCKS + r,
+                        chunk->layout.rocks[r], ROCK_HALF_SIZE);
+        }
+    }
+    
+    LabelNearestTrees(&sim->gameState, sim->trees, sim->treeCount, sim->player.position);
+    SyncTreeAnswers(sim);
+    sim->treesVersion++;
+    sim->layoutVersion++;
+}
+
+bool AllocateSimulation(Simulation* sim, const SimulationConfig* config) {
+    *sim = (Simulation){ 0 };
+    sim->tickRate = (config->tickRate > 0) ? config->tickRate : DEFAULT_TICK_RATE;
+    
+    int treesPerChunk = (config->treesPerChunk > 0) ? config->treesPerChunk : 0;
+    if (treesPerChunk > MAX_TREES_PER_CHUNK) treesPerChunk = MAX_TREES_PER_CHUNK;
+    int treeCapacity = CHUNK_POOL_SIZE * treesPerChunk;
+    sim->trees = calloc((treeCapacity > 0) ? treeCapacity : 1, sizeof(Tree));
+    sim->queryResults = malloc(sizeof(int) * ((treeCapacity > 0) ? treeCapacity : 1));
+    sim->botCount = (config->botCount > 0) ? config->botCount : 0;
+    if (sim->botCount > MAX_BOTS) sim->botCount = MAX_BOTS;
+    sim->bots = malloc(sizeof(Bot) * ((sim->botCount > 0) ? sim->botCount : 1));
+    
+    // The grid beats the SIMD kernel once the world is split into chunks, so
+    // only an explicit --chop simd pays for the SoA mirror
+    sim->chopQuery = (config->chopQuery == CHOP_QUERY_AUTO) ? CHOP_QUERY_GRID : config->chopQuery;
+    if (!sim->trees || !sim->queryResults || !sim->bots ||
+        !InitTreeGrid(&sim->treeGrid, (treeCapacity > 0) ? treeCapacity : 1, TREE_GRID_CELL_SIZE) ||
+        (sim->chopQuery == CHOP_QUERY_SIMD && !InitTreeSoA(&sim->treeStore, treeCapacity)) ||
+        !InitCollisionWorld(&sim->collision, treeCapacity + CHUNK_POOL_SIZE * CHUNK_MAX_ROCKS) ||
+        !InitChunkPool(&sim->chunks, treesPerChunk, config->seed, config->jobs)) {
+        FreeSimulation(sim);
+        return false;
+    }
+    
+    // Every slot starts out empty
+    sim->treeCount = treeCapacity;
+    for (int i = 0; i < sim->treeCount; i++) {
+        sim->trees[i].exists = false;
+        sim->trees[i].answerNumber = NO_ANSWER;
+    }
+    sim->equipment = (Equipment){ -1, -1, -1, true, true, true };
+    return true;
+}
+
+bool InitSimulation(Simulation* sim, const SimulationConfig* config) {
+    if (!AllocateSimulation(sim, config)) return false;
+    
+    // Initialize game state
+    sim->gameState.score = 0;
+    SeedRng(&sim->rng, config->seed, WORLD_STREAM);
+    InitProblemEngine(&sim->problems, config->seed, config->difficulty);
+    
+    sim->player = (Player){
+        .position = (Vector3){ 0.0f, 0.0f, 0.0f },
+        .velocity = (Vector3){ 0.0f, 0.0f, 0.0f },
+        .speed = 10.0f,
+        .rotationY = 0.0f,
+        .isMoving = false
+    };
+    
+    sim->gameCamera = (GameCamera){
+        .camera = {
+            .position = (Vector3){ 0.0f, 0.0f, 0.0f }, // Will be calculated from rotation
+            .target = (Vector3){ 0.0f, 0.0f, 0.0f },
+            .up = (Vector3){ 0.0f, 1.0f, 0.0f },
+            .fovy = 45.0f,
+            .projection = CAMERA_PERSPECTIVE
+        },
+        .offset = (Vector3){ 0.0f, 8.0f, 12.0f },
+        .distance = 20.0f,
+        .rotationX = -60.0f,
+        .rotationY = 0.0f,
+        .sensitivity = 0.3f
+    };
+    
+    SpawnBots(sim->bots, sim->botCount, config->seed);
+    
+    // The chunks around the spawn load on the first update, before the first tick
+    StreamChunks(sim);
+    
+    // Generate initial math problem after trees are created
+    GenerateNewMathProblem(&sim->problems, &sim->gameState, sim->trees, sim->treeCount, sim->player.position);
+    SyncTreeAnswers(sim);
+    sim->treesVersion = 1;
+    sim->layoutVersion = 1;
+    
+    // Set initial camera position based on rotation
+    UpdateGameCamera(&sim->gameCamera, &sim->player, 1.0f / sim->tickRate);
+    return true;
+}
+
+void FreeSimulation(Simulation* sim) {
+    FreeTreeGrid(&sim->treeGrid);
+    FreeTreeSoA(&sim->treeStore);
+    FreeCollisionWorld(&sim->collision);
+    FreeChunkPool(&sim->chunks);
+    free(sim->trees);
+    free(sim->queryResults);
+    free(sim->bots);
+    sim->trees = NULL;
+    sim->queryResults = NULL;
+    sim->bots = NULL;
+    sim->botCount = 0;
+    sim->treeCount = 0;
+}
+
+static unsigned long long HashBytes(unsigned long long hash, const void* data, size_t size) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Field by field, so struct padding never ends up in the hash
+unsigned long long SimulationChecksum(const Simulation* sim) {
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    const Player* player = &sim->player;
+    const Camera3D* camera = &sim->gameCamera.camera;
+    const GameState* gameState = &sim->gameState;
+    const Equipment* equipment = &sim->equipment;
+    
+    hash = HashBytes(hash, &sim->tick, sizeof(sim->tick));
+    hash = HashBytes(hash, &player->position, sizeof(player->position));
+    hash = HashBytes(hash, &player->velocity, sizeof(player->velocity));
+    hash = HashBytes(hash, &player->rotationY, sizeof(player->rotationY));
+    hash = HashBytes(hash, &player->isMoving, sizeof(player->isMoving));
+    hash = HashBytes(hash, &camera->position, sizeof(camera->position));
+    hash = HashBytes(hash, &camera->target, sizeof(camera->target));
+    hash = HashBytes(hash, &sim->gameCamera.rotationX, sizeof(sim->gameCamera.rotationX));
+    hash = HashBytes(hash, &gameState->score, sizeof(gameState->score));
+    hash = HashBytes(hash, &gameState->currentProblem.a, sizeof(int));
+    hash = HashBytes(hash, &gameState->currentProblem.b, sizeof(int));
+    hash = HashBytes(hash, &gameState->currentProblem.operation, sizeof(int));
+    hash = HashBytes(hash, &gameState->currentProblem.c, sizeof(int));
+    hash = HashBytes(hash, &gameState->currentProblem.secondOperation, sizeof(int));
+    hash = HashBytes(hash, &equipment->showHat, sizeof(bool));
+    hash = HashBytes(hash, &equipment->showSword, sizeof(bool));
+    hash = HashBytes(hash, &equipment->showShield, sizeof(bool));
+    for (int i = 0; i < sim->treeCount; i++) {
+        const Tree* tree = &sim->trees[i];
+        hash = HashBytes(hash, &tree->position, sizeof(tree->position));
+        hash = HashBytes(hash, &tree->exists, sizeof(tree->exists));
+        hash = HashBytes(hash, &tree->answerNumber, sizeof(tree->answerNumber));
+    }
+    for (int i = 0; i < sim->botCount; i++) {
+        const Bot* bot = &sim->bots[i];
+        hash = HashBytes(hash, &bot->player.position, sizeof(bot->player.position));
+        hash = HashBytes(hash, &bot->score, sizeof(bot->score));
+    }
+    hash = HashBytes(hash, &sim->rng.state, sizeof(sim->rng.state));
+    hash = HashBytes(hash, &sim->problems.rng.state, sizeof(sim->problems.rng.state));
+    return hash;
+}
+
+void StepSimulation(Simulation* sim, const InputState* input) {
+    float deltaTime = 1.0f / sim->tickRate;
+    sim->tick++;
+    
+    PROFILE_BEGIN(PROFILE_PLAYER);
+    MovePlayer(sim, &sim->player, input);
+    PROFILE_END(PROFILE_PLAYER);
+    
+    // Handle mouse input for camera rotation (vertical only)
+    if (input->cameraDrag) {
+        GameCamera* gameCamera = &sim->gameCamera;
+        // Only allow vertical rotation (X axis)
+        gameCamera->rotationX -= input->cameraDeltaY * gameCamera->sensitivity;
+        
+        // Clamp vertical rotation to look down from above
+        if (gameCamera->rotationX > -20.0f) gameCamera->rotationX = -20.0f;
+        if (gameCamera->rotationX < -80.0f) gameCamera->rotationX = -80.0f;
+    }
+    
+    PROFILE_BEGIN(PROFILE_CAMERA);
+    UpdateGameCamera(&sim->gameCamera, &sim->player, deltaTime);
+    PROFILE_END(PROFILE_CAMERA);
+    
+    // Stream chunks in and out around the player
+    StreamChunks(sim);
+    
+    // Check for tree removal
+    if (input->chop) {
+        PROFILE_BEGIN(PROFILE_CHOP);
+        CheckTreeRemoval(sim, &sim->player);
+        PROFILE_END(PROFILE_CHOP);
+    } else {
+        // Top up the problems a chop takes, a few per quiet tick
+        RefillProblemPool(&sim->problems, PROBLEMS_PER_TICK);
+    }
+    
+    // AI choppers, after the player so a tie goes to the human
+    StepBots(sim);
+    sim->collision.stats.ticks++;
+    
+    // Animation handling
+    if (input->nextAnimation && sim->animationCount > 1) {
+        sim->currentAnimation = (sim->currentAnimation + 1) % sim->animationCount;
+        sim->currentFrame = 0;
+        sim->animationTicks = 0;
+    }
+    if (input->prevAnimation && sim->animationCount > 1) {
+        sim->currentAnimation = (sim->currentAnimation - 1 + sim->animationCount) % sim->animationCount;
+        sim->currentFrame = 0;
+        sim->animationTicks = 0;
+    }
+    
+    if (sim->animations != NULL && sim->animationCount > 0) {
+        // Choose animation based on movement state
+        int targetAnimation = 0; // idle animation
+        if (sim->player.isMoving && sim->animationCount > 1) {
+            targetAnimation = 1; // walking animation (if available)
+        }
+        
+        // Switch animation if different from current
+        if (sim->currentAnimation != targetAnimation) {
+            sim->currentAnimation = targetAnimation;
+            sim->currentFrame = 0;
+            sim->animationTicks = 0;
+        }
+        
+        // Play back at the sampled rate whatever the tick rate is. Counting in
+        // whole ticks keeps the frame exact (at 60 Hz it's one frame per tick).
+        int frameCount = sim->animations[sim->currentAnimation].frameCount;
+        sim->animationTicks++;
+        if (frameCount > 0) {
+            unsigned long long sampledFrames = (unsigned long long)sim->animationTicks * ANIMATION_FPS / sim->tickRate;
+            sim->currentFrame = (int)(sampledFrames % (unsigned long long)frameCount);
+        }
+    }
+    
+    // Equipment toggle controls
+    if (input->toggleHat) sim->equipment.showHat = !sim->equipment.showHat;
+    if (input->toggleSword) sim->equipment.showSword = !sim->equipment.showSword;
+    if (input->toggleShield) sim->equipment.showShield = !sim->equipment.showShield;
+}
+
+void GenerateNewMathProblem(ProblemEngine* engine, GameState* gameState, Tree* trees, int treeCount, Vector3 center) {
+    // Count existing trees
+    int existingTreeCount = 0;
+    for (int i = 0; i < treeCount; i++) {
+        if (trees[i].exists) {
+            existingTreeCount++;
+        }
+    }
+    
+    if (existingTreeCount == 0) return; // No trees to assign answers to
+    
+    PreparedProblem prepared = TakeProblem(engine);
+    gameState->currentProblem = prepared.problem;
+    for (int i = 0; i < MAX_ANSWERS; i++) gameState->possibleAnswers[i] = prepared.answers[i];
+    LabelNearestTrees(gameState, trees, treeCount, center);
+    
+    if (LOG_ENABLED(LOG_LEVEL_INFO, LOG_CAT_GAME)) {
+        char text[64];
+        FormatMathProblem(&gameState->currentProblem, text, sizeof(text));
+        LOGI(LOG_CAT_GAME, "Math problem: %s (%d)", text, gameState->currentProblem.correctAnswer);
+    }
+}
+
+void LabelNearestTrees(const GameState* gameState, Tree* trees, int treeCount, Vector3 center) {
+    // Insertion into a short sorted list: nearest first, ties to the lower index
+    int nearest[MAX_ANSWERS];
+    float nearestDistance[MAX_ANSWERS];
+    int found = 0;
+    for (int i = 0; i < treeCount; i++) {
+        trees[i].answerNumber = NO_ANSWER;
+        if (!trees[i].exists) continue;
+        
+        float dx = trees[i].position.x - center.x;
+        float dz = trees[i].position.z - center.z;
+        float distance = dx * dx + dz * dz;
+        if (found == MAX_ANSWERS && distance >= nearestDistance[MAX_ANSWERS - 1]) continue;
+        
+        int slot = (found < MAX_ANSWERS) ? found++ : MAX_ANSWERS - 1;
+        while (slot > 0 && nearestDistance[slot - 1] > distance) {
+            nearest[slot] = nearest[slot - 1];
+            nearestDistance[slot] = nearestDistance[slot - 1];
+            slot--;
+        }
+        nearest[slot] = i;
+        nearestDistance[slot] = distance;
+    }
+    if (found == 0) return;
+    
+    // With fewer trees than answers, make sure the right one is among those used
+    int answers[MAX_ANSWERS];
+    for (int i = 0; i < MAX_ANSWERS; i++) answers[i] = gameState->possibleAnswers[i];
+    for (int i = found; i < MAX_ANSWERS; i++) {
+        if (answers[i] == gameState->currentProblem.correctAnswer) {
+            answers[i] = answers[i % found];
+            answers[i % found] = gameState->currentProblem.correctAnswer;
+        }
+    }
+    for (int i = 0; i < found; i++) trees[nearest[i]].answerNumber = answers[i];
+}
+
+void UpdatePlayer(Player* player, GameCamera* gameCamera, const InputState* input, float deltaTime) {
+    (void)gameCamera; // Camera Y rotation is fixed, so movement doesn't depend on it yet
+    Vector3 movement = { 0.0f, 0.0f, 0.0f };
+    bool moving = false;
+    
+    // Input handling - screen relative movement
+    if (input->moveForward) {
+        movement.z -= 1.0f; // Forward relative to camera
+        moving = true;
+    }
+    if (input->moveBack) {
+        movement.z += 1.0f; // Backward relative to camera
+        moving = true;
+    }
+    if (input->moveLeft) {
+        movement.x -= 1.0f; // Left relative to camera
+        moving = true;
+    }
+    if (input->moveRight) {
+        movement.x += 1.0f; // Right relative to camera
+        moving = true;
+    }
+    
+    player->isMoving = moving;
+    
+    if (moving) {
+        // Normalize movement vector
+        movement = Vector3Normalize(movement);
+        
+        // Since camera Y rotation is fixed at 0, movement is direct
+        Vector3 worldMovement = {
+            movement.x,
+            0.0f,
+            movement.z
+        };
+        
+        // Calculate rotation based on movement direction
+        player->rotationY = atan2f(worldMovement.x, worldMovement.z) * RAD2DEG;
+        
+        // Apply movement
+        player->velocity = Vector3Scale(worldMovement, player->speed);
+        player->position = Vector3Add(player->position, Vector3Scale(player->velocity, deltaTime));
+    } else {
+        player->velocity = (Vector3){ 0.0f, 0.0f, 0.0f };
+    }
+}
+
+void MovePlayerIn(CollisionWorld* world, Player* player, GameCamera* gameCamera, const InputState* input, float deltaTime) {
+    Vector3 from = player->position;
+    UpdatePlayer(player, gameCamera, input, deltaTime);
+    player->position = CollideMover(world, from, player->position, PLAYER_RADIUS);
+}
+
+void MovePlayer(Simulation* sim, Player* player, const InputState* input) {
+    double start = GetMonotonicSeconds();
+    MovePlayerIn(&sim->collision, player, &sim->gameCamera, input, 1.0f / sim->tickRate);
+    sim->collision.stats.seconds += GetMonotonicSeconds() - start;
+}
+
+void UpdateGameCamera(GameCamera* gameCamera, Player* player, float deltaTime) {
+    // Calculate camera position based on rotation angles
+    float radX = gameCamera->rotationX * DEG2RAD;
+    float radY = gameCamera->rotationY * DEG2RAD;
+    
+    // Calculate offset based on spherical coordinates (corrected for proper top-down view)
+    Vector3 offset = {
+        gameCamera->distance * cosf(radX) * sinf(radY),
+        gameCamera->distance * -sinf(radX), // Negative to look down from above
+        gameCamera->distance * cosf(radX) * cosf(radY)
+    };
+    
+    // Position camera relative to player
+    Vector3 targetPosition = Vector3Add(player->position, offset);
+    
+    // Smooth camera movement (CAMERA_SMOOTHING per 1/60 s, scaled to the tick length)
+    float smoothing = 1.0f - powf(1.0f - CAMERA_SMOOTHING, deltaTime * 60.0f);
+    gameCamera->camera.position = Vector3Lerp(gameCamera->camera.position, targetPosition, smoothing);
+    gameCamera->camera.target = Vector3Lerp(gameCamera->camera.target, player->position, smoothing);
+}
+
+Player InterpolatePlayer(const Player* previous, const Player* current, float alpha) {
+    Player result = *current;
+    result.position = Vector3Lerp(previous->position, current->position, alpha);
+    
+    // Rotate the short way round
+    float delta = current->rotationY - previous->rotationY;
+    while (delta > 180.0f) delta -= 360.0f;
+    while (delta < -180.0f) delta += 360.0f;
+    result.rotationY = previous->rotationY + delta * alpha;
+    
+    return result;
+}
+
+Camera3D InterpolateCamera(const Camera3D* previous, const Camera3D* current, float alpha) {
+    Camera3D result = *current;
+    result.position = Vector3Lerp(previous->position, current->position, alpha);
+    result.target = Vector3Lerp(previous->target, current->target, alpha);
+    return result;
+}
+
+int FindBoneSocket(Model model, const char* socketName) {
+    for (int i = 0; i < model.boneCount; i++) {
+        if (TextIsEqual(model.bones[i].name, socketName)) {
+            return i;
+        }
+    }
+    return -1; // Socket not found
+}
+
+Matrix GetSocketTransform(Model model, ModelAnimation animation, int frameIndex, int socketIndex, Matrix modelTransform) {
+    if (socketIndex < 0 || socketIndex >= model.boneCount || frameIndex >= animation.frameCount) {
+        return MatrixIdentity();
+    }
+    
+    // Get current animation frame bone transform and bind pose
+    Transform* frameTransform = &animation.framePoses[frameIndex][socketIndex];
+    Transform* bindPose = &model.bindPose[socketIndex];
+    
+    // Calculate relative rotation from bind pose to current frame (same as raylib example)
+    Quaternion inRotation = bindPose->rotation;
+    Quaternion outRotation = frameTransform->rotation;
+    Quaternion rotate = QuaternionMultiply(outRotation, QuaternionInvert(inRotation));
+    
+    // Create transform matrix (same order as raylib example)
+    Matrix matrixTransform = QuaternionToMatrix(rotate);
+    matrixTransform = MatrixMultiply(matrixTransform, MatrixTranslate(frameTransform->translation.x, 
+                                                                     frameTransform->translation.y, 
+                                                                     frameTransform->translation.z));
+    
+    // Apply character model transform (same as raylib example)
+    return MatrixMultiply(matrixTransform, modelTransform);
+}
+
+Vector3 PlayerForward(const Player* player) {
+    float playerAngle = player->rotationY * DEG2RAD;
+    return (Vector3){ sinf(playerAngle), 0.0f, cosf(playerAngle) };
+}
+
+int FindChopTargetLinear(const Player* player, const Tree* trees, int treeCount) {
+    Vector3 forward = PlayerForward(player);
+    
+    for (int i = 0; i < treeCount; i++) {
+        if (!trees[i].exists) continue;
+        if (IsTreeInChopRange(player->position, forward, trees[i].position)) return i;
+    }
+    return -1;
+}
+
+int FindChopTarget(const Player* player, const Tree* trees, const TreeGrid* grid, int* queryResults, int maxResults) {
+    Vector3 forward = PlayerForward(player);
+    Vector3 p = player->position;
+    int count = TreeGridQueryRect(grid, p.x - CHOP_RANGE, p.z - CHOP_RANGE, p.x + CHOP_RANGE, p.z + CHOP_RANGE,
+                                  queryResults, maxResults);
+    
+    // The linear scan removes the lowest-index match, so do the same here
+    int best = -1;
+    for (int i = 0; i < count; i++) {
+        int tree = queryResults[i];
+        if (best >= 0 && tree > best) continue;
+        if (!trees[tree].exists) continue;
+        if (IsTreeInChopRange(player->position, forward, trees[tree].position)) best = tree;
+    }
+    return best;
+}
+
+int QueryTreesInRadius(const Tree* trees, const TreeGrid* grid, Vector3 center, float radius, int* results, int maxResults) {
+    int count = TreeGridQueryRect(grid, center.x - radius, center.z - radius,
+                                  center.x + radius, center.z + radius, results, maxResults);
+    
+    // Compact down to existing trees inside the circle
+    int kept = 0;
+    float radiusSqr = radius * radius;
+    for (int i = 0; i < count; i++) {
+        const Tree* tree = &trees[results[i]];
+        float dx = tree->position.x - center.x;
+        float dz = tree->position.z - center.z;
+        if (tree->exists && dx * dx + dz * dz <= radiusSqr) {
+            results[kept++] = results[i];
+        }
+    }
+    return kept;
+}
+
+// The SIMD kernel over the slots of the chunks a chop from here can reach.
+// Slots are visited in order and own ascending index ranges, so the first
+// hit is the lowest index, as the linear scan would pick. The slots are only
+// looked up again when the player crosses into another chunk range or the
+// pool changes, not on every query.
+static int FindChopTargetNearby(Simulation* sim, const Player* player) {
+    // A hair past the range, so rounding can't leave a chunk out
+    float reach = CHOP_RANGE + 0.01f;
+    Vector3 p = player->position;
+    int box[4];
+    ChunkAt((Vector3){ p.x - reach, 0.0f, p.z - reach }, &box[0], &box[1]);
+    ChunkAt((Vector3){ p.x + reach, 0.0f, p.z + reach }, &box[2], &box[3]);
+    
+    if (sim->nearbyVersion != sim->layoutVersion || memcmp(box, sim->nearbyBox, sizeof(box)) != 0) {
+        sim->nearbySlotCount = 0;
+        for (int s = 0; s < CHUNK_POOL_SIZE && sim->nearbySlotCount < CHOP_REACH_CHUNKS; s++) {
+            const Chunk* chunk = &sim->chunks.chunks[s];
+            if (chunk->state != CHUNK_LOADED) continue;
+            if (chunk->layout.x < box[0] || chunk->layout.x > box[2] || chunk->layout.z < box[1] || chunk->layout.z > box[3]) continue;
+            sim->nearbySlots[sim->nearbySlotCount++] = s;
+        }
+        memcpy(sim->nearbyBox, box, sizeof(box));
+        sim->nearbyVersion = sim->layoutVersion;
+    }
+    
+    Vector3 forward = PlayerForward(player);
+    int treesPerChunk = sim->chunks.treesPerChunk;
+    for (int n = 0; n < sim->nearbySlotCount; n++) {
+        int s = sim->nearbySlots[n];
+        int first = s * treesPerChunk;
+        int hit = TreeSoAFindChopTargetInRange(&sim->treeStore, first, first + sim->chunks.chunks[s].treeCount, p, forward);
+        if (hit >= 0) return hit;
+    }
+    return -1;
+}
+
+int FindSimulationChopTarget(Simulation* sim, const Player* player) {
+    switch (sim->chopQuery) {
+        case CHOP_QUERY_SCAN:
+            return FindChopTargetLinear(player, sim->trees, sim->treeCount);
+        case CHOP_QUERY_SIMD:
+            return FindChopTargetNearby(sim, player);
+        default:
+            return FindChopTarget(player, sim->trees, &sim->treeGrid, sim->queryResults, sim->treeCount);
+    }
+}
+
+bool ChopTree(Simulation* sim, const Player* chopper, int treeIndex, int* score) {
+    Tree* trees = sim->trees;
+    GameState* gameState = &sim->gameState;
+    int i = treeIndex;
+    
+    trees[i].exists = false;
+    
+    // Check if this tree has the correct answer
+    bool correct = (trees[i].answerNumber == gameState->currentProblem.correctAnswer);
+    *score += correct ? 1 : -2;
+    
+    // Generate new math problem, labeled around the player whoever chopped
+    GenerateNewMathProblem(&sim->problems, gameState, trees, sim->treeCount, sim->player.position);
+    
+    // Respawn somewhere free in the tree's own chunk, away from the chopper.
+    // A full chunk keeps the tree where it was.
+    int treesPerChunk = sim->chunks.treesPerChunk;
+    PlacementGrid* placement = &sim->chunks.chunks[i / treesPerChunk].placement;
+    Vector2 slot = { trees[i].position.x, trees[i].position.z };
+    PlacementRemove(placement, i % treesPerChunk);
+    FindPlacement(placement, &sim->rng, (Vector2){ chopper->position.x, chopper->position.z }, RESPAWN_CLEARANCE, &slot);
+    PlacementAdd(placement, i % treesPerChunk, slot);
+    Vector3 newPos = { slot.x, 0.0f, slot.y };
+    
+    trees[i].position = newPos;
+    trees[i].exists = true;
+    TreeGridMove(&sim->treeGrid, i, newPos);
+    SetObstacle(&sim->collision, i, newPos, TRUNK_HALF_SIZE);
+    
+    // The new problem relabeled trees, so refresh answers along with the move
+    SyncTreeAnswers(sim);
+    TreeSoASet(&sim->treeStore, i, newPos, true, trees[i].answerNumber);
+    sim->treesVersion++;
+    return correct;
+}
+
+void CheckTreeRemoval(Simulation* sim, Player* player) {
+    int i = FindSimulationChopTarget(sim, player);
+    if (i < 0) return;
+    
+    Vector3 position = sim->trees[i].position;
+    if (ChopTree(sim, player, i, &sim->gameState.score)) {
+        LOGI(LOG_CAT_GAME, "Correct! Score +1. Tree removed at position (%.1f, %.1f)", position.x, position.z);
+    } else {
+        LOGI(LOG_CAT_GAME, "Wrong! Score -2. Tree removed at position (%.1f, %.1f)", position.x, position.z);
+    }
+    LOGD(LOG_CAT_GAME, "Tree respawned at position (%.1f, %.1f)", sim->trees[i].position.x, sim->trees[i].position.z);
+}
@@ -0,0 +1,199 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "raylib.h"
+#include "input.h"
+#include "tree_grid.h"
+#include "tree_soa.h"
+#include "rng.h"
+#include "math_problem.h"
+#include "world_chunks.h"
+#include "collision.h"
+#include "chop.h"
+#include <limits.h>
+
+#define SCREEN_WIDTH 1280
+#define SCREEN_HEIGHT 720
+
+#define DEFAULT_TREES_PER_CHUNK 20
+#define TREE_GRID_CELL_SIZE 8.0f  // Twice the chop range, so a chop touches at most 2x2 cells
+#define PLAYER_RADIUS 0.5f       // Characters' collision capsule
+#define RESPAWN_CLEARANCE 8.0f   // Respawned trees keep this far from the player
+#define NO_ANSWER INT_MIN        // answerNumber of an unlabeled tree (0 and negatives are real answers)
+#define CHOP_REACH_CHUNKS 4       // A chop reaches into 2x2 chunks at most, as CHOP_RANGE is far below CHUNK_SIZE
+#define MAX_BOTS 10000
+
+#define DEFAULT_TICK_RATE 60    // Simulation ticks per second
+#define ANIMATION_FPS 60        // Rate the glTF animations are sampled at
+#define CAMERA_SMOOTHING 0.1f   // Camera follow lerp per 1/60 s
+
+typedef struct {
+    Vector3 position;
+    Vector3 velocity;
+    float speed;
+    float rotationY;
+    bool isMoving;
+} Player;
+
+typedef struct {
+    int score;
+    MathProblem currentProblem;
+    int possibleAnswers[MAX_ANSWERS];
+} GameState;
+
+typedef struct {
+    int hatSocket;
+    int rightHandSocket;
+    int leftHandSocket;
+    bool showHat;
+    bool showSword;
+    bool showShield;
+} Equipment;
+
+typedef struct {
+    Vector3 position;
+    bool exists;
+    int answerNumber;
+} Tree;
+
+// An AI chopper for stress tests: moves with the player's movement model,
+// chops by the same rules and keeps its own score
+typedef struct {
+    Player player;
+    int target;           // Tree it's walking to, -1 while it has none
+    int score;
+    int cooldown;         // Ticks until it can swing again
+    int pendingChop;      // Tree its swing this tick hits, -1 for none
+    Vector3 moveFrom;     // Where this tick's move started, for the collision pass
+    bool turn;            // Step toward the target once to face it
+} Bot;
+
+// What the bots cost, summed over every tick so far
+typedef struct {
+    double moveSeconds;   // Steering and UpdatePlayer
+    double querySeconds;  // Looking for the right tree, chop target queries
+    double scoreSeconds;  // Scoring chops: new problems, relabels, respawns
+    unsigned int ticks;
+    unsigned int chops;
+    unsigned int correctChops;
+} BotStats;
+
+typedef struct {
+    Camera3D camera;
+    Vector3 offset;
+    float distance;
+    float rotationX;
+    float rotationY;
+    float sensitivity;
+} GameCamera;
+
+// How CheckTreeRemoval finds the tree in front of the player. All of them
+// pick the same tree; they only differ in cost.
+typedef enum {
+    CHOP_QUERY_AUTO = 0,  // The grid, which is fastest in the streamed world (see --bench chop)
+    CHOP_QUERY_SCAN,      // Scalar loop over every tree
+    CHOP_QUERY_GRID,      // Nearby grid cells only
+    CHOP_QUERY_SIMD       // SIMD kernel over the SoA store, in the chunks around the player only
+} ChopQuery;
+
+typedef struct {
+    int tickRate;         // Simulation ticks per second
+    int treesPerChunk;    // Trees generated in each chunk of the streamed world
+    ChopQuery chopQuery;
+    unsigned int seed;    // World chunks, respawns and problems
+    DifficultyTier difficulty;
+    int botCount;         // AI choppers, up to MAX_BOTS
+    JobSystem* jobs;      // Generates chunks in the background; NULL does it inline (same world either way)
+} SimulationConfig;
+
+// Everything the game logic touches each tick. Rendering only reads from it,
+// so the same state can be stepped with or without a window. The simulation
+// always advances in fixed steps of 1/tickRate seconds.
+typedef struct {
+    int tickRate;
+    unsigned int tick;
+    
+    Player player;
+    GameCamera gameCamera;
+    GameState gameState;
+    Equipment equipment;
+    Tree* trees;
+    int treeCount;         // Tree slots of every chunk in the pool, existing or not
+    TreeGrid treeGrid;     // Spatial index over trees[], kept in sync on respawn
+    TreeSoA treeStore;     // SoA mirror of trees[] for the SIMD chop kernel; empty (sets do nothing) under other queries
+    unsigned int treesVersion; // Bumped whenever a tree moves, vanishes or is relabeled
+    unsigned int layoutVersion; // Bumped when the ground or rocks change (the static scene rebakes)
+    ChopQuery chopQuery;
+    int* queryResults;     // Scratch for grid queries, one slot per tree
+    int nearbySlots[CHOP_REACH_CHUNKS]; // Loaded chunk slots the SIMD chop query scans, ascending
+    int nearbySlotCount;
+    int nearbyBox[4];      // Chunk range (min x, min z, max x, max z) they were found for
+    unsigned int nearbyVersion; // layoutVersion they were found at, 0 before the first query
+    CollisionWorld collision; // Trunks as obstacles [0, treeCount), then CHUNK_MAX_ROCKS rocks per chunk slot
+    Rng rng;               // Respawns
+    ChunkPool chunks;      // Streamed world around the player; chunk slot s owns trees[s * treesPerChunk...]
+    ProblemEngine problems;
+    Bot* bots;
+    int botCount;
+    BotStats botStats;
+
+    // Animation playback (animations may be NULL when no model is available)
+    const ModelAnimation* animations;
+    int animationCount;
+    int currentAnimation;
+    int currentFrame;
+    unsigned int animationTicks; // Ticks since the current animation started
+} Simulation;
+
+SimulationConfig DefaultSimulationConfig(void);
+bool InitSimulation(Simulation* sim, const SimulationConfig* config);
+// Just the memory InitSimulation sets up, with every tree slot empty and no
+// world in it yet; LoadSimulation fills it in from a save
+bool AllocateSimulation(Simulation* sim, const SimulationConfig* config);
+void FreeSimulation(Simulation* sim);
+void StepSimulation(Simulation* sim, const InputState* input);
+
+// FNV-1a over the gameplay state: tick, player, camera, score, problem,
+// equipment, trees, bots and the random generators. Animation playback is left out because the model
+// arrives at a different tick depending on how fast it loads.
+unsigned long long SimulationChecksum(const Simulation* sim);
+
+Vector3 PlayerForward(const Player* player);
+
+// Index of the tree a chop from this player would hit, or -1. The grid version
+// only visits nearby cells but returns exactly what the linear scan would.
+int FindChopTarget(const Player* player, const Tree* trees, const TreeGrid* grid, int* queryResults, int maxResults);
+int FindChopTargetLinear(const Player* player, const Tree* trees, int treeCount);
+
+// Existing trees within radius of center on the XZ plane, in no particular order
+int QueryTreesInRadius(const Tree* trees, const TreeGrid* grid, Vector3 center, float radius, int* results, int maxResults);
+
+// Blend between the states before and after the last tick for rendering
+Player InterpolatePlayer(const Player* previous, const Player* current, float alpha);
+Camera3D InterpolateCamera(const Camera3D* previous, const Camera3D* current, float alpha);
+
+void UpdatePlayer(Player* player, GameCamera* gameCamera, const InputState* input, float deltaTime);
+// UpdatePlayer, then slide out of whatever trunks and rocks of the world
+// the move ran into. Network clients predict with this too, against the
+// obstacles their snapshots carry, so they land where the server does.
+void MovePlayerIn(CollisionWorld* world, Player* player, GameCamera* gameCamera, const InputState* input, float deltaTime);
+// MovePlayerIn for one tick of the simulation's world; the time goes into
+// the collision stats
+void MovePlayer(Simulation* sim, Player* player, const InputState* input);
+void UpdateGameCamera(GameCamera* gameCamera, Player* player, float deltaTime);
+int FindBoneSocket(Model model, const char* socketName);
+Matrix GetSocketTransform(Model model, ModelAnimation animation, int frameIndex, int socketIndex, Matrix modelTransform);
+void CheckTreeRemoval(Simulation* sim, Player* player);
+// The tree a chop from this player would hit with the simulation's chop query, or -1
+int FindSimulationChopTarget(Simulation* sim, const Player* player);
+// Fell a tree for whoever chopped it: score it against the current problem
+// (+1 or -2 into *score), put up a new problem and respawn the tree away
+// from the chopper. Returns whether it was the right answer.
+bool ChopTree(Simulation* sim, const Player* chopper, int treeIndex, int* score);
+// Next problem from the pool, labeled onto the trees nearest center
+void GenerateNewMathProblem(ProblemEngine* engine, GameState* gameState, Tree* trees, int treeCount, Vector3 center);
+// Put the current problem's answers on the existing trees nearest center;
+// every other tree loses its label
+void LabelNearestTrees(const GameState* gameState, Tree* trees, int treeCount, Vector3 center);
+
+#endif // GAME_H
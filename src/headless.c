@@ -0,0 +1,112 @@
+#include "raylib.h"
+#include "game.h"
+#include "bots.h"
+#include "headless.h"
+#include "job_system.h"
+#include "logger.h"
+#include "save_game.h"
+#include "timer.h"
+#include <stdlib.h>
+
+int RunHeadless(const HeadlessOptions* options) {
+    // Chunks are generated by jobs while the ticks run, like in the window
+    JobSystem jobs;
+    InitJobSystem(&jobs, options->workers);
+    SimulationConfig config = options->config;
+    config.jobs = &jobs;
+    
+    Simulation sim;
+    if (options->loadPath != NULL) {
+        if (!LoadSimulation(&sim, options->loadPath, &jobs)) {
+            FreeJobSystem(&jobs);
+            return 1;
+        }
+    } else if (!InitSimulation(&sim, &config)) {
+        LOGE(LOG_CAT_GAME, "Failed to allocate a world with %d trees per chunk", config.treesPerChunk);
+        FreeJobSystem(&jobs);
+        return 1;
+    }
+    
+    // Animations are plain CPU data, so frame advance can be simulated
+    // without a GL context even though the model itself can't be loaded
+    ModelAnimation* animations = NULL;
+    int animationCount = 0;
+    if (FileExists("assets/models/greenman.glb")) {
+        animations = LoadModelAnimations("assets/models/greenman.glb", &animationCount);
+        sim.animations = animations;
+        sim.animationCount = animationCount;
+    }
+    
+    ReplayRecorder recorder = { 0 };
+    if (options->recordPath != NULL && !StartRecording(&recorder, options->recordPath, &options->config)) {
+        if (animations != NULL) UnloadModelAnimations(animations, animationCount);
+        FreeSimulation(&sim);
+        FreeJobSystem(&jobs);
+        return 1;
+    }
+    
+    SaveWriter saveWriter = { 0 };
+    bool saving = options->savePath != NULL && StartSaveWriter(&saveWriter, options->savePath);
+    unsigned int autosaveTicks = (unsigned int)options->autosaveSeconds * (unsigned int)sim.tickRate;
+    
+    // Replays time every tick on top of the total, for the tick summary
+    ReplayPlayer* replay = options->replay;
+    TimingLog tickTimes = { 0 };
+    unsigned int ticks = 0;
+    
+    double startTime = GetMonotonicSeconds();
+    if (replay != NULL) {
+        InputState input;
+        while (NextReplayInput(replay, &input)) {
+            double tickStart = GetMonotonicSeconds();
+            StepSimulation(&sim, &input);
+            LogTiming(&tickTimes, GetMonotonicSeconds() - tickStart);
+            if (recorder.file != NULL) RecordTick(&recorder, &input);
+            ticks++;
+        }
+    } else {
+        for (unsigned int tick = 0; tick < options->ticks; tick++) {
+            InputState input = ScriptedInput(sim.tick);
+            StepSimulation(&sim, &input);
+            if (recorder.file != NULL) RecordTick(&recorder, &input);
+            if (saving && autosaveTicks > 0 && tick + 1 < options->ticks && (tick + 1) % autosaveTicks == 0) {
+                RequestSave(&saveWriter, &sim);
+            }
+        }
+        ticks = options->ticks;
+    }
+    double elapsed = GetMonotonicSeconds() - startTime;
+    
+    LOGI(LOG_CAT_PERF, "Headless run at %d Hz with %d trees per chunk: %u ticks in %.3f s (%.0f ticks/sec, %.3f us/tick)",
+         sim.tickRate, sim.chunks.treesPerChunk, ticks, elapsed,
+         (elapsed > 0.0) ? ticks / elapsed : 0.0,
+         (ticks > 0) ? elapsed * 1e6 / ticks : 0.0);
+    LOGI(LOG_CAT_PERF, "Final state: score %d, position (%.1f, %.1f), animation %d frame %d",
+         sim.gameState.score, sim.player.position.x, sim.player.position.z,
+         sim.currentAnimation, sim.currentFrame);
+    LOGI(LOG_CAT_PERF, "World: %u chunks generated, %d of %d slots loaded",
+         sim.chunks.generated, LoadedChunkCount(&sim.chunks), CHUNK_POOL_SIZE);
+    PrintBotStats(&sim.botStats, sim.botCount);
+    PrintCollisionStats(&sim.collision.stats);
+    
+    int result = 0;
+    if (replay != NULL) {
+        if (!ReportReplayChecksum(replay, &sim)) result = 1;
+        PrintTimingSummary("tick", &tickTimes);
+    }
+    if (recorder.file != NULL && !FinishRecording(&recorder, &sim)) result = 1;
+    if (saving) {
+        WaitForSave(&saveWriter);
+        if (!RequestSave(&saveWriter, &sim)) result = 1;
+        WaitForSave(&saveWriter);
+        if (saveWriter.failures > 0) result = 1;
+        StopSaveWriter(&saveWriter);
+    }
+    
+    FreeTimingLog(&tickTimes);
+    if (animations != NULL) UnloadModelAnimations(animations, animationCount);
+    FreeSimulation(&sim);
+    FreeJobSystem(&jobs);
+    
+    return result;
+}
@@ -0,0 +1,25 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "game.h"
+#include "replay.h"
+
+typedef struct {
+    unsigned int ticks;   // Number of simulation ticks to run
+    SimulationConfig config;
+    ReplayPlayer* replay;     // Feed this recording instead of scripted input (ticks and config come from it)
+    const char* recordPath;   // Record the input that was fed, may be NULL
+    int workers;              // Job system threads for chunk generation (-1: one per spare core)
+    const char* loadPath;     // Resume from this save instead of starting a new world, may be NULL
+    const char* savePath;     // Autosave here and save on the way out, may be NULL
+    int autosaveSeconds;      // Of game time between autosaves, 0 for only the last one
+} HeadlessOptions;
+
+// Run the game logic without a window, fed by scripted or replayed input,
+// as fast as possible and print the achieved ticks/sec. A resumed world
+// picks the scripted input up at its own tick, so saving after n ticks and
+// resuming for m more ends where a single run of n + m ticks does. Returns the process
+// exit code (non-zero when a replay doesn't reproduce its checksum).
+int RunHeadless(const HeadlessOptions* options);
+
+#endif // HEADLESS_H
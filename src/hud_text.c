@@ -0,0 +1,29 @@
+#include "raylib.h"
+#include "hud_text.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+bool HudTextIsStale(HudText* hud, const int* key, int keyCount) {
+    if (keyCount > HUD_TEXT_MAX_KEYS) keyCount = HUD_TEXT_MAX_KEYS;
+    
+    bool stale = !hud->valid || hud->keyCount != keyCount;
+    for (int i = 0; i < keyCount && !stale; i++) {
+        if (hud->key[i] != key[i]) stale = true;
+    }
+    if (!stale) return false;
+    
+    for (int i = 0; i < keyCount; i++) hud->key[i] = key[i];
+    hud->keyCount = keyCount;
+    hud->valid = true;
+    return true;
+}
+
+void HudTextSet(HudText* hud, int fontSize, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(hud->text, sizeof(hud->text), format, args);
+    va_end(args);
+    
+    hud->fontSize = fontSize;
+    hud->width = MeasureText(hud->text, fontSize);
+}
@@ -0,0 +1,26 @@
+#ifndef HUD_TEXT_H
+#define HUD_TEXT_H
+
+#include <stdbool.h>
+
+#define HUD_TEXT_MAX_KEYS 6
+
+// A HUD string that is only formatted and measured again when the values it
+// shows change. The caller passes those values as an int key each frame
+// (floats pre-rounded to what is displayed).
+typedef struct {
+    char text[128];
+    int width;            // MeasureText of text at fontSize
+    int fontSize;
+    int key[HUD_TEXT_MAX_KEYS];
+    int keyCount;
+    bool valid;
+} HudText;
+
+// True (and the key is remembered) when the text has to be set again
+bool HudTextIsStale(HudText* hud, const int* key, int keyCount);
+
+// Format and measure the text; printf-style
+void HudTextSet(HudText* hud, int fontSize, const char* format, ...);
+
+#endif // HUD_TEXT_H
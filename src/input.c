@@ -0,0 +1,91 @@
+#include "raylib.h"
+#include "input.h"
+
+InputState PollInput(void) {
+    InputState input = { 0 };
+
+    input.moveForward = IsKeyDown(KEY_W) || IsKeyDown(KEY_UP);
+    input.moveBack = IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN);
+    input.moveLeft = IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT);
+    input.moveRight = IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT);
+
+    input.chop = IsKeyPressed(KEY_SPACE);
+    input.nextAnimation = IsKeyPressed(KEY_T);
+    input.prevAnimation = IsKeyPressed(KEY_G);
+    input.toggleHat = IsKeyPressed(KEY_ONE);
+    input.toggleSword = IsKeyPressed(KEY_TWO);
+    input.toggleShield = IsKeyPressed(KEY_THREE);
+
+    if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT)) {
+        input.cameraDrag = true;
+        input.cameraDeltaY = GetMouseDelta().y;
+    }
+
+    return input;
+}
+
+void AccumulateInput(InputState* pending, const InputState* frame) {
+    pending->moveForward = frame->moveForward;
+    pending->moveBack = frame->moveBack;
+    pending->moveLeft = frame->moveLeft;
+    pending->moveRight = frame->moveRight;
+    pending->cameraDrag = frame->cameraDrag;
+
+    pending->chop |= frame->chop;
+    pending->nextAnimation |= frame->nextAnimation;
+    pending->prevAnimation |= frame->prevAnimation;
+    pending->toggleHat |= frame->toggleHat;
+    pending->toggleSword |= frame->toggleSword;
+    pending->toggleShield |= frame->toggleShield;
+    pending->cameraDeltaY += frame->cameraDeltaY;
+}
+
+void ConsumeInputEvents(InputState* pending) {
+    pending->chop = false;
+    pending->nextAnimation = false;
+    pending->prevAnimation = false;
+    pending->toggleHat = false;
+    pending->toggleSword = false;
+    pending->toggleShield = false;
+    pending->cameraDeltaY = 0.0f;
+}
+
+InputState ScriptedInput(unsigned int tick) {
+    InputState input = { 0 };
+
+    // Walk octagonal loops out from the start point, changing direction every
+    // 0.75 s (at 60 ticks/s) on the smallest loop. Each loop is rotated and
+    // scaled differently so the whole tree field gets visited, and a short
+    // pause after every leg exercises idle/walk switching too.
+    unsigned int phase = tick % (8 * 45 * (1 + 2 + 3 + 4));
+    unsigned int scale = 1;
+    while (phase >= 8 * 45 * scale) {
+        phase -= 8 * 45 * scale;
+        scale++;
+    }
+    unsigned int legLength = 45 * scale;
+    unsigned int leg = phase / legLength + tick / (8 * 45 * 10);
+    if (phase % legLength < legLength - 15) {
+        switch (leg % 8) {
+            case 0: input.moveLeft = true; break;
+            case 1: input.moveForward = true; input.moveLeft = true; break;
+            case 2: input.moveForward = true; break;
+            case 3: input.moveForward = true; input.moveRight = true; break;
+            case 4: input.moveRight = true; break;
+            case 5: input.moveBack = true; input.moveRight = true; break;
+            case 6: input.moveBack = true; break;
+            case 7: input.moveBack = true; input.moveLeft = true; break;
+        }
+    }
+
+    // Swing at whatever is in front four times a second
+    input.chop = (tick % 15) == 0;
+
+    // Tilt the camera back and forth now and then
+    if ((tick / 240) % 4 == 1) {
+        input.cameraDrag = true;
+        input.cameraDeltaY = ((tick / 30) % 2) ? 2.0f : -2.0f;
+    }
+
+    return input;
+}
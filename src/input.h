@@ -0,0 +1,37 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+
+// One tick worth of player intent. The game logic only ever reads this, so it
+// can be fed from the keyboard/mouse or from a script.
+typedef struct {
+    bool moveForward;
+    bool moveBack;
+    bool moveLeft;
+    bool moveRight;
+    bool chop;            // SPACE pressed
+    bool nextAnimation;   // T pressed
+    bool prevAnimation;   // G pressed
+    bool toggleHat;       // 1 pressed
+    bool toggleSword;     // 2 pressed
+    bool toggleShield;    // 3 pressed
+    bool cameraDrag;      // Right mouse button held
+    float cameraDeltaY;   // Mouse delta while dragging
+} InputState;
+
+// Read the current keyboard/mouse state through raylib (needs a window)
+InputState PollInput(void);
+
+// Merge a freshly polled frame into input waiting for the next simulation
+// tick: held keys take the latest state, presses and mouse motion add up so
+// nothing is lost when a frame runs zero ticks
+void AccumulateInput(InputState* pending, const InputState* frame);
+
+// Drop the one-shot parts (presses, mouse motion) once a tick has used them
+void ConsumeInputEvents(InputState* pending);
+
+// Deterministic input pattern used to drive the headless simulation
+InputState ScriptedInput(unsigned int tick);
+
+#endif // INPUT_H
@@ -0,0 +1,168 @@
+#define _POSIX_C_SOURCE 200809L
+#include "job_system.h"
+#include <sched.h>
+#include <unistd.h>
+
+// Which system and deque the calling thread belongs to. Threads that
+// aren't workers of a system use its deque 0.
+static __thread JobSystem* currentSystem = NULL;
+static __thread int currentDeque = 0;
+
+static int CallerDeque(const JobSystem* jobs) {
+    return (currentSystem == jobs) ? currentDeque : 0;
+}
+
+static bool PushJob(JobDeque* deque, const Job* job) {
+    pthread_mutex_lock(&deque->mutex);
+    bool pushed = deque->bottom - deque->top < JOB_DEQUE_SIZE;
+    if (pushed) {
+        deque->jobs[deque->bottom & (JOB_DEQUE_SIZE - 1)] = *job;
+        deque->bottom++;
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    return pushed;
+}
+
+static bool PopJob(JobDeque* deque, Job* job) {
+    pthread_mutex_lock(&deque->mutex);
+    bool popped = deque->bottom != deque->top;
+    if (popped) {
+        deque->bottom--;
+        *job = deque->jobs[deque->bottom & (JOB_DEQUE_SIZE - 1)];
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    return popped;
+}
+
+static bool StealJob(JobDeque* deque, Job* job) {
+    pthread_mutex_lock(&deque->mutex);
+    bool stolen = deque->bottom != deque->top;
+    if (stolen) {
+        *job = deque->jobs[deque->top & (JOB_DEQUE_SIZE - 1)];
+        deque->top++;
+    }
+    pthread_mutex_unlock(&deque->mutex);
+    return stolen;
+}
+
+// Own deque first, then the others starting with the next one along
+static bool TakeJob(JobSystem* jobs, int self, Job* job) {
+    int dequeCount = jobs->dequeCount;
+    bool found = PopJob(&jobs->deques[self], job);
+    for (int i = 1; !found && i < dequeCount; i++) {
+        found = StealJob(&jobs->deques[(self + i) % dequeCount], job);
+    }
+    if (found) __atomic_fetch_sub(&jobs->queued, 1, __ATOMIC_RELAXED);
+    return found;
+}
+
+static void RunJob(const Job* job) {
+    job->task(job->userData, job->begin, job->end);
+    __atomic_fetch_sub(&job->counter->pending, 1, __ATOMIC_RELEASE);
+}
+
+static void* WorkerMain(void* arg) {
+    JobWorker* worker = arg;
+    JobSystem* jobs = worker->system;
+    currentSystem = jobs;
+    currentDeque = worker->index;
+
+    for (;;) {
+        Job job;
+        if (TakeJob(jobs, worker->index, &job)) {
+            RunJob(&job);
+            continue;
+        }
+
+        // Submitters bump queued before taking the mutex to signal, so a
+        // job can't slip in between this check and the wait
+        pthread_mutex_lock(&jobs->sleepMutex);
+        while (!jobs->quit && __atomic_load_n(&jobs->queued, __ATOMIC_ACQUIRE) <= 0) {
+            pthread_cond_wait(&jobs->wake, &jobs->sleepMutex);
+        }
+        bool quit = jobs->quit;
+        pthread_mutex_unlock(&jobs->sleepMutex);
+        if (quit) break;
+    }
+    return NULL;
+}
+
+bool InitJobSystem(JobSystem* jobs, int workerCount) {
+    *jobs = (JobSystem){ 0 };
+    if (workerCount < 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workerCount = (cpus > 1) ? (int)cpus - 1 : 0;
+    }
+    if (workerCount > MAX_WORKERS) workerCount = MAX_WORKERS;
+
+    if (pthread_mutex_init(&jobs->sleepMutex, NULL) != 0) return false;
+    if (pthread_cond_init(&jobs->wake, NULL) != 0) {
+        pthread_mutex_destroy(&jobs->sleepMutex);
+        return false;
+    }
+    for (int i = 0; i <= MAX_WORKERS; i++) pthread_mutex_init(&jobs->deques[i].mutex, NULL);
+
+    // Fixed before any worker starts looking at the deques
+    jobs->dequeCount = workerCount + 1;
+    for (int i = 0; i < workerCount; i++) {
+        jobs->workers[i] = (JobWorker){ jobs, i + 1 };
+        if (pthread_create(&jobs->threads[i], NULL, WorkerMain, &jobs->workers[i]) != 0) break;
+        jobs->workerCount++;
+    }
+    return true;
+}
+
+void FreeJobSystem(JobSystem* jobs) {
+    pthread_mutex_lock(&jobs->sleepMutex);
+    jobs->quit = true;
+    pthread_cond_broadcast(&jobs->wake);
+    pthread_mutex_unlock(&jobs->sleepMutex);
+
+    for (int i = 0; i < jobs->workerCount; i++) pthread_join(jobs->threads[i], NULL);
+    for (int i = 0; i <= MAX_WORKERS; i++) pthread_mutex_destroy(&jobs->deques[i].mutex);
+    pthread_cond_destroy(&jobs->wake);
+    pthread_mutex_destroy(&jobs->sleepMutex);
+    *jobs = (JobSystem){ 0 };
+}
+
+void SubmitJob(JobSystem* jobs, ParallelTask task, void* userData, JobCounter* counter) {
+    SubmitJobs(jobs, task, userData, 1, 1, counter);
+}
+
+void SubmitJobs(JobSystem* jobs, ParallelTask task, void* userData, int itemCount, int batchSize, JobCounter* counter) {
+    if (itemCount <= 0) return;
+    if (batchSize < 1) batchSize = 1;
+    int batchCount = (itemCount + batchSize - 1) / batchSize;
+    __atomic_fetch_add(&counter->pending, batchCount, __ATOMIC_RELAXED);
+
+    JobDeque* deque = &jobs->deques[CallerDeque(jobs)];
+    int queued = 0;
+    for (int b = 0; b < batchCount; b++) {
+        int begin = b * batchSize;
+        int end = (begin + batchSize < itemCount) ? begin + batchSize : itemCount;
+        Job job = { task, userData, begin, end, counter };
+        // A full deque means there's plenty queued already; do this one now
+        if (PushJob(deque, &job)) queued++;
+        else RunJob(&job);
+    }
+    __atomic_fetch_add(&jobs->queued, queued, __ATOMIC_RELEASE);
+    if (queued == 0 || jobs->workerCount == 0) return;
+
+    pthread_mutex_lock(&jobs->sleepMutex);
+    if (queued > 1) pthread_cond_broadcast(&jobs->wake);
+    else pthread_cond_signal(&jobs->wake);
+    pthread_mutex_unlock(&jobs->sleepMutex);
+}
+
+void WaitForJobs(JobSystem* jobs, JobCounter* counter) {
+    int self = CallerDeque(jobs);
+    while (JobsPending(counter)) {
+        Job job;
+        if (TakeJob(jobs, self, &job)) RunJob(&job);
+        else sched_yield();
+    }
+}
+
+bool JobsPending(const JobCounter* counter) {
+    return __atomic_load_n(&counter->pending, __ATOMIC_ACQUIRE) > 0;
+}
@@ -0,0 +1,77 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <stdbool.h>
+#include <pthread.h>
+
+#define MAX_WORKERS 16
+#define JOB_DEQUE_SIZE 1024   // Jobs queued per thread, power of two
+
+// Processes items [begin, end) of a job
+typedef void (*ParallelTask)(void* userData, int begin, int end);
+
+// Jobs submitted against a counter that haven't finished yet. Zero it
+// before the first submit; WaitForJobs returns once it's back to zero.
+typedef struct {
+    int pending;          // Atomic
+} JobCounter;
+
+typedef struct {
+    ParallelTask task;
+    void* userData;
+    int begin;
+    int end;
+    JobCounter* counter;
+} Job;
+
+// The owning thread pushes and pops at the bottom (newest first, still hot
+// in its cache), thieves take from the top (oldest, usually the biggest)
+typedef struct {
+    pthread_mutex_t mutex;
+    Job jobs[JOB_DEQUE_SIZE];
+    unsigned int top;
+    unsigned int bottom;
+} JobDeque;
+
+typedef struct JobSystem JobSystem;
+
+typedef struct {
+    JobSystem* system;
+    int index;            // Deque this thread owns
+} JobWorker;
+
+// Work-stealing job system. Every worker thread has its own deque and
+// steals from the others when it runs dry. Deque 0 belongs to the thread
+// that created the system, which runs jobs itself while it waits, so zero
+// workers means every job runs inside WaitForJobs in submission order.
+// Jobs may be submitted from that thread or from inside other jobs.
+struct JobSystem {
+    pthread_t threads[MAX_WORKERS];
+    JobWorker workers[MAX_WORKERS];
+    int workerCount;          // Threads that actually started
+    JobDeque deques[MAX_WORKERS + 1];
+    int dequeCount;           // Thieves look at this many
+
+    pthread_mutex_t sleepMutex;
+    pthread_cond_t wake;      // Workers: jobs were queued or the system is closing
+    int queued;               // Jobs sitting in deques, atomic
+    bool quit;
+};
+
+// workerCount < 0 picks one less than the number of online CPUs
+bool InitJobSystem(JobSystem* jobs, int workerCount);
+// Every counter must have been waited on first
+void FreeJobSystem(JobSystem* jobs);
+
+// Queue task(userData, 0, 1) and return immediately
+void SubmitJob(JobSystem* jobs, ParallelTask task, void* userData, JobCounter* counter);
+
+// Split itemCount items into jobs of batchSize and queue them all
+void SubmitJobs(JobSystem* jobs, ParallelTask task, void* userData, int itemCount, int batchSize, JobCounter* counter);
+
+// Run queued jobs (any of them, not just these) until the counter is zero
+void WaitForJobs(JobSystem* jobs, JobCounter* counter);
+
+bool JobsPending(const JobCounter* counter);
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,153 @@
+#include "raylib.h"
+#include "rlgl.h"
+#include "label_cache.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Layout of one label, matching what the overlay used to draw by hand:
+// a translucent box with the number and its drop shadow inside
+#define LABEL_PADDING_X 6
+#define LABEL_PADDING_Y 4
+#define LABEL_BOX_HEIGHT 36
+#define LABEL_SHADOW_OFFSET 2
+
+void InitLabelCache(LabelCache* cache, int treeCapacity) {
+    *cache = (LabelCache){ 0 };
+    
+    int capacity = (treeCapacity > 0) ? treeCapacity : 1;
+    cache->treeSlot = malloc(sizeof(int) * capacity);
+    if (!cache->treeSlot) {
+        LOGW(LOG_CAT_RENDER, "Not enough memory for the label cache, drawing labels directly");
+        return;
+    }
+    for (int i = 0; i < capacity; i++) cache->treeSlot[i] = -1;
+    cache->treeCapacity = capacity;
+    
+    cache->atlas = LoadRenderTexture(LABEL_SLOT_WIDTH * LABEL_ATLAS_COLUMNS, LABEL_SLOT_HEIGHT * LABEL_ATLAS_ROWS);
+    if (cache->atlas.id == 0) {
+        LOGW(LOG_CAT_RENDER, "Could not create the label atlas, drawing labels directly");
+        return;
+    }
+    BeginTextureMode(cache->atlas);
+    ClearBackground(BLANK);
+    EndTextureMode();
+}
+
+void UnloadLabelCache(LabelCache* cache) {
+    if (cache->atlas.id > 0) UnloadRenderTexture(cache->atlas);
+    free(cache->treeSlot);
+    *cache = (LabelCache){ 0 };
+}
+
+static void DrawLabelBox(const char* text, int textWidth, int x, int y) {
+    DrawRectangle(x, y, textWidth + 2*LABEL_PADDING_X, LABEL_BOX_HEIGHT, (Color){0, 0, 0, 180});
+    DrawText(text, x + LABEL_PADDING_X + LABEL_SHADOW_OFFSET, y + LABEL_PADDING_Y + LABEL_SHADOW_OFFSET, LABEL_FONT_SIZE, BLACK);
+    DrawText(text, x + LABEL_PADDING_X, y + LABEL_PADDING_Y, LABEL_FONT_SIZE, WHITE);
+}
+
+static Rectangle SlotRect(int slot) {
+    return (Rectangle){
+        (float)((slot % LABEL_ATLAS_COLUMNS) * LABEL_SLOT_WIDTH),
+        (float)((slot / LABEL_ATLAS_COLUMNS) * LABEL_SLOT_HEIGHT),
+        LABEL_SLOT_WIDTH, LABEL_SLOT_HEIGHT
+    };
+}
+
+static int FindSlot(const LabelCache* cache, int value) {
+    for (int s = 0; s < LABEL_SLOT_COUNT; s++) {
+        if (cache->slots[s].used && cache->slots[s].value == value) return s;
+    }
+    return -1;
+}
+
+// Free slot if any, otherwise the one unused for longest. Slots drawn this
+// frame are never taken, so -1 means the atlas is full right now.
+static int ClaimSlot(const LabelCache* cache) {
+    int best = -1;
+    for (int s = 0; s < LABEL_SLOT_COUNT; s++) {
+        if (!cache->slots[s].used) return s;
+        if (cache->slots[s].lastFrame == cache->frame) continue;
+        if (best < 0 || cache->slots[s].lastFrame < cache->slots[best].lastFrame) best = s;
+    }
+    return best;
+}
+
+static void RenderSlot(LabelCache* cache, int slot, int value) {
+    char text[16];
+    snprintf(text, sizeof(text), "%d", value);
+    int textWidth = MeasureText(text, LABEL_FONT_SIZE);
+    Rectangle rect = SlotRect(slot);
+    
+    BeginTextureMode(cache->atlas);
+    BeginScissorMode((int)rect.x, (int)rect.y, (int)rect.width, (int)rect.height);
+    ClearBackground(BLANK);
+    // Keep the box's own alpha in the atlas instead of blending it with the cleared texels
+    rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+    DrawLabelBox(text, textWidth, (int)rect.x, (int)rect.y);
+    EndBlendMode();
+    EndScissorMode();
+    EndTextureMode();
+    
+    cache->slots[slot] = (LabelSlot){ value, textWidth + 2*LABEL_PADDING_X, true, cache->frame };
+    cache->renders++;
+}
+
+void UpdateLabelCache(LabelCache* cache, const Tree* trees, const int* treeIndices, int count) {
+    cache->frame++;
+    if (cache->atlas.id == 0) return;
+    
+    for (int n = 0; n < count; n++) {
+        int i = treeIndices[n];
+        int value = trees[i].answerNumber;
+        if (i >= cache->treeCapacity || value == NO_ANSWER) continue;
+        
+        // Still valid unless the answer changed or the slot was reused
+        int slot = cache->treeSlot[i];
+        if (slot < 0 || !cache->slots[slot].used || cache->slots[slot].value != value) {
+            slot = FindSlot(cache, value);
+            if (slot < 0) {
+                slot = ClaimSlot(cache);
+                if (slot >= 0) RenderSlot(cache, slot, value);
+            }
+            cache->treeSlot[i] = slot;
+        }
+        if (slot >= 0) cache->slots[slot].lastFrame = cache->frame;
+    }
+}
+
+int DrawTreeLabels(LabelCache* cache, const Tree* trees, const int* treeIndices, int count, Camera3D camera) {
+    int drawn = 0;
+    
+    for (int n = 0; n < count; n++) {
+        int i = treeIndices[n];
+        int value = trees[i].answerNumber;
+        if (value == NO_ANSWER) continue;
+        
+        Vector3 pos = trees[i].position;
+        Vector2 screenPos = GetWorldToScreen((Vector3){ pos.x, pos.y + 3.5f, pos.z }, camera);
+        
+        // Only draw if position is visible on screen
+        if (screenPos.x < 0 || screenPos.x > SCREEN_WIDTH || screenPos.y < 0 || screenPos.y > SCREEN_HEIGHT) continue;
+        
+        int slot = (i < cache->treeCapacity) ? cache->treeSlot[i] : -1;
+        if (cache->atlas.id > 0 && slot >= 0 && cache->slots[slot].value == value) {
+            // Render textures are stored upside down, hence the flipped source
+            Rectangle rect = SlotRect(slot);
+            Rectangle source = { rect.x, cache->atlas.texture.height - rect.y - rect.height, rect.width, -rect.height };
+            int halfWidth = cache->slots[slot].width/2;
+            DrawTextureRec(cache->atlas.texture, source,
+                           (Vector2){ (float)((int)screenPos.x - halfWidth), (float)((int)screenPos.y - LABEL_BOX_HEIGHT/2 - 2) }, WHITE);
+        } else {
+            // Atlas missing or full this frame
+            char text[16];
+            snprintf(text, sizeof(text), "%d", value);
+            int textWidth = MeasureText(text, LABEL_FONT_SIZE);
+            DrawLabelBox(text, textWidth, (int)screenPos.x - textWidth/2 - LABEL_PADDING_X, (int)screenPos.y - LABEL_BOX_HEIGHT/2 - 2);
+        }
+        drawn++;
+    }
+    
+    return drawn;
+}
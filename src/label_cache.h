@@ -0,0 +1,44 @@
+#ifndef LABEL_CACHE_H
+#define LABEL_CACHE_H
+
+#include "raylib.h"
+#include "game.h"
+
+#define LABEL_FONT_SIZE 32
+#define LABEL_SLOT_WIDTH 112      // Fits "-588" or "1200" (hard tier) with the padding and shadow
+#define LABEL_SLOT_HEIGHT 40
+#define LABEL_ATLAS_COLUMNS 8
+#define LABEL_ATLAS_ROWS 12
+#define LABEL_SLOT_COUNT (LABEL_ATLAS_COLUMNS * LABEL_ATLAS_ROWS)
+
+typedef struct {
+    int value;            // Answer drawn in this slot
+    int width;            // Label width in pixels, background included
+    bool used;
+    unsigned int lastFrame; // Last frame the slot was drawn, for eviction
+} LabelSlot;
+
+// Answer labels rendered once into a texture atlas, one slot per distinct
+// answer, so the per-frame overlay is a single batch of textured quads.
+// A tree keeps its slot until its answerNumber changes.
+typedef struct {
+    RenderTexture2D atlas;
+    LabelSlot slots[LABEL_SLOT_COUNT];
+    int* treeSlot;        // Per tree: slot holding its label, -1 if none
+    int treeCapacity;
+    unsigned int frame;
+    int renders;          // Labels rendered into the atlas so far
+} LabelCache;
+
+// Needs a window; without an atlas labels are drawn directly every frame
+void InitLabelCache(LabelCache* cache, int treeCapacity);
+void UnloadLabelCache(LabelCache* cache);
+
+// Render any missing labels for these trees. Call outside BeginDrawing or
+// at least outside BeginMode3D, since it switches to the atlas target.
+void UpdateLabelCache(LabelCache* cache, const Tree* trees, const int* treeIndices, int count);
+
+// Draw the labels above these trees; returns how many were on screen
+int DrawTreeLabels(LabelCache* cache, const Tree* trees, const int* treeIndices, int count, Camera3D camera);
+
+#endif // LABEL_CACHE_H
@@ -0,0 +1,251 @@
+#define _POSIX_C_SOURCE 199309L  // nanosleep
+#include "raylib.h"
+#include "logger.h"
+#include "timer.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define WRITER_SLEEP_NS 2000000   // Writer poll interval when every ring is empty
+
+static const char* levelNames[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+static const char* levelOptions[] = { "debug", "info", "warn", "error" };
+static const char* categoryNames[LOG_CATEGORY_COUNT] = {
+    "game", "bots", "assets", "render", "replay", "perf", "net", "save", "raylib"
+};
+
+typedef struct {
+    double time;              // Seconds since the logger started
+    unsigned int sequence;    // Order across all threads
+    unsigned char level;
+    unsigned char category;
+    char text[LOG_LINE_SIZE];
+} LogLine;
+
+// Single producer (the thread that owns it), single consumer (the writer).
+// Each side only writes its own index, like the profiler's ring.
+typedef struct {
+    LogLine lines[LOG_RING_SIZE];
+    unsigned int head;        // Next slot to write, advanced by the producer
+    unsigned int tail;        // Next slot to read, advanced by the consumer
+    unsigned int dropped;     // Written by the producer only
+    unsigned int reported;    // Drops the writer has already told about
+} LogRing;
+
+typedef struct {
+    LogRing* rings[LOG_MAX_THREADS];
+    int ringCount;            // Atomic; slots claimed so far, may pass LOG_MAX_THREADS
+    unsigned int sequence;    // Atomic
+    unsigned int unowned;     // Atomic; lines of threads that got no ring
+    unsigned int generation;  // Bumped per InitLogger, so stale thread rings aren't reused
+    unsigned int written;
+    pthread_t writer;
+    int running;              // Atomic
+    int quit;                 // Atomic
+} Logger;
+
+int logMinLevel = LOG_LEVEL_INFO;
+unsigned int logCategoryMask = ~0u;
+static Logger logger;
+
+static __thread LogRing* threadRing;
+static __thread unsigned int threadGeneration;
+static double startTime;  // Times are from the first line or InitLogger, whichever comes first
+
+static double LogStartTime(void) {
+    if (startTime == 0.0) startTime = GetMonotonicSeconds();
+    return startTime;
+}
+
+static void WriteLine(double time, int level, int category, const char* text) {
+    fprintf(stdout, "[%9.3f] %-5s %-6s %s\n", time, levelNames[level], categoryNames[category], text);
+}
+
+// The calling thread's ring, claimed on its first line
+static LogRing* ThreadRing(void) {
+    if (threadGeneration == logger.generation) return threadRing;
+    threadGeneration = logger.generation;
+    threadRing = NULL;
+
+    int index = __atomic_fetch_add(&logger.ringCount, 1, __ATOMIC_ACQ_REL);
+    if (index >= LOG_MAX_THREADS) return NULL;
+    LogRing* ring = calloc(1, sizeof(LogRing));
+    if (ring == NULL) return NULL;
+    __atomic_store_n(&logger.rings[index], ring, __ATOMIC_RELEASE);
+    threadRing = ring;
+    return ring;
+}
+
+static int SequenceBefore(unsigned int a, unsigned int b) {
+    return (int)(a - b) < 0;
+}
+
+// One pass over the rings, oldest line first. Returns how many were written.
+static int DrainRings(void) {
+    int ringCount = __atomic_load_n(&logger.ringCount, __ATOMIC_ACQUIRE);
+    if (ringCount > LOG_MAX_THREADS) ringCount = LOG_MAX_THREADS;
+
+    int written = 0;
+    for (;;) {
+        LogRing* oldest = NULL;
+        unsigned int oldestSequence = 0;
+        for (int r = 0; r < ringCount; r++) {
+            LogRing* ring = __atomic_load_n(&logger.rings[r], __ATOMIC_ACQUIRE);
+            if (ring == NULL) continue;
+            unsigned int tail = ring->tail;
+            if (tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) continue;
+            unsigned int sequence = ring->lines[tail & (LOG_RING_SIZE - 1)].sequence;
+            if (oldest == NULL || SequenceBefore(sequence, oldestSequence)) {
+                oldest = ring;
+                oldestSequence = sequence;
+            }
+        }
+        if (oldest == NULL) break;
+
+        const LogLine* line = &oldest->lines[oldest->tail & (LOG_RING_SIZE - 1)];
+        WriteLine(line->time, line->level, line->category, line->text);
+        __atomic_store_n(&oldest->tail, oldest->tail + 1, __ATOMIC_RELEASE);
+        written++;
+    }
+
+    for (int r = 0; r < ringCount; r++) {
+        LogRing* ring = __atomic_load_n(&logger.rings[r], __ATOMIC_ACQUIRE);
+        if (ring == NULL) continue;
+        unsigned int dropped = __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+        if (dropped == ring->reported) continue;
+        char text[LOG_LINE_SIZE];
+        snprintf(text, sizeof(text), "%u log lines dropped, the writer fell behind", dropped - ring->reported);
+        WriteLine(GetMonotonicSeconds() - LogStartTime(), LOG_LEVEL_WARN, LOG_CAT_PERF, text);
+        ring->reported = dropped;
+    }
+
+    logger.written += written;
+    return written;
+}
+
+// Drains the rings until asked to quit, then writes whatever is left
+static void* WriterMain(void* arg) {
+    (void)arg;
+    for (;;) {
+        bool quit = __atomic_load_n(&logger.quit, __ATOMIC_ACQUIRE);
+        int written = DrainRings();
+        if (written > 0) fflush(stdout);
+        if (quit) break;
+        if (written == 0) {
+            struct timespec pause = { 0, WRITER_SLEEP_NS };
+            nanosleep(&pause, NULL);
+        }
+    }
+    return NULL;
+}
+
+static void RaylibTraceLog(int logLevel, const char* text, va_list args) {
+    int level = LOG_LEVEL_ERROR;
+    if (logLevel <= LOG_DEBUG) level = LOG_LEVEL_DEBUG;
+    else if (logLevel == LOG_INFO) level = LOG_LEVEL_INFO;
+    else if (logLevel == LOG_WARNING) level = LOG_LEVEL_WARN;
+    if (level < logMinLevel || !(logCategoryMask & (1u << LOG_CAT_RAYLIB))) return;
+    LogWriteV(level, LOG_CAT_RAYLIB, text, args);
+}
+
+bool InitLogger(void) {
+    unsigned int generation = logger.generation + 1;
+    logger = (Logger){ 0 };
+    logger.generation = generation;
+    LogStartTime();
+    SetTraceLogCallback(RaylibTraceLog);
+
+    if (pthread_create(&logger.writer, NULL, WriterMain, NULL) != 0) {
+        LOGW(LOG_CAT_PERF, "Could not start the log writer thread, logging directly");
+        return false;
+    }
+    __atomic_store_n(&logger.running, 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void ShutdownLogger(void) {
+    if (!__atomic_load_n(&logger.running, __ATOMIC_ACQUIRE)) return;
+    __atomic_store_n(&logger.running, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&logger.quit, 1, __ATOMIC_RELEASE);
+    pthread_join(logger.writer, NULL);
+
+    unsigned int dropped = __atomic_load_n(&logger.unowned, __ATOMIC_RELAXED);
+    for (int r = 0; r < LOG_MAX_THREADS; r++) {
+        if (logger.rings[r] != NULL) dropped += logger.rings[r]->dropped;
+        free(logger.rings[r]);
+        logger.rings[r] = NULL;
+    }
+    if (dropped > 0) {
+        LOGW(LOG_CAT_PERF, "Log: %u lines written, %u dropped", logger.written, dropped);
+    }
+    fflush(stdout);
+}
+
+bool ParseLogLevel(const char* name, int* level) {
+    for (int l = LOG_LEVEL_DEBUG; l <= LOG_LEVEL_ERROR; l++) {
+        if (strcmp(name, levelOptions[l]) == 0) {
+            *level = l;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParseLogCategories(const char* names, unsigned int* mask) {
+    *mask = 0;
+    const char* name = names;
+    while (*name != '\0') {
+        size_t length = strcspn(name, ",");
+        bool found = false;
+        for (int c = 0; c < LOG_CATEGORY_COUNT; c++) {
+            if (strlen(categoryNames[c]) == length && strncmp(name, categoryNames[c], length) == 0) {
+                *mask |= 1u << c;
+                found = true;
+            }
+        }
+        if (!found) return false;
+        name += length;
+        if (*name == ',') name++;
+    }
+    return true;
+}
+
+void LogWrite(int level, LogCategory category, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    LogWriteV(level, category, format, args);
+    va_end(args);
+}
+
+void LogWriteV(int level, LogCategory category, const char* format, va_list args) {
+    if (level < LOG_LEVEL_DEBUG) level = LOG_LEVEL_DEBUG;
+    if (level > LOG_LEVEL_ERROR) level = LOG_LEVEL_ERROR;
+
+    if (!__atomic_load_n(&logger.running, __ATOMIC_ACQUIRE)) {
+        char text[LOG_LINE_SIZE];
+        vsnprintf(text, sizeof(text), format, args);
+        WriteLine(GetMonotonicSeconds() - LogStartTime(), level, category, text);
+        return;
+    }
+
+    LogRing* ring = ThreadRing();
+    if (ring == NULL) {
+        __atomic_fetch_add(&logger.unowned, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    unsigned int head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == LOG_RING_SIZE) {
+        __atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    LogLine* line = &ring->lines[head & (LOG_RING_SIZE - 1)];
+    line->time = GetMonotonicSeconds() - LogStartTime();
+    line->sequence = __atomic_fetch_add(&logger.sequence, 1, __ATOMIC_RELAXED);
+    line->level = (unsigned char)level;
+    line->category = (unsigned char)category;
+    vsnprintf(line->text, sizeof(line->text), format, args);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
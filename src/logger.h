@@ -0,0 +1,71 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+
+// Build with e.g. `make LOG_LEVEL=1` to compile every LOGD out; LOG_ENABLED
+// also guards work done only for a log line
+#ifndef LOG_COMPILE_LEVEL
+    #define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_LINE_SIZE 232         // Longest message, longer ones are cut
+#define LOG_RING_SIZE 256         // Lines queued per thread, power of two
+#define LOG_MAX_THREADS 64        // Threads past this many have their lines dropped
+
+typedef enum {
+    LOG_CAT_GAME = 0,     // Problems, chops and respawns
+    LOG_CAT_BOTS,         // AI choppers
+    LOG_CAT_ASSETS,       // Model loading and cooking
+    LOG_CAT_RENDER,       // Renderer setup and its fallbacks
+    LOG_CAT_REPLAY,       // Recording, playback and checksums
+    LOG_CAT_PERF,         // Timing reports, jobs and the profiler
+    LOG_CAT_NET,          // Server, clients and their traffic
+    LOG_CAT_SAVE,         // Save files and autosaves
+    LOG_CAT_RAYLIB,       // raylib's own TraceLog output
+    LOG_CATEGORY_COUNT
+} LogCategory;
+
+// Runtime filter on top of LOG_COMPILE_LEVEL, checked by the macros before
+// anything is formatted. Set it before other threads start.
+extern int logMinLevel;
+extern unsigned int logCategoryMask;
+
+// Levels below LOG_COMPILE_LEVEL are constant false, so their lines
+// compile to nothing while their arguments are still type-checked
+#define LOG_ENABLED(level, category) \
+    ((level) >= LOG_COMPILE_LEVEL && (level) >= logMinLevel && (logCategoryMask & (1u << (category))))
+
+#define LOG_AT(level, category, ...) do { \
+    if (LOG_ENABLED(level, category)) LogWrite(level, category, __VA_ARGS__); \
+} while (0)
+
+#define LOGD(category, ...) LOG_AT(LOG_LEVEL_DEBUG, category, __VA_ARGS__)
+#define LOGI(category, ...) LOG_AT(LOG_LEVEL_INFO, category, __VA_ARGS__)
+#define LOGW(category, ...) LOG_AT(LOG_LEVEL_WARN, category, __VA_ARGS__)
+#define LOGE(category, ...) LOG_AT(LOG_LEVEL_ERROR, category, __VA_ARGS__)
+
+// Lines are formatted on the calling thread into that thread's lock-free
+// ring and written to stdout by a background thread, in the order they
+// were logged. A full ring drops the line and counts it. Before
+// InitLogger, after ShutdownLogger or if the writer can't start, lines
+// are written directly instead.
+bool InitLogger(void);
+// Writes out everything queued, then reports dropped lines
+void ShutdownLogger(void);
+
+// "debug", "info", "warn" or "error"
+bool ParseLogLevel(const char* name, int* level);
+// Comma separated category names, e.g. "game,bots"; false on an unknown one
+bool ParseLogCategories(const char* names, unsigned int* mask);
+
+void LogWrite(int level, LogCategory category, const char* format, ...) __attribute__((format(printf, 3, 4)));
+void LogWriteV(int level, LogCategory category, const char* format, va_list args);
+
+#endif // LOGGER_H
@@ -1,160 +1,474 @@
 #include "raylib.h"
 #include "raymath.h"
+#include "game.h"
+#include "bots.h"
+#include "input.h"
+#include "headless.h"
+#include "bench.h"
+#include "world_render.h"
+#include "static_scene.h"
+#include "render_scale.h"
+#include "label_cache.h"
+#include "hud_text.h"
+#include "socket_cache.h"
+#include "anim_pose.h"
+#include "job_system.h"
+#include "logger.h"
+#include "frame_pipeline.h"
+#include "frustum.h"
+#include "asset_loader.h"
+#include "resource_manager.h"
+#include "model_cache.h"
+#include "timer.h"
+#include "profiler.h"
+#include "replay.h"
+#include "save_game.h"
+#include "server.h"
+#include "net_client.h"
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
-#define SCREEN_WIDTH 1280
-#define SCREEN_HEIGHT 720
-
 typedef struct {
-    Vector3 position;
-    Vector3 velocity;
-    float speed;
-    float rotationY;
-    bool isMoving;
-} Player;
+    bool headless;
+    unsigned int ticks;
+    unsigned int seed;
+    DifficultyTier difficulty;
+    int tickRate;
+    int renderFps;
+    float renderScale;
+    float frameBudgetMs;
+    int treesPerChunk;
+    ChopQuery chopQuery;
+    WorldRenderPath renderPath;
+    int crowd;
+    int bots;
+    int workers;
+    bool cook;
+    const char* profileOut;
+    const char* recordPath;
+    const char* replayPath;
+    const char* loadPath;
+    const char* savePath;
+    int autosaveSeconds;
+    int cpuBudgetMb;
+    int gpuBudgetMb;
+    const char* benchmark;
+    bool server;
+    const char* connect;
+    int port;
+    NetShimConfig netShim;
+    int logLevel;
+    unsigned int logCategories;
+} GameOptions;
 
-typedef struct {
-    int a;
-    int b;
-    int operation; // 0: +, 1: -, 2: *
-    int correctAnswer;
-} MathProblem;
+// Longest frame the simulation tries to catch up on; anything beyond that
+// slows the game down instead of spiralling into ever more ticks per frame
+#define MAX_FRAME_TIME 0.25f
 
-typedef struct {
-    int score;
-    MathProblem currentProblem;
-    int possibleAnswers[8];
-} GameState;
+// Trees further than this from the camera target aren't drawn
+#define TREE_DRAW_DISTANCE 100.0f
 
-typedef struct {
-    int hatSocket;
-    int rightHandSocket;
-    int leftHandSocket;
-    bool showHat;
-    bool showSword;
-    bool showShield;
-} Equipment;
+// Extra animated characters standing around the start, to load the pose stage
+#define CROWD_SPACING 2.5f
+#define CHARACTER_BOUND_RADIUS 2.0f
 
-typedef struct {
-    Vector3 position;
-    bool exists;
-    int answerNumber;
-} Tree;
+// Sunflower spiral around the start point, leaving the player some room
+static Vector3 CrowdPosition(int index) {
+    float angle = index * 2.39996f;
+    float radius = 6.0f + CROWD_SPACING * sqrtf((float)index);
+    return (Vector3){ cosf(angle) * radius, 0.0f, sinf(angle) * radius };
+}
 
-typedef struct {
-    Camera3D camera;
-    Vector3 offset;
-    float distance;
-    float rotationX;
-    float rotationY;
-    float sensitivity;
-} GameCamera;
+// Draw the character with a pose from the pose stage by pointing its meshes
+// at those bone matrices for the duration of the draw. meshBones holds the
+// meshes' own pointers meanwhile, one per mesh of the model.
+static void DrawCharacterPose(Model model, Matrix** meshBones, const Matrix* pose, Matrix transform) {
+    for (int m = 0; m < model.meshCount; m++) {
+        meshBones[m] = model.meshes[m].boneMatrices;
+        if (meshBones[m] != NULL) model.meshes[m].boneMatrices = (Matrix*)pose;
+    }
+    
+    model.transform = transform;
+    DrawModel(model, Vector3Zero(), 1.0f, WHITE);
+    
+    for (int m = 0; m < model.meshCount; m++) model.meshes[m].boneMatrices = meshBones[m];
+}
 
-void UpdatePlayer(Player* player, GameCamera* gameCamera);
-void UpdateGameCamera(GameCamera* gameCamera, Player* player);
-int FindBoneSocket(Model model, const char* socketName);
-Matrix GetSocketTransform(Model model, ModelAnimation animation, int frameIndex, int socketIndex, Matrix modelTransform);
-void CheckTreeRemoval(Player* player, Tree* trees, int treeCount, GameState* gameState);
-void GenerateNewMathProblem(GameState* gameState, Tree* trees, int treeCount);
-void ShuffleArray(int* array, int size);
+// Offline step behind `make cook`: write a cooked cache next to each GLB.
+// Meshes and textures are read back from GL, so this needs a (hidden) window.
+static int CookAssets(void) {
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(320, 240, "Cooking assets");
+    
+    int failures = 0;
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        const char* path = GetAssetPath((AssetId)i);
+        if (!FileExists(path)) {
+            LOGW(LOG_CAT_ASSETS, "Skipping %s (not found)", path);
+            continue;
+        }
+        
+        char cachePath[256];
+        GetModelCachePath(path, cachePath, sizeof(cachePath));
+        double start = GetMonotonicSeconds();
+        if (CookModel(path, cachePath)) {
+            LOGI(LOG_CAT_ASSETS, "Cooked %s -> %s (%.1f KB, %.0f ms)", path, cachePath,
+                 GetFileLength(cachePath) / 1024.0, (GetMonotonicSeconds() - start) * 1000.0);
+        } else {
+            LOGE(LOG_CAT_ASSETS, "Failed to cook %s", path);
+            failures++;
+        }
+    }
+    
+    CloseWindow();
+    return (failures > 0) ? 1 : 0;
+}
 
-int main(void) {
-    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Character Movement Game");
-    SetTargetFPS(60);
+static void PrintUsage(const char* program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  --headless       Run the simulation without a window and report ticks/sec\n");
+    printf("  --ticks <n>      Number of ticks to simulate in headless mode (default 100000)\n");
+    printf("  --seed <n>       Random seed (default: current time)\n");
+    printf("  --difficulty <tier> Math problems: easy, normal or hard (default normal)\n");
+    printf("  --tick-rate <hz> Simulation ticks per second, e.g. 30/60/120 (default %d)\n", DEFAULT_TICK_RATE);
+    printf("  --render-fps <n> Render frame cap, 0 for uncapped (default 60)\n");
+    printf("  --render-scale <s> 3D resolution as a fraction of the window, %.2g to 1, or 0 to adapt to --frame-budget (default 0)\n",
+           RENDER_SCALE_MIN);
+    printf("  --frame-budget <ms> Frame time the adaptive render scale aims for (default: the --render-fps frame, or 60 FPS)\n");
+    printf("  --trees <n>      Trees per %.0fx%.0f world chunk (default %d, at most %d)\n", CHUNK_SIZE, CHUNK_SIZE,
+           DEFAULT_TREES_PER_CHUNK, MAX_TREES_PER_CHUNK);
+    printf("  --chop <mode>    Chop query: auto, scan, grid or simd (default auto)\n");
+    printf("  --render <path>  World drawing: instanced or immediate (default instanced)\n");
+    printf("  --crowd <n>      Extra animated characters around the start (default 0)\n");
+    printf("  --bots <n>       AI choppers racing the player for the right tree, up to %d (default 0)\n", MAX_BOTS);
+    printf("  --workers <n>    Job system worker threads, -1 for one per spare core (default -1)\n");
+    printf("  --record <file>  Record the seed and every tick's input to a file\n");
+    printf("  --replay <file>  Play a recording back (windowed or --headless), then check its checksum\n");
+    printf("  --load <file>    Resume the game saved in a file\n");
+    printf("  --save <file>    Save to a file on the way out, every --autosave seconds of play and on F5\n");
+    printf("  --autosave <s>   Seconds of game time between autosaves, 0 for only on exit (default %d)\n", DEFAULT_AUTOSAVE_SECONDS);
+    printf("  --cpu-budget <MB> Memory for loaded models, animations and shaders before unused ones are unloaded (default %d)\n",
+           DEFAULT_RESOURCE_CPU_BUDGET_MB);
+    printf("  --gpu-budget <MB> Likewise for their buffers and textures on the GPU (default %d)\n", DEFAULT_RESOURCE_GPU_BUDGET_MB);
+    printf("  --profile-out <file> Write per-frame stage timings to a CSV file\n");
+    printf("  --cook           Write cooked model caches next to the GLBs and exit\n");
+    printf("  --bench <name>   Run a micro-benchmark and exit (grid, chop, anim, load, net, save)\n");
+    printf("  --server         Run an authoritative server without a window for --ticks ticks\n");
+    printf("  --port <n>       UDP port the server listens on (default %d)\n", NET_DEFAULT_PORT);
+    printf("  --connect <host:port> Play scripted input against a server without a window for --ticks ticks\n");
+    printf("  --net-loss <percent> Simulated packet loss on what this process sends (default 0)\n");
+    printf("  --net-latency <ms> Simulated one-way latency on what this process sends (default 0)\n");
+    printf("  --net-jitter <ms> Extra random latency of up to this much (default 0)\n");
+    printf("  --log-level <level> Least severe log lines shown: debug, info, warn or error (default info)\n");
+    printf("  --log-categories <list> Only log these, e.g. game,bots (game, bots, assets, render, replay, perf, net, save, raylib)\n");
+}
+
+static bool ParseArguments(int argc, char** argv, GameOptions* options) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            options->headless = true;
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            options->ticks = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options->seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--difficulty") == 0 && i + 1 < argc) {
+            if (!ParseDifficulty(argv[++i], &options->difficulty)) return false;
+        } else if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            options->tickRate = atoi(argv[++i]);
+            if (options->tickRate <= 0) return false;
+        } else if (strcmp(argv[i], "--render-fps") == 0 && i + 1 < argc) {
+            options->renderFps = atoi(argv[++i]);
+            if (options->renderFps < 0) return false;
+        } else if (strcmp(argv[i], "--render-scale") == 0 && i + 1 < argc) {
+            options->renderScale = (float)atof(argv[++i]);
+            if (options->renderScale != 0.0f && (options->renderScale < RENDER_SCALE_MIN || options->renderScale > RENDER_SCALE_MAX)) return false;
+        } else if (strcmp(argv[i], "--frame-budget") == 0 && i + 1 < argc) {
+            options->frameBudgetMs = (float)atof(argv[++i]);
+            if (options->frameBudgetMs <= 0.0f) return false;
+        } else if (strcmp(argv[i], "--trees") == 0 && i + 1 < argc) {
+            options->treesPerChunk = atoi(argv[++i]);
+            if (options->treesPerChunk < 0 || options->treesPerChunk > MAX_TREES_PER_CHUNK) return false;
+        } else if (strcmp(argv[i], "--chop") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "auto") == 0) options->chopQuery = CHOP_QUERY_AUTO;
+            else if (strcmp(mode, "scan") == 0) options->chopQuery = CHOP_QUERY_SCAN;
+            else if (strcmp(mode, "grid") == 0) options->chopQuery = CHOP_QUERY_GRID;
+            else if (strcmp(mode, "simd") == 0) options->chopQuery = CHOP_QUERY_SIMD;
+            else return false;
+        } else if (strcmp(argv[i], "--render") == 0 && i + 1 < argc) {
+            const char* path = argv[++i];
+            if (strcmp(path, "instanced") == 0) options->renderPath = WORLD_RENDER_INSTANCED;
+            else if (strcmp(path, "immediate") == 0) options->renderPath = WORLD_RENDER_IMMEDIATE;
+            else return false;
+        } else if (strcmp(argv[i], "--crowd") == 0 && i + 1 < argc) {
+            options->crowd = atoi(argv[++i]);
+            if (options->crowd < 0) return false;
+        } else if (strcmp(argv[i], "--bots") == 0 && i + 1 < argc) {
+            options->bots = atoi(argv[++i]);
+            if (options->bots < 0 || options->bots > MAX_BOTS) return false;
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            options->workers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            options->recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            options->replayPath = argv[++i];
+        } else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            options->loadPath = argv[++i];
+        } else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            options->savePath = argv[++i];
+        } else if (strcmp(argv[i], "--autosave") == 0 && i + 1 < argc) {
+            options->autosaveSeconds = atoi(argv[++i]);
+            if (options->autosaveSeconds < 0) return false;
+        } else if (strcmp(argv[i], "--cpu-budget") == 0 && i + 1 < argc) {
+            options->cpuBudgetMb = atoi(argv[++i]);
+            if (options->cpuBudgetMb < 0) return false;
+        } else if (strcmp(argv[i], "--gpu-budget") == 0 && i + 1 < argc) {
+            options->gpuBudgetMb = atoi(argv[++i]);
+            if (options->gpuBudgetMb < 0) return false;
+        } else if (strcmp(argv[i], "--profile-out") == 0 && i + 1 < argc) {
+            options->profileOut = argv[++i];
+        } else if (strcmp(argv[i], "--cook") == 0) {
+            options->cook = true;
+        } else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            options->benchmark = argv[++i];
+        } else if (strcmp(argv[i], "--server") == 0) {
+            options->server = true;
+        } else if (strcmp(argv[i], "--connect") == 0 && i + 1 < argc) {
+            options->connect = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            options->port = atoi(argv[++i]);
+            if (options->port <= 0 || options->port > 65535) return false;
+        } else if (strcmp(argv[i], "--net-loss") == 0 && i + 1 < argc) {
+            options->netShim.lossPercent = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--net-latency") == 0 && i + 1 < argc) {
+            options->netShim.latencyMs = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--net-jitter") == 0 && i + 1 < argc) {
+            options->netShim.jitterMs = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            if (!ParseLogLevel(argv[++i], &options->logLevel)) return false;
+        } else if (strcmp(argv[i], "--log-categories") == 0 && i + 1 < argc) {
+            if (!ParseLogCategories(argv[++i], &options->logCategories)) return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    GameOptions options = {
+        .headless = false,
+        .ticks = 100000,
+        .seed = (unsigned int)time(NULL),
+        .difficulty = DIFFICULTY_NORMAL,
+        .tickRate = DEFAULT_TICK_RATE,
+        .renderFps = 60,
+        .renderScale = 0.0f,
+        .frameBudgetMs = 0.0f,
+        .treesPerChunk = DEFAULT_TREES_PER_CHUNK,
+        .chopQuery = CHOP_QUERY_AUTO,
+        .renderPath = WORLD_RENDER_INSTANCED,
+        .crowd = 0,
+        .bots = 0,
+        .workers = -1,
+        .cook = false,
+        .profileOut = NULL,
+        .recordPath = NULL,
+        .replayPath = NULL,
+        .loadPath = NULL,
+        .savePath = NULL,
+        .autosaveSeconds = DEFAULT_AUTOSAVE_SECONDS,
+        .cpuBudgetMb = DEFAULT_RESOURCE_CPU_BUDGET_MB,
+        .gpuBudgetMb = DEFAULT_RESOURCE_GPU_BUDGET_MB,
+        .benchmark = NULL,
+        .server = false,
+        .connect = NULL,
+        .port = NET_DEFAULT_PORT,
+        .netShim = { 0.0f, 0.0f, 0.0f },
+        .logLevel = LOG_LEVEL_INFO,
+        .logCategories = ~0u
+    };
+    if (!ParseArguments(argc, argv, &options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    logMinLevel = options.logLevel;
+    logCategoryMask = options.logCategories;
     
-    // Initialize random seed for rock placement
-    srand((unsigned int)time(NULL));
+    if (options.benchmark != NULL) {
+        return RunBenchmark(options.benchmark);
+    }
     
-    // Initialize a few test trees
-    Tree trees[20];
-    int treeCount = 0;
+    // From here on lines are written by the logger's thread; whatever is
+    // still queued goes out on exit, whichever way main returns
+    InitLogger();
+    atexit(ShutdownLogger);
     
-    // Initialize game state
-    GameState gameState = { 0 };
-    gameState.score = 0;
+    if (options.cook) {
+        return CookAssets();
+    }
     
-    // Add more trees in a denser grid pattern
-    for (int x = -3; x <= 3; x++) {
-        for (int z = -3; z <= 3; z++) {
-            if (x == 0 && z == 0) continue; // Skip center where player starts
-            if (treeCount >= 20) break;
-            
-            trees[treeCount].position = (Vector3){x * 6.0f, 0, z * 6.0f};
-            trees[treeCount].exists = true;
-            trees[treeCount].answerNumber = 0; // Will be set when problem is generated
-            treeCount++;
+    SimulationConfig config = DefaultSimulationConfig();
+    config.tickRate = options.tickRate;
+    config.treesPerChunk = options.treesPerChunk;
+    config.chopQuery = options.chopQuery;
+    config.seed = options.seed;
+    config.difficulty = options.difficulty;
+    config.botCount = options.bots;
+    
+    // Networked sessions run without a window, in real time
+    if (options.server) {
+        return RunServer(&config, (uint16_t)options.port, &options.netShim, options.ticks);
+    }
+    if (options.connect != NULL) {
+        NetAddress address;
+        if (!ParseNetAddress(options.connect, &address)) {
+            LOGE(LOG_CAT_NET, "Could not resolve %s", options.connect);
+            return 1;
         }
-        if (treeCount >= 20) break;
+        return RunNetClient(address, &options.netShim, options.ticks, options.seed);
     }
     
-    Player player = {
-        .position = (Vector3){ 0.0f, 0.0f, 0.0f },
-        .velocity = (Vector3){ 0.0f, 0.0f, 0.0f },
-        .speed = 10.0f,
-        .rotationY = 0.0f,
-        .isMoving = false
-    };
+    // Recordings start from a new world, a save doesn't
+    if (options.loadPath != NULL && (options.replayPath != NULL || options.recordPath != NULL)) {
+        LOGE(LOG_CAT_SAVE, "--load can't be combined with --record or --replay");
+        return 1;
+    }
     
-    GameCamera gameCamera = {
-        .camera = {
-            .position = (Vector3){ 0.0f, 0.0f, 0.0f }, // Will be calculated from rotation
-            .target = (Vector3){ 0.0f, 0.0f, 0.0f },
-            .up = (Vector3){ 0.0f, 1.0f, 0.0f },
-            .fovy = 45.0f,
-            .projection = CAMERA_PERSPECTIVE
-        },
-        .offset = (Vector3){ 0.0f, 8.0f, 12.0f },
-        .distance = 20.0f,
-        .rotationX = -60.0f,
-        .rotationY = 0.0f,
-        .sensitivity = 0.3f
-    };
+    // A replay brings its own seed and world
+    ReplayPlayer replay = { 0 };
+    bool replaying = false;
+    if (options.replayPath != NULL) {
+        if (!LoadReplay(&replay, options.replayPath)) return 1;
+        replaying = true;
+        config = ReplayConfig(&replay);
+        options.seed = config.seed;
+        LOGI(LOG_CAT_REPLAY, "Replaying %s: %u ticks at %d Hz, seed %u, %d trees per chunk, %d bots", options.replayPath,
+             replay.header.tickCount, config.tickRate, options.seed, config.treesPerChunk, config.botCount);
+    }
     
-    // Generate initial math problem after trees are created
-    GenerateNewMathProblem(&gameState, trees, treeCount);
+    if (options.headless) {
+        HeadlessOptions headlessOptions = {
+            .ticks = options.ticks,
+            .config = config,
+            .replay = replaying ? &replay : NULL,
+            .recordPath = options.recordPath,
+            .workers = options.workers,
+            .loadPath = options.loadPath,
+            .savePath = options.savePath,
+            .autosaveSeconds = options.autosaveSeconds
+        };
+        int result = RunHeadless(&headlessOptions);
+        FreeReplay(&replay);
+        return result;
+    }
     
-    // Set initial camera position based on rotation
-    UpdateGameCamera(&gameCamera, &player);
+    double startTime = GetMonotonicSeconds();
+    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Character Movement Game");
     
-    Model characterModel = { 0 };
+    // The frame cap is applied at the end of the loop rather than by raylib,
+    // so the time a frame actually takes can be told apart from the wait
+    double framePeriod = (options.renderFps > 0) ? 1.0 / options.renderFps : 0.0;
+    
+    // Model files are read and parsed in the background while the window
+    // comes up and the first frames are drawn
+    AssetLoader assetLoader;
+    StartAssetLoader(&assetLoader);
+    
+    JobSystem jobs;
+    InitJobSystem(&jobs, options.workers);
+    config.jobs = &jobs;
+    
+    // A save resumes where it left off, with its own seed and world
+    Simulation sim;
+    bool started = (options.loadPath != NULL) ? LoadSimulation(&sim, options.loadPath, &jobs) : InitSimulation(&sim, &config);
+    if (!started) {
+        if (options.loadPath == NULL) LOGE(LOG_CAT_GAME, "Failed to allocate a world with %d trees per chunk", config.treesPerChunk);
+        FreeJobSystem(&jobs);
+        StopAssetLoader(&assetLoader);
+        CloseWindow();
+        return 1;
+    }
+    Equipment* equipment = &sim.equipment;
+    
+    WorldRenderer worldRenderer;
+    InitWorldRenderer(&worldRenderer, options.renderPath, sim.treeCount);
+    
+    // Ground, grid and rocks: one baked mesh, or immediate like everything
+    // else when that path was asked for
+    StaticScene staticScene;
+    InitStaticScene(&staticScene, options.renderPath == WORLD_RENDER_INSTANCED);
+    
+    LabelCache labelCache;
+    InitLabelCache(&labelCache, sim.treeCount);
+    
+    // Resolution of the 3D pass, traded against frame time
+    RenderScaler renderScaler;
+    double frameBudget = (options.frameBudgetMs > 0.0f) ? options.frameBudgetMs / 1000.0 : (framePeriod > 0.0) ? framePeriod : 1.0 / 60.0;
+    InitRenderScaler(&renderScaler, options.renderScale, frameBudget);
+    
+    // HUD strings, reformatted only when what they show changes
+    HudText scoreText = { 0 };
+    HudText problemText = { 0 };
+    HudText positionText = { 0 };
+    HudText rateText = { 0 };
+    HudText cubesText = { 0 };
+    HudText objectsText = { 0 };
+    HudText staticText = { 0 };
+    HudText botText = { 0 };
+    HudText collisionText = { 0 };
+    HudText animationText = { 0 };
+    HudText equipmentText = { 0 };
+    HudText resourceText = { 0 };
+    HudText scaleText = { 0 };
+    
+    // Models, animations and shaders are held through the resource manager;
+    // the loader's models show up in it as they finish
+    ResourceManager resources;
+    InitResourceManager(&resources, &assetLoader, (size_t)options.cpuBudgetMb << 20, (size_t)options.gpuBudgetMb << 20);
+    ModelHandle characterHandle = AcquireModel(&resources, GetAssetPath(ASSET_CHARACTER));
+    AnimationsHandle animationsHandle = AcquireAnimations(&resources, GetAssetPath(ASSET_CHARACTER));
+    Model* characterModel = NULL;
     ModelAnimation* modelAnimations = NULL;
     int animationCount = 0;
-    int currentAnimation = 0;
-    int currentFrame = 0;
     bool modelLoaded = false;
+    SocketCache socketCache = { 0 };
     
-    // Equipment models
-    Model hatModel = { 0 };
-    Model swordModel = { 0 };
-    Model shieldModel = { 0 };
-    Equipment equipment = { -1, -1, -1, true, true, true };
+    // Equipment models, held only while shown
+    ModelHandle equipmentHandles[3] = { { 0 } };
     
     // Lighting setup
-    Shader lightingShader = { 0 };
     Vector3 lightPos = { 10.0f, 10.0f, 10.0f };
     Color lightColor = WHITE;
     
-    // Load basic lighting shader
-    lightingShader = LoadShader("assets/shaders/lighting.vs", "assets/shaders/lighting.fs");
-    if (lightingShader.id == 0) {
-        // Use default shader if custom shader not found
-        lightingShader = LoadShaderFromMemory(
+    // Load basic lighting shader, or the default one below if it's not found
+    ShaderHandle lightingHandle = AcquireShader(&resources, "assets/shaders/lighting.vs", "assets/shaders/lighting.fs",
             "#version 330\n"
             "in vec3 vertexPosition;\n"
             "in vec2 vertexTexCoord;\n"
             "in vec3 vertexNormal;\n"
+            "in vec4 vertexBoneIds;\n"
+            "in vec4 vertexBoneWeights;\n"
+            "#define MAX_BONE_NUM 128\n"
+            "uniform mat4 boneMatrices[MAX_BONE_NUM];\n"
             "uniform mat4 mvp;\n"
             "uniform mat4 matModel;\n"
             "out vec2 fragTexCoord;\n"
             "out vec3 fragNormal;\n"
             "out vec3 fragPosition;\n"
             "void main() {\n"
+            "    mat4 skin = vertexBoneWeights.x*boneMatrices[int(vertexBoneIds.x)] +\n"
+            "                vertexBoneWeights.y*boneMatrices[int(vertexBoneIds.y)] +\n"
+            "                vertexBoneWeights.z*boneMatrices[int(vertexBoneIds.z)] +\n"
+            "                vertexBoneWeights.w*boneMatrices[int(vertexBoneIds.w)];\n"
+            "    vec4 skinnedPosition = skin*vec4(vertexPosition, 1.0);\n"
             "    fragTexCoord = vertexTexCoord;\n"
-            "    fragNormal = normalize(vec3(matModel*vec4(vertexNormal, 0.0)));\n"
-            "    fragPosition = vec3(matModel*vec4(vertexPosition, 1.0));\n"
-            "    gl_Position = mvp*vec4(vertexPosition, 1.0);\n"
+            "    fragNormal = normalize(vec3(matModel*(skin*vec4(vertexNormal, 0.0))));\n"
+            "    fragPosition = vec3(matModel*skinnedPosition);\n"
+            "    gl_Position = mvp*skinnedPosition;\n"
             "}",
             "#version 330\n"
             "in vec2 fragTexCoord;\n"
@@ -175,567 +489,517 @@ int main(void) {
             "    vec3 diffuse = diff * lightColor;\n"
             "    finalColor = vec4((ambient + diffuse), 1.0) * texelColor * colDiffuse;\n"
             "}"
-        );
-    }
+    );
+    Shader* lightingShader = GetShader(&resources, lightingHandle);
     
     // Set shader uniform locations
-    int lightPosLoc = GetShaderLocation(lightingShader, "lightPos");
-    int viewPosLoc = GetShaderLocation(lightingShader, "viewPos");
-    
-    // Try to load character model
-    if (FileExists("assets/models/greenman.glb")) {
-        characterModel = LoadModel("assets/models/greenman.glb");
-        modelAnimations = LoadModelAnimations("assets/models/greenman.glb", &animationCount);
-        modelLoaded = true;
-        printf("Loaded character model with %d animations\n", animationCount);
-        
-        // Apply lighting shader to character model (use materials[1] like raylib example)
-        if (characterModel.materialCount > 1) {
-            characterModel.materials[1].shader = lightingShader;
-        } else {
-            characterModel.materials[0].shader = lightingShader;
-        }
-        
-        // Find bone sockets
-        equipment.hatSocket = FindBoneSocket(characterModel, "socket_hat");
-        equipment.rightHandSocket = FindBoneSocket(characterModel, "socket_hand_R");
-        equipment.leftHandSocket = FindBoneSocket(characterModel, "socket_hand_L");
-        
-        printf("Hat socket: %d, Right hand: %d, Left hand: %d\n", 
-               equipment.hatSocket, equipment.rightHandSocket, equipment.leftHandSocket);
-    } else {
-        printf("Character model not found. Using basic cube instead.\n");
-    }
-    
-    // Load equipment models (without custom shader for now)
-    if (FileExists("assets/models/greenman_hat.glb")) {
-        hatModel = LoadModel("assets/models/greenman_hat.glb");
-        printf("Loaded hat model\n");
-    }
-    if (FileExists("assets/models/greenman_sword.glb")) {
-        swordModel = LoadModel("assets/models/greenman_sword.glb");
-        printf("Loaded sword model\n");
+    int lightPosLoc = GetShaderLocation(*lightingShader, "lightPos");
+    int viewPosLoc = GetShaderLocation(*lightingShader, "viewPos");
+    
+    // Simulation ticks, world chunks and the bone poses for the player
+    // (instance 0), the crowd and then the bots run as jobs on worker
+    // threads while this thread renders
+    AnimPoseStage poseStage = { 0 };
+    int crowdInstances = 1 + options.crowd;
+    int poseInstances = crowdInstances + sim.botCount;
+    AnimPoseRequest* poseRequests = NULL;
+    Matrix** meshBones = NULL; // DrawCharacterPose's scratch, one per character mesh
+    bool posesReady = false;
+    
+    bool firstFrameLogged = false;
+    bool fullyLoaded = false;
+    
+    // Fixed-timestep loop: real frame time fills the accumulator and the
+    // simulation drains it in whole ticks. Rendering blends the last two
+    // ticks so motion stays smooth at any render rate.
+    //
+    // The ticks are pipelined: a job steps them and captures a snapshot
+    // while this thread draws the snapshot the previous frame's job left,
+    // so what's on screen is one frame behind the input.
+    const float tickDuration = 1.0f / sim.tickRate;
+    float accumulator = 0.0f;
+    InputState pendingInput = { 0 };
+    int maxTicksPerFrame = (int)(MAX_FRAME_TIME * sim.tickRate) + 1;
+    InputState* tickInputs = malloc(sizeof(InputState) * maxTicksPerFrame);
+    FramePipeline pipeline;
+    if (tickInputs == NULL || !InitFramePipeline(&pipeline, &sim, &jobs, maxTicksPerFrame, TREE_DRAW_DISTANCE)) {
+        LOGE(LOG_CAT_PERF, "Failed to allocate the frame pipeline");
+        free(tickInputs);
+        FreeSimulation(&sim);
+        FreeJobSystem(&jobs);
+        FreeResourceManager(&resources);
+        StopAssetLoader(&assetLoader);
+        CloseWindow();
+        return 1;
     }
-    if (FileExists("assets/models/greenman_shield.glb")) {
-        shieldModel = LoadModel("assets/models/greenman_shield.glb");
-        printf("Loaded shield model\n");
-    }
-    
-    while (!WindowShouldClose()) {
-        float deltaTime = GetFrameTime();
-        
-        UpdatePlayer(&player, &gameCamera);
-        
-        // Handle mouse input for camera rotation (vertical only)
-        if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT)) {
-            Vector2 mouseDelta = GetMouseDelta();
-            // Only allow vertical rotation (X axis)
-            gameCamera.rotationX -= mouseDelta.y * gameCamera.sensitivity;
-            
-            // Clamp vertical rotation to look down from above
-            if (gameCamera.rotationX > -20.0f) gameCamera.rotationX = -20.0f;
-            if (gameCamera.rotationX < -80.0f) gameCamera.rotationX = -80.0f;
-        }
-        
-        UpdateGameCamera(&gameCamera, &player);
-        
-        // Check for tree removal
-        CheckTreeRemoval(&player, trees, treeCount, &gameState);
-        
-        // Animation handling
-        if (IsKeyPressed(KEY_T) && animationCount > 1) {
-            currentAnimation = (currentAnimation + 1) % animationCount;
-            currentFrame = 0;
-        }
-        if (IsKeyPressed(KEY_G) && animationCount > 1) {
-            currentAnimation = (currentAnimation - 1 + animationCount) % animationCount;
-            currentFrame = 0;
+    LOGI(LOG_CAT_PERF, "Job system: %d worker threads + main thread", jobs.workerCount);
+    
+    // Frame stage timings: F3 shows the overlay, --profile-out records them all
+    InitProfiler(options.profileOut);
+    
+    ReplayRecorder recorder = { 0 };
+    if (options.recordPath != NULL) StartRecording(&recorder, options.recordPath, &config);
+    TimingLog tickTimes = { 0 };
+    TimingLog frameTimes = { 0 };
+    bool replayFinished = false;
+    
+    // Saves are captured by the simulation job and written by their own thread
+    SaveWriter saveWriter = { 0 };
+    bool saving = options.savePath != NULL && StartSaveWriter(&saveWriter, options.savePath);
+    unsigned int autosaveTicks = (unsigned int)options.autosaveSeconds * (unsigned int)sim.tickRate;
+    unsigned int lastSaveTick = sim.tick;
+    
+    while (!WindowShouldClose() && !replayFinished) {
+        double frameStart = GetMonotonicSeconds();
+        if (IsKeyPressed(KEY_F3)) ToggleProfilerOverlay();
+        PROFILE_BEGIN(PROFILE_FRAME);
+        
+        // Equipment is held only while it's shown, so hidden pieces can be
+        // evicted when the budget needs the room (and are loaded again when
+        // shown)
+        const Equipment* shownEquipment = &GetFrameSnapshot(&pipeline)->equipment;
+        bool shown[3] = { shownEquipment->showHat, shownEquipment->showSword, shownEquipment->showShield };
+        for (int e = 0; e < 3; e++) {
+            if (shown[e] && equipmentHandles[e].id == 0) {
+                equipmentHandles[e] = AcquireModel(&resources, GetAssetPath((AssetId)(ASSET_HAT + e)));
+            } else if (!shown[e] && equipmentHandles[e].id != 0) {
+                ReleaseModel(&resources, &equipmentHandles[e]);
+            }
         }
         
-        if (modelLoaded && animationCount > 0) {
-            // Choose animation based on movement state
-            int targetAnimation = 0; // idle animation
-            if (player.isMoving && animationCount > 1) {
-                targetAnimation = 1; // walking animation (if available)
+        // Pick up models the loader thread has finished reading. Until the
+        // character arrives it is drawn as a cube; equipment attaches as
+        // each piece comes in.
+        UpdateResources(&resources);
+        if (!modelLoaded && GetModel(&resources, characterHandle) != NULL) {
+            characterModel = GetModel(&resources, characterHandle);
+            modelAnimations = GetAnimations(&resources, animationsHandle, &animationCount);
+            modelLoaded = true;
+            sim.animations = modelAnimations;
+            sim.animationCount = animationCount;
+            LOGI(LOG_CAT_ASSETS, "Loaded character model with %d animations from %s (read in %.0f ms, ready at %.0f ms)", animationCount,
+                 assetLoader.slots[ASSET_CHARACTER].cached ? "cache" : "GLB",
+                 assetLoader.slots[ASSET_CHARACTER].readySeconds * 1000.0, (GetMonotonicSeconds() - startTime) * 1000.0);
+            
+            // Apply lighting shader to character model (use materials[1] like raylib example)
+            if (characterModel->materialCount > 1) {
+                characterModel->materials[1].shader = *lightingShader;
+            } else {
+                characterModel->materials[0].shader = *lightingShader;
             }
             
-            // Switch animation if different from current
-            if (currentAnimation != targetAnimation) {
-                currentAnimation = targetAnimation;
-                currentFrame = 0;
+            // Find bone sockets
+            equipment->hatSocket = FindBoneSocket(*characterModel, "socket_hat");
+            equipment->rightHandSocket = FindBoneSocket(*characterModel, "socket_hand_R");
+            equipment->leftHandSocket = FindBoneSocket(*characterModel, "socket_hand_L");
+            
+            LOGI(LOG_CAT_ASSETS, "Hat socket: %d, Right hand: %d, Left hand: %d", 
+                 equipment->hatSocket, equipment->rightHandSocket, equipment->leftHandSocket);
+            
+            // Bake attachment transforms for every animation frame
+            int socketBones[SOCKET_COUNT] = { equipment->hatSocket, equipment->rightHandSocket, equipment->leftHandSocket };
+            if (BuildSocketCache(&socketCache, *characterModel, modelAnimations, animationCount, socketBones)) {
+                LOGI(LOG_CAT_ASSETS, "Socket cache: %d animations, %.1f KB, built in %.3f ms",
+                     socketCache.animationCount, socketCache.bytes / 1024.0, socketCache.buildSeconds * 1000.0);
+            } else {
+                LOGW(LOG_CAT_ASSETS, "Not enough memory for the socket cache, equipment will follow the character root");
             }
             
-            currentFrame++;
-            if (currentFrame >= modelAnimations[currentAnimation].frameCount) {
-                currentFrame = 0;
+            if (animationCount > 0 && characterModel->boneCount > 0) {
+                poseRequests = malloc(sizeof(AnimPoseRequest) * poseInstances);
+                meshBones = malloc(sizeof(Matrix*) * ((characterModel->meshCount > 0) ? characterModel->meshCount : 1));
+                posesReady = poseRequests != NULL && meshBones != NULL &&
+                             InitAnimPoseStage(&poseStage, characterModel->bindPose, characterModel->boneCount,
+                                               modelAnimations, animationCount, poseInstances, &jobs);
+                if (posesReady) {
+                    LOGI(LOG_CAT_PERF, "Animating %d characters with %d worker threads (%s)", poseInstances, jobs.workerCount, AnimPoseKernelName());
+                }
             }
-            UpdateModelAnimationBones(characterModel, modelAnimations[currentAnimation], currentFrame);
-        }
-        
-        BeginDrawing();
-        ClearBackground(SKYBLUE);
-        
-        BeginMode3D(gameCamera.camera);
-        
-        // Update shader uniforms
-        if (modelLoaded) {
-            SetShaderValue(lightingShader, lightPosLoc, &lightPos, SHADER_UNIFORM_VEC3);
-            SetShaderValue(lightingShader, viewPosLoc, &gameCamera.camera.position, SHADER_UNIFORM_VEC3);
         }
         
-        // Draw light indicator
-        DrawSphere(lightPos, 0.5f, YELLOW);
-        
-        // Draw background environment (trees and objects)
-        float worldSize = 8 * 8.0f * 2.0f; // Calculate world size based on tree layout
-        
-        // Draw ground to match tree area size
-        DrawPlane((Vector3){ 0.0f, 0.0f, 0.0f }, (Vector2){ worldSize, worldSize }, BEIGE);
-        
-        // Draw trees that still exist
-        for (int i = 0; i < treeCount; i++)
-        {
-            if (trees[i].exists)
-            {
-                Vector3 pos = trees[i].position;
-                // Draw trees (green cube on brown trunk)
-                DrawCube((Vector3){ pos.x, 1.5f, pos.z }, 2.0f, 2.0f, 2.0f, LIME);
-                DrawCube((Vector3){ pos.x, 0.5f, pos.z }, 0.5f, 1.0f, 0.5f, BROWN);
+        if (!fullyLoaded && AllAssetsSettled(&assetLoader)) {
+            fullyLoaded = true;
+            if (GetAssetState(&assetLoader, ASSET_CHARACTER) == ASSET_MISSING) {
+                LOGW(LOG_CAT_ASSETS, "Character model not found. Using basic cube instead.");
             }
+            LOGI(LOG_CAT_ASSETS, "Fully loaded after %.0f ms", (GetMonotonicSeconds() - startTime) * 1000.0);
         }
         
-        // Draw simple number cubes above trees
-        for (int i = 0; i < treeCount; i++)
-        {
-            if (trees[i].exists && trees[i].answerNumber > 0)
-            {
-                Vector3 pos = trees[i].position;
-                Vector3 numberPos = {pos.x, pos.y + 3.5f, pos.z};
-                
-                // Draw a white cube above the tree
-                DrawCube(numberPos, 1.0f, 1.0f, 1.0f, WHITE);
-                DrawCubeWires(numberPos, 1.0f, 1.0f, 1.0f, BLACK);
+        float frameTime = GetFrameTime();
+        if (frameTime > MAX_FRAME_TIME) frameTime = MAX_FRAME_TIME;
+        accumulator += frameTime;
+        
+        PROFILE_BEGIN(PROFILE_INPUT);
+        InputState frameInput = PollInput();
+        AccumulateInput(&pendingInput, &frameInput);
+        PROFILE_END(PROFILE_INPUT);
+        
+        // Gather this frame's tick inputs; the ticks themselves run in the job
+        int ticksThisFrame = 0;
+        while (accumulator >= tickDuration && ticksThisFrame < maxTicksPerFrame) {
+            // A replay replaces the live input tick for tick
+            InputState tickInput = pendingInput;
+            if (replaying && !NextReplayInput(&replay, &tickInput)) {
+                replayFinished = true;
+                break;
             }
+            if (recorder.file != NULL) RecordTick(&recorder, &tickInput);
+            tickInputs[ticksThisFrame++] = tickInput;
+            
+            ConsumeInputEvents(&pendingInput);
+            accumulator -= tickDuration;
         }
         
-        EndMode3D();
+        if (saving && (IsKeyPressed(KEY_F5) || (autosaveTicks > 0 && sim.tick - lastSaveTick >= autosaveTicks))) {
+            RequestFrameSave(&pipeline, &saveWriter);
+            lastSaveTick = sim.tick;
+        }
         
-        // Draw tree answer numbers (2D overlay) - single position above tree
-        for (int i = 0; i < treeCount; i++)
-        {
-            if (trees[i].exists && trees[i].answerNumber > 0)
-            {
-                Vector3 pos = trees[i].position;
-                Vector3 numberWorldPos = {pos.x, pos.y + 3.5f, pos.z};
-                Vector2 screenPos = GetWorldToScreen(numberWorldPos, gameCamera.camera);
-                
-                // Only draw if position is visible on screen
-                if (screenPos.x >= 0 && screenPos.x <= SCREEN_WIDTH && 
-                    screenPos.y >= 0 && screenPos.y <= SCREEN_HEIGHT)
-                {
-                    char numberText[10];
-                    sprintf(numberText, "%d", trees[i].answerNumber);
-                    int textWidth = MeasureText(numberText, 32);
-                    
-                    // Draw background rectangle for better visibility
-                    DrawRectangle((int)screenPos.x - textWidth/2 - 6, (int)screenPos.y - 20, textWidth + 12, 36, (Color){0, 0, 0, 180});
-                    // Draw number with outline
-                    DrawText(numberText, (int)screenPos.x - textWidth/2 + 2, (int)screenPos.y - 16 + 2, 32, BLACK); // Shadow
-                    DrawText(numberText, (int)screenPos.x - textWidth/2, (int)screenPos.y - 16, 32, WHITE);
-                }
-            }
+        // From here until FinishSimulationFrame the simulation belongs to the
+        // job; everything below draws from the previous frame's snapshot
+        KickSimulationFrame(&pipeline, tickInputs, ticksThisFrame, accumulator / tickDuration);
+        const FrameSnapshot* frame = GetFrameSnapshot(&pipeline);
+        const Player* player = &frame->player;
+        const GameState* gameState = &frame->gameState;
+        Camera3D renderCamera = frame->camera;
+        
+        PROFILE_BEGIN(PROFILE_ANIMATION);
+        if (!posesReady && modelLoaded && animationCount > 0) {
+            UpdateModelAnimationBones(*characterModel, modelAnimations[frame->currentAnimation], frame->currentFrame);
         }
+        PROFILE_END(PROFILE_ANIMATION);
         
-        BeginMode3D(gameCamera.camera);
+        // Only trees around where the camera is looking (queried in the
+        // job) get drawn or labeled, and of those only the ones inside the
+        // view frustum
+        PROFILE_BEGIN(PROFILE_CULL);
+        CullWorldObjects(&worldRenderer, frame, renderCamera, (float)GetScreenWidth()/(float)GetScreenHeight(), frame->visibleTrees, frame->visibleCount);
+        UpdateLabelCache(&labelCache, frame->trees, worldRenderer.nearTrees, worldRenderer.nearCount);
+        PROFILE_END(PROFILE_CULL);
         
-        // Draw some rocks for variety at fixed positions
-        Vector3 rockPositions[] = {
-            {12.0f, 0.3f, 15.0f}, {-18.0f, 0.3f, -12.0f}, {25.0f, 0.3f, -8.0f},
-            {-22.0f, 0.3f, 20.0f}, {8.0f, 0.3f, -25.0f}, {-10.0f, 0.3f, 30.0f},
-            {35.0f, 0.3f, 5.0f}, {-28.0f, 0.3f, -18.0f}, {15.0f, 0.3f, 32.0f},
-            {-5.0f, 0.3f, -35.0f}, {28.0f, 0.3f, -22.0f}, {-32.0f, 0.3f, 8.0f}
-        };
+        PROFILE_BEGIN(PROFILE_DRAW_3D);
+        BeginDrawing();
         
-        for (int i = 0; i < 12; i++)
-        {
-            DrawCube(rockPositions[i], 0.8f, 0.6f, 0.8f, GRAY);
+        // The 3D pass is drawn at the render scale's resolution and stretched
+        // over the window; labels and the HUD go on top at full resolution
+        BeginScaledPass(&renderScaler, SKYBLUE);
+        BeginMode3D(renderCamera);
+        
+        // Update shader uniforms
+        if (modelLoaded) {
+            SetShaderValue(*lightingShader, lightPosLoc, &lightPos, SHADER_UNIFORM_VEC3);
+            SetShaderValue(*lightingShader, viewPosLoc, &renderCamera.position, SHADER_UNIFORM_VEC3);
         }
         
-        DrawGrid((int)worldSize, 1.0f);
+        // Draw light indicator
+        DrawSphere(lightPos, 0.5f, YELLOW);
+        
+        // Draw ground, grid and rocks
+        DrawStaticScene(&staticScene, frame);
+        
+        // Draw trees and answer cubes
+        DrawWorldObjects(&worldRenderer, frame);
         
         // Draw character
         if (modelLoaded) {
-            // Save original transform and apply rotation
-            Matrix originalTransform = characterModel.transform;
-            characterModel.transform = MatrixMultiply(MatrixRotateY(player.rotationY * DEG2RAD), 
-                                                    MatrixTranslate(player.position.x, player.position.y, player.position.z));
-            
-            DrawModel(characterModel, Vector3Zero(), 1.0f, WHITE);
-            
-            // Restore original transform
-            characterModel.transform = originalTransform;
+            if (posesReady) {
+                DrawCharacterPose(*characterModel, meshBones, GetAnimPose(&poseStage, 0),
+                                  MatrixMultiply(MatrixRotateY(player->rotationY * DEG2RAD), 
+                                                 MatrixTranslate(player->position.x, player->position.y, player->position.z)));
+                
+                Frustum frustum = GetCameraFrustum(renderCamera, (float)GetScreenWidth()/(float)GetScreenHeight());
+                for (int i = 1; i < crowdInstances; i++) {
+                    Vector3 position = CrowdPosition(i - 1);
+                    if (!IsSphereInFrustum(&frustum, (Vector3){ position.x, 1.0f, position.z }, CHARACTER_BOUND_RADIUS)) continue;
+                    DrawCharacterPose(*characterModel, meshBones, GetAnimPose(&poseStage, i),
+                                      MatrixMultiply(MatrixRotateY(i * 37.0f * DEG2RAD), MatrixTranslate(position.x, position.y, position.z)));
+                }
+                for (int b = 0; b < frame->botCount; b++) {
+                    const Player* bot = &frame->bots[b];
+                    if (!IsSphereInFrustum(&frustum, (Vector3){ bot->position.x, 1.0f, bot->position.z }, CHARACTER_BOUND_RADIUS)) continue;
+                    DrawCharacterPose(*characterModel, meshBones, GetAnimPose(&poseStage, crowdInstances + b),
+                                      MatrixMultiply(MatrixRotateY(bot->rotationY * DEG2RAD),
+                                                     MatrixTranslate(bot->position.x, bot->position.y, bot->position.z)));
+                }
+            } else {
+                // Save original transform and apply rotation
+                Matrix originalTransform = characterModel->transform;
+                characterModel->transform = MatrixMultiply(MatrixRotateY(player->rotationY * DEG2RAD), 
+                                                        MatrixTranslate(player->position.x, player->position.y, player->position.z));
+                
+                DrawModel(*characterModel, Vector3Zero(), 1.0f, WHITE);
+                
+                // Restore original transform
+                characterModel->transform = originalTransform;
+            }
             
             // Draw equipment using proper bone socket transforms with correct character transform
-            Matrix characterTransform = MatrixMultiply(MatrixRotateY(player.rotationY * DEG2RAD), 
-                                                     MatrixTranslate(player.position.x, player.position.y, player.position.z));
+            Matrix characterTransform = MatrixMultiply(MatrixRotateY(player->rotationY * DEG2RAD), 
+                                                     MatrixTranslate(player->position.x, player->position.y, player->position.z));
+            Model* hatModel = GetModel(&resources, equipmentHandles[0]);
+            Model* swordModel = GetModel(&resources, equipmentHandles[1]);
+            Model* shieldModel = GetModel(&resources, equipmentHandles[2]);
             
-            if (equipment.showHat && equipment.hatSocket >= 0 && hatModel.meshCount > 0) {
-                Transform *transform = &modelAnimations[currentAnimation].framePoses[currentFrame][equipment.hatSocket];
-                Quaternion inRotation = characterModel.bindPose[equipment.hatSocket].rotation;
-                Quaternion outRotation = transform->rotation;
-                
-                // Calculate socket rotation (angle between bone in initial pose and same bone in current animation frame)
-                Quaternion rotate = QuaternionMultiply(outRotation, QuaternionInvert(inRotation));
-                Matrix matrixTransform = QuaternionToMatrix(rotate);
-                // Translate socket to its position in the current animation
-                matrixTransform = MatrixMultiply(matrixTransform, MatrixTranslate(transform->translation.x, transform->translation.y, transform->translation.z));
-                // Transform the socket using the transform of the character (angle and translate)
-                matrixTransform = MatrixMultiply(matrixTransform, characterTransform);
+            // Sockets follow the frame the skinned body shows, which trails
+            // the snapshot while poses are evaluated on the job system
+            int socketAnimation = frame->currentAnimation;
+            int socketFrame = frame->currentFrame;
+            AnimPoseRequest shown = posesReady ? GetAnimPoseRequest(&poseStage, 0) : (AnimPoseRequest){ -1, 0.0f };
+            if (shown.animation >= 0) {
+                socketAnimation = shown.animation;
+                socketFrame = (int)shown.frame;
+            }
+            
+            if (frame->equipment.showHat && frame->equipment.hatSocket >= 0 && hatModel != NULL) {
+                // Baked socket rotation/translation for this frame, moved with the character
+                Matrix matrixTransform = GetCachedSocketTransform(&socketCache, socketAnimation, socketFrame, SOCKET_HAT, characterTransform);
                 
                 // Draw mesh at socket position with socket angle rotation (use materials[1] like raylib example)
-                DrawMesh(hatModel.meshes[0], hatModel.materials[1], matrixTransform);
+                DrawMesh(hatModel->meshes[0], hatModel->materials[1], matrixTransform);
             }
             
-            if (equipment.showSword && equipment.rightHandSocket >= 0 && swordModel.meshCount > 0) {
-                Transform *transform = &modelAnimations[currentAnimation].framePoses[currentFrame][equipment.rightHandSocket];
-                Quaternion inRotation = characterModel.bindPose[equipment.rightHandSocket].rotation;
-                Quaternion outRotation = transform->rotation;
-                
-                // Calculate socket rotation (angle between bone in initial pose and same bone in current animation frame)
-                Quaternion rotate = QuaternionMultiply(outRotation, QuaternionInvert(inRotation));
-                Matrix matrixTransform = QuaternionToMatrix(rotate);
-                // Translate socket to its position in the current animation
-                matrixTransform = MatrixMultiply(matrixTransform, MatrixTranslate(transform->translation.x, transform->translation.y, transform->translation.z));
-                // Transform the socket using the transform of the character (angle and translate)
-                matrixTransform = MatrixMultiply(matrixTransform, characterTransform);
+            if (frame->equipment.showSword && frame->equipment.rightHandSocket >= 0 && swordModel != NULL) {
+                // Baked socket rotation/translation for this frame, moved with the character
+                Matrix matrixTransform = GetCachedSocketTransform(&socketCache, socketAnimation, socketFrame, SOCKET_HAND_RIGHT, characterTransform);
                 
                 // Draw mesh at socket position with socket angle rotation (use materials[1] like raylib example)
-                DrawMesh(swordModel.meshes[0], swordModel.materials[1], matrixTransform);
+                DrawMesh(swordModel->meshes[0], swordModel->materials[1], matrixTransform);
             }
             
-            if (equipment.showShield && equipment.leftHandSocket >= 0 && shieldModel.meshCount > 0) {
-                Transform *transform = &modelAnimations[currentAnimation].framePoses[currentFrame][equipment.leftHandSocket];
-                Quaternion inRotation = characterModel.bindPose[equipment.leftHandSocket].rotation;
-                Quaternion outRotation = transform->rotation;
-                
-                // Calculate socket rotation (angle between bone in initial pose and same bone in current animation frame)
-                Quaternion rotate = QuaternionMultiply(outRotation, QuaternionInvert(inRotation));
-                Matrix matrixTransform = QuaternionToMatrix(rotate);
-                // Translate socket to its position in the current animation
-                matrixTransform = MatrixMultiply(matrixTransform, MatrixTranslate(transform->translation.x, transform->translation.y, transform->translation.z));
-                // Transform the socket using the transform of the character (angle and translate)
-                matrixTransform = MatrixMultiply(matrixTransform, characterTransform);
+            if (frame->equipment.showShield && frame->equipment.leftHandSocket >= 0 && shieldModel != NULL) {
+                // Baked socket rotation/translation for this frame, moved with the character
+                Matrix matrixTransform = GetCachedSocketTransform(&socketCache, socketAnimation, socketFrame, SOCKET_HAND_LEFT, characterTransform);
                 
                 // Draw mesh at socket position with socket angle rotation (use materials[1] like raylib example)
-                DrawMesh(shieldModel.meshes[0], shieldModel.materials[1], matrixTransform);
+                DrawMesh(shieldModel->meshes[0], shieldModel->materials[1], matrixTransform);
             }
         } else {
             // Draw simple cube if model not available
-            DrawCube(player.position, 2.0f, 2.0f, 2.0f, RED);
-            DrawCubeWires(player.position, 2.0f, 2.0f, 2.0f, MAROON);
+            DrawCube(player->position, 2.0f, 2.0f, 2.0f, RED);
+            DrawCubeWires(player->position, 2.0f, 2.0f, 2.0f, MAROON);
+        }
+        if (!posesReady) {
+            // Bots as smaller cubes when they can't be animated
+            for (int b = 0; b < frame->botCount; b++) {
+                Vector3 position = frame->bots[b].position;
+                DrawCube((Vector3){ position.x, 0.75f, position.z }, 1.5f, 1.5f, 1.5f, BLUE);
+            }
         }
         
         EndMode3D();
+        EndScaledPass(&renderScaler);
+        PROFILE_END(PROFILE_DRAW_3D);
         
-        // Equipment toggle controls
-        if (IsKeyPressed(KEY_ONE)) equipment.showHat = !equipment.showHat;
-        if (IsKeyPressed(KEY_TWO)) equipment.showSword = !equipment.showSword;  
-        if (IsKeyPressed(KEY_THREE)) equipment.showShield = !equipment.showShield;
+        // Draw tree answer numbers (2D overlay) from the label atlas in one batch.
+        // Culling already dropped trees off screen or too far away to read.
+        PROFILE_BEGIN(PROFILE_LABELS);
+        int labelCount = DrawTreeLabels(&labelCache, frame->trees, worldRenderer.nearTrees, worldRenderer.nearCount, renderCamera);
+        PROFILE_END(PROFILE_LABELS);
+        
+        PROFILE_BEGIN(PROFILE_HUD);
         
         // UI - Score display (top right)
-        DrawText(TextFormat("Score: %d", gameState.score), SCREEN_WIDTH - 150, 10, 30, BLACK);
+        int scoreKey[] = { gameState->score };
+        if (HudTextIsStale(&scoreText, scoreKey, 1)) HudTextSet(&scoreText, 30, "Score: %d", gameState->score);
+        DrawText(scoreText.text, SCREEN_WIDTH - 150, 10, scoreText.fontSize, BLACK);
         
         // UI - Math problem display (center top)
-        char problemText[100];
-        char operatorChar = '+';
-        if (gameState.currentProblem.operation == 1) operatorChar = '-';
-        else if (gameState.currentProblem.operation == 2) operatorChar = '*';
-        
-        sprintf(problemText, "%d %c %d = ?", gameState.currentProblem.a, operatorChar, gameState.currentProblem.b);
-        int textWidth = MeasureText(problemText, 40);
-        DrawText(problemText, (SCREEN_WIDTH - textWidth) / 2, 20, 40, DARKBLUE);
+        const MathProblem* problem = &gameState->currentProblem;
+        int problemKey[] = { problem->a, problem->operation, problem->b, problem->secondOperation, problem->c };
+        if (HudTextIsStale(&problemText, problemKey, 5)) {
+            char problemString[64];
+            FormatMathProblem(problem, problemString, sizeof(problemString));
+            HudTextSet(&problemText, 40, "%s", problemString);
+        }
+        DrawText(problemText.text, (SCREEN_WIDTH - problemText.width) / 2, 20, problemText.fontSize, DARKBLUE);
         
         // UI - Controls
         DrawText("WASD or Arrow Keys to move", 10, 10, 20, DARKGRAY);
         DrawText("SPACE: Remove tree in front", 10, 30, 20, DARKGRAY);
         DrawText("Right Mouse Button + Drag: Tilt camera up/down", 10, 50, 20, DARKGRAY);
-        DrawText(TextFormat("Position: (%.1f, %.1f, %.1f)", player.position.x, player.position.y, player.position.z), 10, 70, 20, DARKGRAY);
+        
+        // Position is shown to 0.1, so that's the resolution it's keyed on
+        int positionKey[] = { (int)roundf(player->position.x*10.0f), (int)roundf(player->position.y*10.0f), (int)roundf(player->position.z*10.0f) };
+        if (HudTextIsStale(&positionText, positionKey, 3)) {
+            HudTextSet(&positionText, 20, "Position: (%.1f, %.1f, %.1f)", positionKey[0]/10.0f, positionKey[1]/10.0f, positionKey[2]/10.0f);
+        }
+        DrawText(positionText.text, 10, 70, positionText.fontSize, DARKGRAY);
+        
+        int rateKey[] = { sim.tickRate, GetFPS() };
+        if (HudTextIsStale(&rateText, rateKey, 2)) HudTextSet(&rateText, 20, "Sim: %d Hz  Render: %d FPS", rateKey[0], rateKey[1]);
+        DrawText(rateText.text, 10, 220, rateText.fontSize, DARKGRAY);
+        
+        int cubesKey[] = { worldRenderer.path, worldRenderer.stats.cubes };
+        if (HudTextIsStale(&cubesText, cubesKey, 2)) {
+            HudTextSet(&cubesText, 20, "%s: %d cubes", (worldRenderer.path == WORLD_RENDER_INSTANCED) ? "Instanced" : "Immediate", worldRenderer.stats.cubes);
+        }
+        DrawText(cubesText.text, 10, 250, cubesText.fontSize, DARKGRAY);
+        
+        int objectsKey[] = { worldRenderer.stats.submitted, worldRenderer.stats.culled, worldRenderer.stats.lod, labelCount, labelCache.renders };
+        if (HudTextIsStale(&objectsText, objectsKey, 5)) {
+            HudTextSet(&objectsText, 20, "Objects: %d submitted, %d culled, %d far  Labels: %d (%d rendered)",
+                       objectsKey[0], objectsKey[1], objectsKey[2], objectsKey[3], objectsKey[4]);
+        }
+        DrawText(objectsText.text, 10, 280, objectsText.fontSize, DARKGRAY);
+        
+        int staticKey[] = { staticScene.stats.drawCalls, staticScene.stats.streamedVertices, staticScene.stats.drawnVertices };
+        if (HudTextIsStale(&staticText, staticKey, 3)) {
+            HudTextSet(&staticText, 20, "Static scene: %d draw calls, %d vertices (%d streamed)",
+                       staticKey[0], staticKey[2], staticKey[1]);
+        }
+        DrawText(staticText.text, 10, 310, staticText.fontSize, DARKGRAY);
+        
+        if (frame->botCount > 0 && frame->botStats.ticks > 0) {
+            // Average cost of the bots per tick so far, in microseconds
+            const BotStats* botStats = &frame->botStats;
+            int botKey[] = { frame->botCount, (int)(botStats->moveSeconds * 1e6 / botStats->ticks),
+                             (int)(botStats->querySeconds * 1e6 / botStats->ticks),
+                             (int)(botStats->scoreSeconds * 1e6 / botStats->ticks), (int)botStats->correctChops };
+            if (HudTextIsStale(&botText, botKey, 5)) {
+                HudTextSet(&botText, 20, "Bots: %d, move %.2f ms, query %.2f ms, score %.2f ms, %d right",
+                           botKey[0], botKey[1] / 1000.0, botKey[2] / 1000.0, botKey[3] / 1000.0, botKey[4]);
+            }
+            DrawText(botText.text, 10, 340, botText.fontSize, DARKGRAY);
+        }
+        
+        if (frame->collisionStats.ticks > 0) {
+            // Per tick averages so far; cost in microseconds
+            const CollisionStats* collisionStats = &frame->collisionStats;
+            int collisionKey[] = { (int)(collisionStats->seconds * 1e6 / collisionStats->ticks),
+                                   (int)(collisionStats->candidates / collisionStats->ticks),
+                                   (int)(collisionStats->contacts / collisionStats->ticks) };
+            if (HudTextIsStale(&collisionText, collisionKey, 3)) {
+                HudTextSet(&collisionText, 20, "Collision: %.3f ms, %d candidates, %d contacts per tick",
+                           collisionKey[0] / 1000.0, collisionKey[1], collisionKey[2]);
+            }
+            DrawText(collisionText.text, 10, 370, collisionText.fontSize, DARKGRAY);
+        }
+        
+        // Live resources per type, in KB
+        const ResourceStats* resourceStats = &resources.stats;
+        int resourceKey[] = { (int)(resourceStats->types[RESOURCE_MODEL].cpuBytes >> 10), (int)(resourceStats->types[RESOURCE_MODEL].gpuBytes >> 10),
+                              (int)(resourceStats->types[RESOURCE_ANIMATIONS].cpuBytes >> 10), (int)(resourceStats->types[RESOURCE_SHADER].cpuBytes >> 10),
+                              (int)resourceStats->evictions };
+        if (HudTextIsStale(&resourceText, resourceKey, 5)) {
+            HudTextSet(&resourceText, 20, "Resources: models %d KB + %d KB GPU, animations %d KB, shaders %d KB, %d evicted",
+                       resourceKey[0], resourceKey[1], resourceKey[2], resourceKey[3], resourceKey[4]);
+        }
+        DrawText(resourceText.text, 10, 400, resourceText.fontSize, DARKGRAY);
+        
+        // Share of recent frames within the budget, in percent
+        int scaleKey[] = { renderScaler.width, renderScaler.height, (int)(RenderScaleHitRate(&renderScaler) * 100.0f + 0.5f) };
+        if (HudTextIsStale(&scaleText, scaleKey, 3)) {
+            HudTextSet(&scaleText, 20, "Render scale: %.0f%% (%dx%d, %s), %d%% of frames within %.1f ms",
+                       renderScaler.scale * 100.0f, scaleKey[0], scaleKey[1], renderScaler.adaptive ? "adaptive" : "fixed",
+                       scaleKey[2], renderScaler.budget * 1000.0);
+        }
+        DrawText(scaleText.text, 10, 430, scaleText.fontSize, DARKGRAY);
+        
         if (modelLoaded) {
-            DrawText(TextFormat("Animation: %d/%d", currentAnimation + 1, animationCount), 10, 100, 20, DARKGRAY);
+            int animationKey[] = { frame->currentAnimation, animationCount };
+            if (HudTextIsStale(&animationText, animationKey, 2)) HudTextSet(&animationText, 20, "Animation: %d/%d", frame->currentAnimation + 1, animationCount);
+            DrawText(animationText.text, 10, 100, animationText.fontSize, DARKGRAY);
             DrawText("Press T/G to change animation", 10, 130, 20, DARKGRAY);
             DrawText("1: Toggle Hat  2: Toggle Sword  3: Toggle Shield", 10, 160, 20, DARKGRAY);
-            DrawText(TextFormat("Hat: %s  Sword: %s  Shield: %s", 
-                              equipment.showHat ? "ON" : "OFF",
-                              equipment.showSword ? "ON" : "OFF", 
-                              equipment.showShield ? "ON" : "OFF"), 10, 190, 20, DARKGRAY);
+            int equipmentKey[] = { frame->equipment.showHat, frame->equipment.showSword, frame->equipment.showShield };
+            if (HudTextIsStale(&equipmentText, equipmentKey, 3)) {
+                HudTextSet(&equipmentText, 20, "Hat: %s  Sword: %s  Shield: %s", 
+                           frame->equipment.showHat ? "ON" : "OFF",
+                           frame->equipment.showSword ? "ON" : "OFF", 
+                           frame->equipment.showShield ? "ON" : "OFF");
+            }
+            DrawText(equipmentText.text, 10, 190, equipmentText.fontSize, DARKGRAY);
         }
+        PROFILE_END(PROFILE_HUD);
+        
+        DrawProfilerOverlay(SCREEN_WIDTH - 270, 50);
         
+        PROFILE_BEGIN(PROFILE_PRESENT);
         EndDrawing();
-    }
-    
-    if (modelLoaded) {
-        UnloadModelAnimations(modelAnimations, animationCount);
-        UnloadModel(characterModel);
-    }
-    
-    // Unload equipment models
-    if (hatModel.meshCount > 0) UnloadModel(hatModel);
-    if (swordModel.meshCount > 0) UnloadModel(swordModel);
-    if (shieldModel.meshCount > 0) UnloadModel(shieldModel);
-    
-    // Unload shader
-    if (lightingShader.id > 0) UnloadShader(lightingShader);
-    
-    CloseWindow();
-    return 0;
-}
-
-void GenerateNewMathProblem(GameState* gameState, Tree* trees, int treeCount) {
-    // Count existing trees
-    int existingTreeCount = 0;
-    for (int i = 0; i < treeCount; i++) {
-        if (trees[i].exists) {
-            existingTreeCount++;
+        PROFILE_END(PROFILE_PRESENT);
+        
+        // Whatever of the ticks hasn't finished while this thread drew
+        PROFILE_BEGIN(PROFILE_SIM_WAIT);
+        FinishSimulationFrame(&pipeline);
+        PROFILE_END(PROFILE_SIM_WAIT);
+        frame = GetFrameSnapshot(&pipeline);
+        if (replaying) {
+            for (int t = 0; t < frame->ticks; t++) LogTiming(&tickTimes, pipeline.tickSeconds[t]);
         }
-    }
-    
-    if (existingTreeCount == 0) return; // No trees to assign answers to
-    
-    // Generate random math problem
-    gameState->currentProblem.a = rand() % 20 + 1; // 1-20
-    gameState->currentProblem.b = rand() % 20 + 1; // 1-20
-    gameState->currentProblem.operation = rand() % 3; // 0: +, 1: -, 2: *
-    
-    // Calculate correct answer
-    switch (gameState->currentProblem.operation) {
-        case 0: // Addition
-            gameState->currentProblem.correctAnswer = gameState->currentProblem.a + gameState->currentProblem.b;
-            break;
-        case 1: // Subtraction
-            gameState->currentProblem.correctAnswer = gameState->currentProblem.a - gameState->currentProblem.b;
-            break;
-        case 2: // Multiplication
-            gameState->currentProblem.correctAnswer = gameState->currentProblem.a * gameState->currentProblem.b;
-            break;
-    }
-    
-    // Determine how many answers we need
-    int numAnswers = (existingTreeCount < 8) ? existingTreeCount : 8;
-    
-    // Create array of possible answers (including correct one)
-    gameState->possibleAnswers[0] = gameState->currentProblem.correctAnswer;
-    
-    // Generate wrong answers
-    for (int i = 1; i < numAnswers; i++) {
-        int wrongAnswer;
-        bool duplicate;
-        int attempts = 0;
-        do {
-            duplicate = false;
-            attempts++;
-            // Generate wrong answer within reasonable range
-            wrongAnswer = gameState->currentProblem.correctAnswer + (rand() % 21) - 10; // +/- 10
-            if (wrongAnswer < 0) wrongAnswer = abs(wrongAnswer); // Keep positive
-            
-            // Check for duplicates
-            for (int j = 0; j < i; j++) {
-                if (gameState->possibleAnswers[j] == wrongAnswer) {
-                    duplicate = true;
-                    break;
-                }
-            }
-        } while (duplicate && attempts < 50); // Prevent infinite loop
         
-        gameState->possibleAnswers[i] = wrongAnswer;
-    }
-    
-    // Shuffle the answers
-    ShuffleArray(gameState->possibleAnswers, numAnswers);
-    
-    // Assign answers to existing trees
-    int answerIndex = 0;
-    for (int i = 0; i < treeCount && answerIndex < numAnswers; i++) {
-        if (trees[i].exists) {
-            trees[i].answerNumber = gameState->possibleAnswers[answerIndex];
-            answerIndex++;
-            printf("Tree %d assigned answer: %d\n", i, trees[i].answerNumber);
+        // Poses for the new snapshot, evaluated while the next frame draws
+        // this one (so they trail it by a frame)
+        PROFILE_BEGIN(PROFILE_ANIMATION);
+        if (posesReady && frame->ticks > 0) {
+            // Crowd members loop through the clips at their own phase
+            float animationTime = (float)frame->tick * ANIMATION_FPS / sim.tickRate;
+            poseRequests[0] = (AnimPoseRequest){ frame->currentAnimation, (float)frame->currentFrame };
+            for (int i = 1; i < crowdInstances; i++) {
+                poseRequests[i] = (AnimPoseRequest){ i % animationCount, animationTime + i * 7.3f };
+            }
+            // Bots walk or idle like the player does
+            for (int b = 0; b < frame->botCount; b++) {
+                int animation = (frame->bots[b].isMoving && animationCount > 1) ? 1 : 0;
+                poseRequests[crowdInstances + b] = (AnimPoseRequest){ animation, animationTime + b * 7.3f };
+            }
+            KickAnimPoses(&poseStage, poseRequests, poseInstances);
         }
-    }
-    
-    printf("Math problem: %d %c %d = %d\n", 
-           gameState->currentProblem.a, 
-           (gameState->currentProblem.operation == 0) ? '+' : 
-           (gameState->currentProblem.operation == 1) ? '-' : '*',
-           gameState->currentProblem.b,
-           gameState->currentProblem.correctAnswer);
-}
-
-void ShuffleArray(int* array, int size) {
-    for (int i = size - 1; i > 0; i--) {
-        int j = rand() % (i + 1);
-        int temp = array[i];
-        array[i] = array[j];
-        array[j] = temp;
-    }
-}
-
-void UpdatePlayer(Player* player, GameCamera* gameCamera) {
-    Vector3 movement = { 0.0f, 0.0f, 0.0f };
-    bool moving = false;
-    
-    // Input handling - screen relative movement
-    if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) {
-        movement.z -= 1.0f; // Forward relative to camera
-        moving = true;
-    }
-    if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN)) {
-        movement.z += 1.0f; // Backward relative to camera
-        moving = true;
-    }
-    if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT)) {
-        movement.x -= 1.0f; // Left relative to camera
-        moving = true;
-    }
-    if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT)) {
-        movement.x += 1.0f; // Right relative to camera
-        moving = true;
-    }
-    
-    player->isMoving = moving;
-    
-    if (moving) {
-        // Normalize movement vector
-        movement = Vector3Normalize(movement);
+        PROFILE_END(PROFILE_ANIMATION);
         
-        // Since camera Y rotation is fixed at 0, movement is direct
-        Vector3 worldMovement = {
-            movement.x,
-            0.0f,
-            movement.z
-        };
+        PROFILE_END(PROFILE_FRAME);
+        ProfileEndFrame();
         
-        // Calculate rotation based on movement direction
-        player->rotationY = atan2f(worldMovement.x, worldMovement.z) * RAD2DEG;
+        // Pick the next frame's resolution from what this one took, then
+        // wait out the rest of the frame
+        double frameSeconds = GetMonotonicSeconds() - frameStart;
+        UpdateRenderScale(&renderScaler, frameSeconds);
+        SleepSeconds(framePeriod - frameSeconds);
+        if (replaying) LogTiming(&frameTimes, GetMonotonicSeconds() - frameStart);
         
-        // Apply movement
-        float deltaTime = GetFrameTime();
-        player->velocity = Vector3Scale(worldMovement, player->speed);
-        player->position = Vector3Add(player->position, Vector3Scale(player->velocity, deltaTime));
-    } else {
-        player->velocity = (Vector3){ 0.0f, 0.0f, 0.0f };
+        if (!firstFrameLogged) {
+            firstFrameLogged = true;
+            LOGI(LOG_CAT_PERF, "First frame after %.0f ms", (GetMonotonicSeconds() - startTime) * 1000.0);
+        }
     }
-}
-
-void UpdateGameCamera(GameCamera* gameCamera, Player* player) {
-    // Calculate camera position based on rotation angles
-    float radX = gameCamera->rotationX * DEG2RAD;
-    float radY = gameCamera->rotationY * DEG2RAD;
-    
-    // Calculate offset based on spherical coordinates (corrected for proper top-down view)
-    Vector3 offset = {
-        gameCamera->distance * cosf(radX) * sinf(radY),
-        gameCamera->distance * -sinf(radX), // Negative to look down from above
-        gameCamera->distance * cosf(radX) * cosf(radY)
-    };
-    
-    // Position camera relative to player
-    Vector3 targetPosition = Vector3Add(player->position, offset);
     
-    // Smooth camera movement
-    gameCamera->camera.position = Vector3Lerp(gameCamera->camera.position, targetPosition, 0.1f);
-    gameCamera->camera.target = Vector3Lerp(gameCamera->camera.target, player->position, 0.1f);
-}
-
-int FindBoneSocket(Model model, const char* socketName) {
-    for (int i = 0; i < model.boneCount; i++) {
-        if (TextIsEqual(model.bones[i].name, socketName)) {
-            return i;
-        }
+    if (replaying) {
+        ReportReplayChecksum(&replay, &sim);
+        PrintTimingSummary("tick", &tickTimes);
+        PrintTimingSummary("frame", &frameTimes);
+        FreeReplay(&replay);
     }
-    return -1; // Socket not found
-}
-
-Matrix GetSocketTransform(Model model, ModelAnimation animation, int frameIndex, int socketIndex, Matrix modelTransform) {
-    if (socketIndex < 0 || socketIndex >= model.boneCount || frameIndex >= animation.frameCount) {
-        return MatrixIdentity();
+    if (recorder.file != NULL) FinishRecording(&recorder, &sim);
+    if (saving) {
+        WaitForSave(&saveWriter);
+        RequestSave(&saveWriter, &sim);
+        StopSaveWriter(&saveWriter);
     }
+    FreeTimingLog(&tickTimes);
+    FreeTimingLog(&frameTimes);
+    ShutdownProfiler();
+    
+    // Workers read the animations, so stop them first
+    if (posesReady) FreeAnimPoseStage(&poseStage);
+    free(poseRequests);
+    free(meshBones);
+    FreeFramePipeline(&pipeline);
+    free(tickInputs);
+    FreeSimulation(&sim); // Waits for chunks still being generated
+    FreeJobSystem(&jobs);
+    
+    if (modelLoaded) FreeSocketCache(&socketCache);
+    
+    // Models, animations and the shader, held or not. Cached models point
+    // into the loader's mappings, so the loader goes last.
+    LogResourceStats(&resources);
+    FreeResourceManager(&resources);
+    StopAssetLoader(&assetLoader);
+    
+    UnloadRenderScaler(&renderScaler);
+    UnloadLabelCache(&labelCache);
+    UnloadStaticScene(&staticScene);
+    UnloadWorldRenderer(&worldRenderer);
     
-    // Get current animation frame bone transform and bind pose
-    Transform* frameTransform = &animation.framePoses[frameIndex][socketIndex];
-    Transform* bindPose = &model.bindPose[socketIndex];
-    
-    // Calculate relative rotation from bind pose to current frame (same as raylib example)
-    Quaternion inRotation = bindPose->rotation;
-    Quaternion outRotation = frameTransform->rotation;
-    Quaternion rotate = QuaternionMultiply(outRotation, QuaternionInvert(inRotation));
-    
-    // Create transform matrix (same order as raylib example)
-    Matrix matrixTransform = QuaternionToMatrix(rotate);
-    matrixTransform = MatrixMultiply(matrixTransform, MatrixTranslate(frameTransform->translation.x, 
-                                                                     frameTransform->translation.y, 
-                                                                     frameTransform->translation.z));
-    
-    // Apply character model transform (same as raylib example)
-    return MatrixMultiply(matrixTransform, modelTransform);
-}
-
-void CheckTreeRemoval(Player* player, Tree* trees, int treeCount, GameState* gameState) {
-    if (!IsKeyPressed(KEY_SPACE)) return;
-    
-    // Calculate direction player is facing
-    float playerAngle = player->rotationY * DEG2RAD;
-    Vector3 forward = { sinf(playerAngle), 0.0f, cosf(playerAngle) };
-    
-    // Check trees within removal range
-    float removalRange = 4.0f;
-    
-    for (int i = 0; i < treeCount; i++) {
-        if (!trees[i].exists) continue;
-        
-        Vector3 toTree = Vector3Subtract(trees[i].position, player->position);
-        float distance = Vector3Length(toTree);
-        
-        // Check if tree is within range
-        if (distance <= removalRange) {
-            // Check if tree is roughly in front of player
-            Vector3 normalizedToTree = Vector3Normalize(toTree);
-            float dot = Vector3DotProduct(forward, normalizedToTree);
-            
-            // If dot product > 0.5, tree is in front of player (within ~60 degrees)
-            if (dot > 0.5f) {
-                trees[i].exists = false;
-                
-                // Check if this tree has the correct answer
-                if (trees[i].answerNumber == gameState->currentProblem.correctAnswer) {
-                    gameState->score += 1;
-                    printf("Correct! Score +1. Tree removed at position (%.1f, %.1f)\n", trees[i].position.x, trees[i].position.z);
-                } else {
-                    gameState->score -= 2;
-                    printf("Wrong! Score -2. Tree removed at position (%.1f, %.1f)\n", trees[i].position.x, trees[i].position.z);
-                }
-                
-                // Generate new math problem
-                GenerateNewMathProblem(gameState, trees, treeCount);
-                
-                // Respawn tree at random position
-                float worldSize = 64.0f; // Match the world size
-                float minDistance = 8.0f; // Minimum distance from player
-                Vector3 newPos;
-                int attempts = 0;
-                
-                // Try to find a valid position (not too close to player)
-                do {
-                    newPos.x = (float)(rand() % (int)(worldSize * 2)) - worldSize;
-                    newPos.y = 0.0f;
-                    newPos.z = (float)(rand() % (int)(worldSize * 2)) - worldSize;
-                    attempts++;
-                } while (Vector3Distance(newPos, player->position) < minDistance && attempts < 10);
-                
-                trees[i].position = newPos;
-                trees[i].exists = true;
-                printf("Tree respawned at position (%.1f, %.1f)\n", newPos.x, newPos.z);
-                break; // Remove only one tree per space press
-            }
-        }
-    }
+    CloseWindow();
+    return 0;
 }
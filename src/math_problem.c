@@ -0,0 +1,172 @@
+#include "math_problem.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PROBLEM_STREAM 2          // Rng stream, apart from the world's
+#define MAX_DISTRACTOR_SPREAD 32
+
+static const ProblemDifficulty difficulties[DIFFICULTY_COUNT] = {
+    //  name      min max factor  sub   mul    div    neg    2-step spread
+    { "easy",     1,  10,  5,    true, false, false, false,  0,     5 },
+    { "normal",   1,  20,  20,   true, true,  false, true,   0,     10 },
+    { "hard",     1,  50,  12,   true, true,  true,  true,   50,    12 }
+};
+
+const ProblemDifficulty* GetProblemDifficulty(DifficultyTier tier) {
+    if ((int)tier < 0 || tier >= DIFFICULTY_COUNT) tier = DIFFICULTY_NORMAL;
+    return &difficulties[tier];
+}
+
+bool ParseDifficulty(const char* name, DifficultyTier* tier) {
+    for (int i = 0; i < DIFFICULTY_COUNT; i++) {
+        if (strcmp(name, difficulties[i].name) == 0) {
+            *tier = (DifficultyTier)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int ApplyOperation(int x, int operation, int y) {
+    switch (operation) {
+        case OPERATION_SUBTRACT: return x - y;
+        case OPERATION_MULTIPLY: return x * y;
+        case OPERATION_DIVIDE: return x / y;
+        default: return x + y;
+    }
+}
+
+static int PickOperation(Rng* rng, const ProblemDifficulty* difficulty, bool allowDivision) {
+    int operations[4];
+    int count = 0;
+    operations[count++] = OPERATION_ADD;
+    if (difficulty->subtraction) operations[count++] = OPERATION_SUBTRACT;
+    if (difficulty->multiplication) operations[count++] = OPERATION_MULTIPLY;
+    if (difficulty->division && allowDivision) operations[count++] = OPERATION_DIVIDE;
+    return operations[RngRange(rng, 0, count - 1)];
+}
+
+static void GenerateProblem(Rng* rng, const ProblemDifficulty* difficulty, MathProblem* problem) {
+    int low = difficulty->minOperand;
+    int high = difficulty->maxOperand;
+    int factor = difficulty->maxFactor;
+
+    problem->operation = PickOperation(rng, difficulty, true);
+    switch (problem->operation) {
+        case OPERATION_MULTIPLY:
+            problem->a = RngRange(rng, low, factor);
+            problem->b = RngRange(rng, low, factor);
+            break;
+        case OPERATION_DIVIDE: {
+            int divisor = RngRange(rng, (low > 1) ? low : 1, factor);
+            problem->a = divisor * RngRange(rng, low, factor);
+            problem->b = divisor;
+            break;
+        }
+        default:
+            problem->a = RngRange(rng, low, high);
+            problem->b = RngRange(rng, low, high);
+            if (problem->operation == OPERATION_SUBTRACT && !difficulty->negativeAnswers && problem->a < problem->b) {
+                int swap = problem->a;
+                problem->a = problem->b;
+                problem->b = swap;
+            }
+            break;
+    }
+    int value = ApplyOperation(problem->a, problem->operation, problem->b);
+
+    problem->c = 0;
+    problem->secondOperation = -1;
+    if (RngRange(rng, 0, 99) < difficulty->twoStepPercent) {
+        int second = PickOperation(rng, difficulty, false);
+        // Products of products get out of hand
+        if (second == OPERATION_MULTIPLY && problem->operation >= OPERATION_MULTIPLY) second = OPERATION_ADD;
+        if (second == OPERATION_SUBTRACT && !difficulty->negativeAnswers && value < low) second = OPERATION_ADD;
+
+        int cHigh = high;
+        if (second == OPERATION_MULTIPLY) cHigh = factor;
+        else if (second == OPERATION_SUBTRACT && !difficulty->negativeAnswers && value < high) cHigh = value;
+        problem->c = RngRange(rng, low, cHigh);
+        problem->secondOperation = second;
+        value = ApplyOperation(value, second, problem->c);
+    }
+    problem->correctAnswer = value;
+}
+
+// Wrong answers are the values around the right one, minus the right one,
+// drawn with a partial shuffle: distinct without any retries
+static void BuildAnswers(Rng* rng, const ProblemDifficulty* difficulty, PreparedProblem* prepared) {
+    int correct = prepared->problem.correctAnswer;
+    int spread = difficulty->distractorSpread;
+    if (spread > MAX_DISTRACTOR_SPREAD) spread = MAX_DISTRACTOR_SPREAD;
+    if (spread * 2 < MAX_ANSWERS - 1) spread = MAX_ANSWERS / 2;
+
+    int low = correct - spread;
+    if (!difficulty->negativeAnswers && low < 0) low = 0;
+
+    int candidates[2 * MAX_DISTRACTOR_SPREAD + 1];
+    int count = 0;
+    for (int value = low; value <= low + 2 * spread; value++) {
+        if (value != correct) candidates[count++] = value;
+    }
+    for (int i = 0; i < MAX_ANSWERS - 1; i++) {
+        int j = RngRange(rng, i, count - 1);
+        int swap = candidates[i];
+        candidates[i] = candidates[j];
+        candidates[j] = swap;
+    }
+
+    prepared->correctSlot = RngRange(rng, 0, MAX_ANSWERS - 1);
+    int next = 0;
+    for (int slot = 0; slot < MAX_ANSWERS; slot++) {
+        prepared->answers[slot] = (slot == prepared->correctSlot) ? correct : candidates[next++];
+    }
+}
+
+void InitProblemEngine(ProblemEngine* engine, uint64_t seed, DifficultyTier tier) {
+    *engine = (ProblemEngine){ 0 };
+    SeedRng(&engine->rng, seed, PROBLEM_STREAM);
+    engine->tier = ((int)tier >= 0 && tier < DIFFICULTY_COUNT) ? tier : DIFFICULTY_NORMAL;
+    RefillProblemPool(engine, PROBLEM_POOL_SIZE);
+}
+
+void RefillProblemPool(ProblemEngine* engine, int maxProblems) {
+    const ProblemDifficulty* difficulty = GetProblemDifficulty(engine->tier);
+    for (int i = 0; i < maxProblems && engine->count < PROBLEM_POOL_SIZE; i++) {
+        PreparedProblem* prepared = &engine->pool[(engine->head + engine->count) % PROBLEM_POOL_SIZE];
+        GenerateProblem(&engine->rng, difficulty, &prepared->problem);
+        BuildAnswers(&engine->rng, difficulty, prepared);
+        engine->count++;
+        engine->generated++;
+    }
+}
+
+PreparedProblem TakeProblem(ProblemEngine* engine) {
+    if (engine->count == 0) {
+        engine->poolMisses++;
+        RefillProblemPool(engine, 1);
+    }
+    PreparedProblem prepared = engine->pool[engine->head];
+    engine->head = (engine->head + 1) % PROBLEM_POOL_SIZE;
+    engine->count--;
+    return prepared;
+}
+
+static char OperatorChar(int operation) {
+    static const char operators[] = "+-*/";
+    return (operation >= 0 && operation < 4) ? operators[operation] : '?';
+}
+
+void FormatMathProblem(const MathProblem* problem, char* text, int size) {
+    char first = OperatorChar(problem->operation);
+    if (problem->secondOperation < 0) {
+        snprintf(text, size, "%d %c %d = ?", problem->a, first, problem->b);
+        return;
+    }
+
+    // Evaluated left to right, so a sum times something needs brackets
+    char second = OperatorChar(problem->secondOperation);
+    bool brackets = problem->secondOperation >= OPERATION_MULTIPLY && problem->operation <= OPERATION_SUBTRACT;
+    snprintf(text, size, brackets ? "(%d %c %d) %c %d = ?" : "%d %c %d %c %d = ?",
+             problem->a, first, problem->b, second, problem->c);
+}
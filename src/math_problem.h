@@ -0,0 +1,83 @@
+#ifndef MATH_PROBLEM_H
+#define MATH_PROBLEM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rng.h"
+
+#define MAX_ANSWERS 8             // Trees labeled per problem
+#define PROBLEM_POOL_SIZE 16      // Problems generated ahead of time
+
+typedef enum {
+    OPERATION_ADD = 0,
+    OPERATION_SUBTRACT,
+    OPERATION_MULTIPLY,
+    OPERATION_DIVIDE
+} Operation;
+
+// a op b, or (a op b) op2 c for a two-step problem
+typedef struct {
+    int a;
+    int b;
+    int operation;        // Operation
+    int c;
+    int secondOperation;  // Operation, or -1 for a single step
+    int correctAnswer;
+} MathProblem;
+
+typedef enum {
+    DIFFICULTY_EASY = 0,
+    DIFFICULTY_NORMAL,
+    DIFFICULTY_HARD,
+    DIFFICULTY_COUNT
+} DifficultyTier;
+
+typedef struct {
+    const char* name;
+    int minOperand;
+    int maxOperand;
+    int maxFactor;            // Operand cap for * and /, so products stay readable
+    bool subtraction;
+    bool multiplication;
+    bool division;            // Always exact: the dividend is built as divisor * quotient
+    bool negativeAnswers;     // Otherwise subtraction keeps the larger operand first
+    int twoStepPercent;       // Chance of a second operation (+, - or *)
+    int distractorSpread;     // Wrong answers come from within +/- this of the right one
+} ProblemDifficulty;
+
+// A problem with its answers ready to hand out. The answers are distinct
+// by construction and already shuffled; the right one is at correctSlot.
+typedef struct {
+    MathProblem problem;
+    int answers[MAX_ANSWERS];
+    int correctSlot;
+} PreparedProblem;
+
+// Generates problems from its own random stream into a ring of upcoming
+// problems. The sequence only depends on the seed and tier, not on when
+// the pool gets refilled.
+typedef struct {
+    Rng rng;
+    DifficultyTier tier;
+    PreparedProblem pool[PROBLEM_POOL_SIZE];
+    int head;                 // Next problem to hand out
+    int count;
+    unsigned int generated;
+    unsigned int poolMisses;  // Problems needed while the pool was empty
+} ProblemEngine;
+
+void InitProblemEngine(ProblemEngine* engine, uint64_t seed, DifficultyTier tier);
+
+// Generate up to maxProblems more, stopping when the pool is full
+void RefillProblemPool(ProblemEngine* engine, int maxProblems);
+
+// The oldest pooled problem, or one generated now if the pool ran dry
+PreparedProblem TakeProblem(ProblemEngine* engine);
+
+const ProblemDifficulty* GetProblemDifficulty(DifficultyTier tier);
+bool ParseDifficulty(const char* name, DifficultyTier* tier);
+
+// "7 + 5 = ?", "(3 + 4) * 2 = ?" or "12 / 4 = ?"
+void FormatMathProblem(const MathProblem* problem, char* text, int size);
+
+#endif // MATH_PROBLEM_H
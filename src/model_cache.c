@@ -0,0 +1,483 @@
+#define _POSIX_C_SOURCE 200809L  // stat, mmap
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include "model_cache.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Bones and poses are stored as raylib's own structs, so their layout is
+// part of the file format
+typedef char CheckTransformSize[(sizeof(Transform) == 40) ? 1 : -1];
+typedef char CheckBoneInfoSize[(sizeof(BoneInfo) == 36) ? 1 : -1];
+
+#define BLOB_ALIGNMENT 16
+
+// All offsets are from the start of the file; 0 means "not present"
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceSize;      // Size and mtime of the GLB this was cooked from
+    int64_t sourceMtime;
+    uint64_t fileSize;
+    int32_t meshCount;
+    int32_t materialCount;
+    int32_t boneCount;
+    int32_t animationCount;
+    uint32_t meshes;          // CookedMesh[meshCount]
+    uint32_t meshMaterial;    // int32_t[meshCount]
+    uint32_t materials;       // CookedMaterial[materialCount]
+    uint32_t bones;           // BoneInfo[boneCount]
+    uint32_t bindPose;        // Transform[boneCount]
+    uint32_t animations;      // CookedAnimation[animationCount]
+} CookedHeader;
+
+typedef struct {
+    int32_t vertexCount;
+    int32_t triangleCount;
+    int32_t boneCount;
+    uint32_t vertices;        // float[3 * vertexCount]
+    uint32_t texcoords;       // float[2 * vertexCount]
+    uint32_t normals;         // float[3 * vertexCount]
+    uint32_t tangents;        // float[4 * vertexCount]
+    uint32_t colors;          // uint8_t[4 * vertexCount]
+    uint32_t indices;         // uint16_t[3 * triangleCount]
+    uint32_t boneIds;         // uint8_t[4 * vertexCount]
+    uint32_t boneWeights;     // float[4 * vertexCount]
+} CookedMesh;
+
+typedef struct {
+    uint8_t color[4];         // Diffuse color
+    int32_t width;            // Diffuse texture, RGBA8
+    int32_t height;
+    uint32_t pixels;
+} CookedMaterial;
+
+typedef struct {
+    char name[32];
+    int32_t boneCount;
+    int32_t frameCount;
+    uint32_t bones;           // BoneInfo[boneCount]
+    uint32_t framePoses;      // Transform[frameCount * boneCount], frame-major
+} CookedAnimation;
+
+// Byte sizes of the mesh arrays, shared by the writer and the validator
+#define VERTEX_BYTES(mesh, components, type) ((size_t)(mesh)->vertexCount * (components) * sizeof(type))
+#define INDEX_BYTES(mesh) ((size_t)(mesh)->triangleCount * 3 * sizeof(unsigned short))
+
+//------------------------------------------------------------------------------
+// Cooking
+//------------------------------------------------------------------------------
+
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+    bool failed;
+} CookBuffer;
+
+// Zero-filled, aligned space at the end of the buffer; returns its offset
+static uint32_t CookReserve(CookBuffer* buffer, size_t size) {
+    size_t offset = (buffer->size + BLOB_ALIGNMENT - 1) & ~(size_t)(BLOB_ALIGNMENT - 1);
+    size_t end = offset + size;
+    if (buffer->failed || end > UINT32_MAX) {
+        buffer->failed = true;
+        return 0;
+    }
+
+    if (end > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 64 * 1024;
+        while (capacity < end) capacity *= 2;
+        unsigned char* data = realloc(buffer->data, capacity);
+        if (data == NULL) {
+            buffer->failed = true;
+            return 0;
+        }
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+    memset(buffer->data + buffer->size, 0, end - buffer->size);
+    buffer->size = end;
+    return (uint32_t)offset;
+}
+
+static uint32_t CookWrite(CookBuffer* buffer, const void* data, size_t size) {
+    if (data == NULL || size == 0) return 0;
+    uint32_t offset = CookReserve(buffer, size);
+    if (!buffer->failed) memcpy(buffer->data + offset, data, size);
+    return offset;
+}
+
+// Copy a fixed-size record into a table reserved earlier (the buffer may
+// have moved since, so tables are addressed by offset)
+static void CookStore(CookBuffer* buffer, uint32_t table, int index, const void* record, size_t size) {
+    if (!buffer->failed) memcpy(buffer->data + table + (size_t)index * size, record, size);
+}
+
+void GetModelCachePath(const char* sourcePath, char* cachePath, int cachePathSize) {
+    snprintf(cachePath, cachePathSize, "%s%s", sourcePath, MODEL_CACHE_EXTENSION);
+}
+
+static uint32_t CookMaterialPixels(CookBuffer* buffer, Texture2D texture, CookedMaterial* cooked) {
+    if (texture.id == 0 || texture.id == rlGetTextureIdDefault()) return 0;
+
+    Image image = LoadImageFromTexture(texture);
+    if (image.data == NULL) return 0;
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    cooked->width = image.width;
+    cooked->height = image.height;
+    uint32_t pixels = CookWrite(buffer, image.data, (size_t)image.width * image.height * 4);
+    UnloadImage(image);
+    return pixels;
+}
+
+bool CookModel(const char* sourcePath, const char* cachePath) {
+    struct stat source;
+    if (stat(sourcePath, &source) != 0) return false;
+
+    Model model = LoadModel(sourcePath);
+    if (model.meshCount == 0) {
+        UnloadModel(model);
+        return false;
+    }
+    int animationCount = 0;
+    ModelAnimation* animations = LoadModelAnimations(sourcePath, &animationCount);
+
+    CookBuffer out = { 0 };
+    uint32_t header = CookReserve(&out, sizeof(CookedHeader));
+    uint32_t meshes = CookReserve(&out, sizeof(CookedMesh) * model.meshCount);
+    uint32_t meshMaterial = CookReserve(&out, sizeof(int32_t) * model.meshCount);
+    uint32_t materials = CookReserve(&out, sizeof(CookedMaterial) * model.materialCount);
+    uint32_t animationTable = CookReserve(&out, sizeof(CookedAnimation) * animationCount);
+
+    for (int m = 0; m < model.meshCount; m++) {
+        const Mesh* mesh = &model.meshes[m];
+        CookedMesh cooked = {
+            .vertexCount = mesh->vertexCount,
+            .triangleCount = mesh->triangleCount,
+            .boneCount = mesh->boneCount
+        };
+        cooked.vertices = CookWrite(&out, mesh->vertices, VERTEX_BYTES(mesh, 3, float));
+        cooked.texcoords = CookWrite(&out, mesh->texcoords, VERTEX_BYTES(mesh, 2, float));
+        cooked.normals = CookWrite(&out, mesh->normals, VERTEX_BYTES(mesh, 3, float));
+        cooked.tangents = CookWrite(&out, mesh->tangents, VERTEX_BYTES(mesh, 4, float));
+        cooked.colors = CookWrite(&out, mesh->colors, VERTEX_BYTES(mesh, 4, unsigned char));
+        cooked.indices = CookWrite(&out, mesh->indices, INDEX_BYTES(mesh));
+        cooked.boneIds = CookWrite(&out, mesh->boneIds, VERTEX_BYTES(mesh, 4, unsigned char));
+        cooked.boneWeights = CookWrite(&out, mesh->boneWeights, VERTEX_BYTES(mesh, 4, float));
+        CookStore(&out, meshes, m, &cooked, sizeof(cooked));
+
+        int32_t material = model.meshMaterial[m];
+        CookStore(&out, meshMaterial, m, &material, sizeof(material));
+    }
+
+    for (int i = 0; i < model.materialCount; i++) {
+        MaterialMap diffuse = model.materials[i].maps[MATERIAL_MAP_DIFFUSE];
+        CookedMaterial cooked = { .color = { diffuse.color.r, diffuse.color.g, diffuse.color.b, diffuse.color.a } };
+        cooked.pixels = CookMaterialPixels(&out, diffuse.texture, &cooked);
+        CookStore(&out, materials, i, &cooked, sizeof(cooked));
+    }
+
+    uint32_t bones = CookWrite(&out, model.bones, sizeof(BoneInfo) * model.boneCount);
+    uint32_t bindPose = CookWrite(&out, model.bindPose, sizeof(Transform) * model.boneCount);
+
+    for (int a = 0; a < animationCount; a++) {
+        const ModelAnimation* animation = &animations[a];
+        CookedAnimation cooked = {
+            .boneCount = animation->boneCount,
+            .frameCount = animation->frameCount
+        };
+        memcpy(cooked.name, animation->name, sizeof(cooked.name));
+        cooked.name[sizeof(cooked.name) - 1] = '\0';
+        cooked.bones = CookWrite(&out, animation->bones, sizeof(BoneInfo) * animation->boneCount);
+
+        // raylib keeps one allocation per frame; the cache keeps them back to back
+        size_t frameBytes = sizeof(Transform) * animation->boneCount;
+        if (frameBytes > 0 && animation->frameCount > 0) {
+            cooked.framePoses = CookReserve(&out, frameBytes * animation->frameCount);
+            for (int f = 0; f < animation->frameCount && !out.failed; f++) {
+                memcpy(out.data + cooked.framePoses + f * frameBytes, animation->framePoses[f], frameBytes);
+            }
+        }
+        CookStore(&out, animationTable, a, &cooked, sizeof(cooked));
+    }
+
+    CookedHeader cookedHeader = {
+        .magic = MODEL_CACHE_MAGIC,
+        .version = MODEL_CACHE_VERSION,
+        .sourceSize = (uint64_t)source.st_size,
+        .sourceMtime = (int64_t)source.st_mtime,
+        .fileSize = out.size,
+        .meshCount = model.meshCount,
+        .materialCount = model.materialCount,
+        .boneCount = model.boneCount,
+        .animationCount = animationCount,
+        .meshes = meshes,
+        .meshMaterial = meshMaterial,
+        .materials = materials,
+        .bones = bones,
+        .bindPose = bindPose,
+        .animations = animationTable
+    };
+    CookStore(&out, header, 0, &cookedHeader, sizeof(cookedHeader));
+
+    if (animations != NULL) UnloadModelAnimations(animations, animationCount);
+    UnloadModel(model);
+
+    bool written = false;
+    if (!out.failed) {
+        char tempPath[512];
+        snprintf(tempPath, sizeof(tempPath), "%s.tmp", cachePath);
+        FILE* file = fopen(tempPath, "wb");
+        if (file != NULL) {
+            written = fwrite(out.data, 1, out.size, file) == out.size;
+            written = (fclose(file) == 0) && written;
+            written = written && rename(tempPath, cachePath) == 0;
+            if (!written) remove(tempPath);
+        }
+    }
+    free(out.data);
+    return written;
+}
+
+//------------------------------------------------------------------------------
+// Loading
+//------------------------------------------------------------------------------
+
+static const void* CachePointer(const ModelCache* cache, uint32_t offset) {
+    return (offset != 0) ? (const unsigned char*)cache->base + offset : NULL;
+}
+
+// A present array has to lie entirely inside the file
+static bool InFile(const ModelCache* cache, uint32_t offset, size_t bytes) {
+    return offset == 0 || (offset <= cache->size && bytes <= cache->size - offset);
+}
+
+// Bounds check every table and array, so a truncated or corrupt cache is
+// rejected up front instead of faulting in the middle of a frame
+static bool ValidateModelCache(const ModelCache* cache) {
+    const CookedHeader* header = cache->base;
+    if (header->meshCount < 0 || header->materialCount < 0 || header->boneCount < 0 || header->animationCount < 0) return false;
+    if (!InFile(cache, header->meshes, sizeof(CookedMesh) * (size_t)header->meshCount) ||
+        !InFile(cache, header->meshMaterial, sizeof(int32_t) * (size_t)header->meshCount) ||
+        !InFile(cache, header->materials, sizeof(CookedMaterial) * (size_t)header->materialCount) ||
+        !InFile(cache, header->bones, sizeof(BoneInfo) * (size_t)header->boneCount) ||
+        !InFile(cache, header->bindPose, sizeof(Transform) * (size_t)header->boneCount) ||
+        !InFile(cache, header->animations, sizeof(CookedAnimation) * (size_t)header->animationCount)) return false;
+    if (header->meshCount > 0 && (header->meshes == 0 || header->meshMaterial == 0)) return false;
+    if (header->materialCount > 0 && header->materials == 0) return false;
+    if (header->animationCount > 0 && header->animations == 0) return false;
+
+    const CookedMesh* meshes = CachePointer(cache, header->meshes);
+    const int32_t* meshMaterial = CachePointer(cache, header->meshMaterial);
+    for (int m = 0; m < header->meshCount; m++) {
+        const CookedMesh* mesh = &meshes[m];
+        if (mesh->vertexCount < 0 || mesh->triangleCount < 0 || mesh->boneCount < 0) return false;
+        if (meshMaterial[m] < 0 || meshMaterial[m] >= header->materialCount) return false;
+        if (!InFile(cache, mesh->vertices, VERTEX_BYTES(mesh, 3, float)) ||
+            !InFile(cache, mesh->texcoords, VERTEX_BYTES(mesh, 2, float)) ||
+            !InFile(cache, mesh->normals, VERTEX_BYTES(mesh, 3, float)) ||
+            !InFile(cache, mesh->tangents, VERTEX_BYTES(mesh, 4, float)) ||
+            !InFile(cache, mesh->colors, VERTEX_BYTES(mesh, 4, unsigned char)) ||
+            !InFile(cache, mesh->indices, INDEX_BYTES(mesh)) ||
+            !InFile(cache, mesh->boneIds, VERTEX_BYTES(mesh, 4, unsigned char)) ||
+            !InFile(cache, mesh->boneWeights, VERTEX_BYTES(mesh, 4, float))) return false;
+    }
+
+    const CookedMaterial* materials = CachePointer(cache, header->materials);
+    for (int i = 0; i < header->materialCount; i++) {
+        const CookedMaterial* material = &materials[i];
+        if (material->pixels != 0 && (material->width <= 0 || material->height <= 0)) return false;
+        if (!InFile(cache, material->pixels, (size_t)material->width * material->height * 4)) return false;
+    }
+
+    const CookedAnimation* animations = CachePointer(cache, header->animations);
+    for (int a = 0; a < header->animationCount; a++) {
+        const CookedAnimation* animation = &animations[a];
+        if (animation->boneCount < 0 || animation->frameCount < 0) return false;
+        if (animation->frameCount > 0 && animation->boneCount > 0 && animation->framePoses == 0) return false;
+        if (!InFile(cache, animation->bones, sizeof(BoneInfo) * (size_t)animation->boneCount) ||
+            !InFile(cache, animation->framePoses, sizeof(Transform) * (size_t)animation->boneCount * animation->frameCount)) return false;
+    }
+    return true;
+}
+
+bool OpenModelCache(ModelCache* cache, const char* cachePath, const char* sourcePath) {
+    *cache = (ModelCache){ 0 };
+
+    struct stat source;
+    struct stat cooked;
+    if (stat(sourcePath, &source) != 0 || stat(cachePath, &cooked) != 0) return false;
+    if ((size_t)cooked.st_size < sizeof(CookedHeader)) return false;
+
+    int fd = open(cachePath, O_RDONLY);
+    if (fd < 0) return false;
+    void* base = mmap(NULL, (size_t)cooked.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+
+    cache->base = base;
+    cache->size = (size_t)cooked.st_size;
+
+    const CookedHeader* header = base;
+    bool current = header->magic == MODEL_CACHE_MAGIC &&
+                   header->version == MODEL_CACHE_VERSION &&
+                   header->fileSize == cache->size &&
+                   header->sourceSize == (uint64_t)source.st_size &&
+                   header->sourceMtime == (int64_t)source.st_mtime;
+    if (!current || !ValidateModelCache(cache)) {
+        CloseModelCache(cache);
+        return false;
+    }
+    return true;
+}
+
+void CloseModelCache(ModelCache* cache) {
+    if (cache->base != NULL) munmap(cache->base, cache->size);
+    *cache = (ModelCache){ 0 };
+}
+
+ModelAnimation* LoadCachedAnimations(const ModelCache* cache, int* animationCount) {
+    *animationCount = 0;
+    const CookedHeader* header = cache->base;
+    if (header == NULL || header->animationCount == 0) return NULL;
+
+    ModelAnimation* animations = calloc(header->animationCount, sizeof(ModelAnimation));
+    if (animations == NULL) return NULL;
+
+    const CookedAnimation* cooked = CachePointer(cache, header->animations);
+    for (int a = 0; a < header->animationCount; a++) {
+        ModelAnimation* animation = &animations[a];
+        animation->boneCount = cooked[a].boneCount;
+        animation->frameCount = cooked[a].frameCount;
+        animation->bones = (BoneInfo*)CachePointer(cache, cooked[a].bones);
+        memcpy(animation->name, cooked[a].name, sizeof(animation->name));
+
+        animation->framePoses = malloc(sizeof(Transform*) * (animation->frameCount > 0 ? animation->frameCount : 1));
+        if (animation->framePoses == NULL) {
+            UnloadCachedAnimations(animations, a);
+            return NULL;
+        }
+        Transform* poses = (Transform*)CachePointer(cache, cooked[a].framePoses);
+        for (int f = 0; f < animation->frameCount; f++) {
+            animation->framePoses[f] = poses + (size_t)f * animation->boneCount;
+        }
+    }
+
+    *animationCount = header->animationCount;
+    return animations;
+}
+
+void UnloadCachedAnimations(ModelAnimation* animations, int animationCount) {
+    if (animations == NULL) return;
+    for (int a = 0; a < animationCount; a++) free(animations[a].framePoses);
+    free(animations);
+}
+
+Model LoadCachedModel(const ModelCache* cache) {
+    Model model = { 0 };
+    const CookedHeader* header = cache->base;
+    if (header == NULL || header->meshCount == 0) return model;
+
+    model.transform = MatrixIdentity();
+    model.meshCount = header->meshCount;
+    model.materialCount = header->materialCount;
+    model.meshes = calloc(model.meshCount, sizeof(Mesh));
+    model.materials = calloc(model.materialCount > 0 ? model.materialCount : 1, sizeof(Material));
+    model.meshMaterial = calloc(model.meshCount, sizeof(int));
+    if (model.meshes == NULL || model.materials == NULL || model.meshMaterial == NULL) {
+        free(model.meshes);
+        free(model.materials);
+        free(model.meshMaterial);
+        return (Model){ 0 };
+    }
+
+    // Meshes read straight from the mapping. Skinning happens on the GPU, so
+    // the CPU skinning buffers (animVertices/animNormals) are left out.
+    const CookedMesh* meshes = CachePointer(cache, header->meshes);
+    const int32_t* meshMaterial = CachePointer(cache, header->meshMaterial);
+    for (int m = 0; m < model.meshCount; m++) {
+        const CookedMesh* cooked = &meshes[m];
+        Mesh* mesh = &model.meshes[m];
+        mesh->vertexCount = cooked->vertexCount;
+        mesh->triangleCount = cooked->triangleCount;
+        mesh->vertices = (float*)CachePointer(cache, cooked->vertices);
+        mesh->texcoords = (float*)CachePointer(cache, cooked->texcoords);
+        mesh->normals = (float*)CachePointer(cache, cooked->normals);
+        mesh->tangents = (float*)CachePointer(cache, cooked->tangents);
+        mesh->colors = (unsigned char*)CachePointer(cache, cooked->colors);
+        mesh->indices = (unsigned short*)CachePointer(cache, cooked->indices);
+        mesh->boneIds = (unsigned char*)CachePointer(cache, cooked->boneIds);
+        mesh->boneWeights = (float*)CachePointer(cache, cooked->boneWeights);
+
+        // The only per-mesh data that changes at runtime
+        if (cooked->boneCount > 0) {
+            mesh->boneMatrices = malloc(sizeof(Matrix) * cooked->boneCount);
+            if (mesh->boneMatrices != NULL) {
+                mesh->boneCount = cooked->boneCount;
+                for (int b = 0; b < mesh->boneCount; b++) mesh->boneMatrices[b] = MatrixIdentity();
+            }
+        }
+
+        UploadMesh(mesh, false);
+        model.meshMaterial[m] = meshMaterial[m];
+    }
+
+    const CookedMaterial* materials = CachePointer(cache, header->materials);
+    for (int i = 0; i < model.materialCount; i++) {
+        const CookedMaterial* cooked = &materials[i];
+        model.materials[i] = LoadMaterialDefault();
+        MaterialMap* diffuse = &model.materials[i].maps[MATERIAL_MAP_DIFFUSE];
+        diffuse->color = (Color){ cooked->color[0], cooked->color[1], cooked->color[2], cooked->color[3] };
+
+        if (cooked->pixels != 0) {
+            Image image = {
+                .data = (void*)CachePointer(cache, cooked->pixels),
+                .width = cooked->width,
+                .height = cooked->height,
+                .mipmaps = 1,
+                .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8
+            };
+            diffuse->texture = LoadTextureFromImage(image);
+        }
+    }
+
+    model.boneCount = header->boneCount;
+    model.bones = (BoneInfo*)CachePointer(cache, header->bones);
+    model.bindPose = (Transform*)CachePointer(cache, header->bindPose);
+    return model;
+}
+
+void UnloadCachedModel(Model model) {
+    if (model.meshes == NULL) return;
+
+    // Forget the arrays that live in the mapping so UnloadModel only frees
+    // what was allocated here: GPU buffers, bone matrices and the tables
+    for (int m = 0; m < model.meshCount; m++) {
+        Mesh* mesh = &model.meshes[m];
+        mesh->vertices = NULL;
+        mesh->texcoords = NULL;
+        mesh->normals = NULL;
+        mesh->tangents = NULL;
+        mesh->colors = NULL;
+        mesh->indices = NULL;
+        mesh->boneIds = NULL;
+        mesh->boneWeights = NULL;
+    }
+    model.bones = NULL;
+    model.bindPose = NULL;
+
+    // UnloadModel leaves material textures alone
+    for (int i = 0; i < model.materialCount; i++) {
+        Texture2D texture = model.materials[i].maps[MATERIAL_MAP_DIFFUSE].texture;
+        if (texture.id != 0 && texture.id != rlGetTextureIdDefault()) UnloadTexture(texture);
+    }
+    UnloadModel(model);
+}
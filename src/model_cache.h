@@ -0,0 +1,44 @@
+#ifndef MODEL_CACHE_H
+#define MODEL_CACHE_H
+
+#include "raylib.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Cooked model files: everything LoadModel/LoadModelAnimations produce for a
+// GLB (meshes, materials with their diffuse pixels, bones, bind pose and
+// animation frame poses) laid out flat so it can be mapped and used in place.
+// Cook with `make cook`; a cache whose source GLB changed is ignored.
+#define MODEL_CACHE_MAGIC 0x434D4743u    // "CGMC"
+#define MODEL_CACHE_VERSION 1
+#define MODEL_CACHE_EXTENSION ".cache"   // Written next to the GLB
+
+typedef struct {
+    void* base;           // Read-only mapping of the whole file
+    size_t size;
+} ModelCache;
+
+// Path of the cooked file for a GLB, e.g. greenman.glb -> greenman.glb.cache
+void GetModelCachePath(const char* sourcePath, char* cachePath, int cachePathSize);
+
+// Needs a GL context: meshes and textures are read back from a loaded model.
+// Writes to a temporary file first so a half-written cache is never seen.
+bool CookModel(const char* sourcePath, const char* cachePath);
+
+// Map the cache and check it against the source GLB's size and mtime.
+// Plain file I/O only, so it is safe off the main thread.
+bool OpenModelCache(ModelCache* cache, const char* cachePath, const char* sourcePath);
+void CloseModelCache(ModelCache* cache);
+
+// Animations pointing straight into the mapping; only the small headers and
+// per-frame pointer arrays are allocated. Also safe off the main thread.
+ModelAnimation* LoadCachedAnimations(const ModelCache* cache, int* animationCount);
+void UnloadCachedAnimations(ModelAnimation* animations, int animationCount);
+
+// Main thread: upload the mapped meshes and pixels to the GPU. The model's
+// CPU arrays stay in the mapping, so it must be freed with UnloadCachedModel
+// before the cache is closed.
+Model LoadCachedModel(const ModelCache* cache);
+void UnloadCachedModel(Model model);
+
+#endif // MODEL_CACHE_H
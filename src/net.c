@@ -0,0 +1,225 @@
+#define _POSIX_C_SOURCE 200112L  // getaddrinfo
+#include "net.h"
+#include "logger.h"
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static struct sockaddr_in ToSockaddr(NetAddress address) {
+    struct sockaddr_in result;
+    memset(&result, 0, sizeof(result));
+    result.sin_family = AF_INET;
+    result.sin_addr.s_addr = htonl(address.host);
+    result.sin_port = htons(address.port);
+    return result;
+}
+
+bool OpenNetSocket(NetSocket* netSocket, uint16_t port, const NetShimConfig* shim, uint64_t seed) {
+    *netSocket = (NetSocket){ .fd = -1 };
+    if (shim != NULL) netSocket->shim = *shim;
+    SeedRng(&netSocket->rng, seed, port);
+
+    if (netSocket->shim.latencyMs > 0.0f || netSocket->shim.jitterMs > 0.0f) {
+        netSocket->held = malloc(sizeof(NetHeldPacket) * NET_SHIM_QUEUE);
+        if (netSocket->held == NULL) return false;
+    }
+
+    netSocket->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (netSocket->fd < 0) {
+        CloseNetSocket(netSocket);
+        return false;
+    }
+    struct sockaddr_in local = ToSockaddr((NetAddress){ INADDR_ANY, port });
+    socklen_t length = sizeof(local);
+    if (bind(netSocket->fd, (struct sockaddr*)&local, sizeof(local)) != 0 ||
+        fcntl(netSocket->fd, F_SETFL, fcntl(netSocket->fd, F_GETFL, 0) | O_NONBLOCK) != 0 ||
+        getsockname(netSocket->fd, (struct sockaddr*)&local, &length) != 0) {
+        LOGE(LOG_CAT_NET, "Could not open a UDP socket on port %u", port);
+        CloseNetSocket(netSocket);
+        return false;
+    }
+    netSocket->port = ntohs(local.sin_port);
+    return true;
+}
+
+void CloseNetSocket(NetSocket* netSocket) {
+    if (netSocket->fd >= 0) close(netSocket->fd);
+    free(netSocket->held);
+    netSocket->fd = -1;
+    netSocket->held = NULL;
+    netSocket->heldCount = 0;
+}
+
+static void SendNow(NetSocket* netSocket, NetAddress to, const void* data, int size) {
+    struct sockaddr_in address = ToSockaddr(to);
+    sendto(netSocket->fd, data, (size_t)size, 0, (struct sockaddr*)&address, sizeof(address));
+}
+
+void NetSend(NetSocket* netSocket, NetAddress to, const void* data, int size, double now) {
+    if (size <= 0 || size > NET_MAX_PACKET) return;
+    netSocket->bytesSent += (unsigned long long)size;
+    netSocket->packetsSent++;
+
+    const NetShimConfig* shim = &netSocket->shim;
+    if (shim->lossPercent > 0.0f && RngFloat(&netSocket->rng) * 100.0f < shim->lossPercent) {
+        netSocket->packetsDropped++;
+        return;
+    }
+    if (netSocket->held == NULL) {
+        SendNow(netSocket, to, data, size);
+        return;
+    }
+
+    // A full queue loses the packet, like a full router buffer would
+    if (netSocket->heldCount == NET_SHIM_QUEUE) {
+        netSocket->packetsDropped++;
+        return;
+    }
+    NetHeldPacket* packet = &netSocket->held[netSocket->heldCount++];
+    packet->sendTime = now + (shim->latencyMs + RngFloat(&netSocket->rng) * shim->jitterMs) / 1000.0;
+    packet->to = to;
+    packet->size = size;
+    memcpy(packet->data, data, (size_t)size);
+}
+
+// Packets still held slide down over the sent ones, so they keep the order
+// they were sent in and only jitter can reorder them
+void FlushNetSocket(NetSocket* netSocket, double now) {
+    int kept = 0;
+    for (int i = 0; i < netSocket->heldCount; i++) {
+        NetHeldPacket* packet = &netSocket->held[i];
+        if (packet->sendTime > now) {
+            if (kept != i) netSocket->held[kept] = *packet;
+            kept++;
+            continue;
+        }
+        SendNow(netSocket, packet->to, packet->data, packet->size);
+    }
+    netSocket->heldCount = kept;
+}
+
+int NetReceive(NetSocket* netSocket, NetAddress* from, void* data, int capacity) {
+    struct sockaddr_in address;
+    socklen_t length = sizeof(address);
+    ssize_t size = recvfrom(netSocket->fd, data, (size_t)capacity, 0, (struct sockaddr*)&address, &length);
+    if (size <= 0) return 0;
+    from->host = ntohl(address.sin_addr.s_addr);
+    from->port = ntohs(address.sin_port);
+    netSocket->bytesReceived += (unsigned long long)size;
+    return (int)size;
+}
+
+bool ParseNetAddress(const char* text, NetAddress* address) {
+    const char* colon = strrchr(text, ':');
+    if (colon == NULL || colon == text) return false;
+    char host[256];
+    size_t hostLength = (size_t)(colon - text);
+    if (hostLength >= sizeof(host)) return false;
+    memcpy(host, text, hostLength);
+    host[hostLength] = '\0';
+
+    long port = strtol(colon + 1, NULL, 10);
+    if (port <= 0 || port > 65535) return false;
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    struct addrinfo* results = NULL;
+    if (getaddrinfo(host, NULL, &hints, &results) != 0 || results == NULL) return false;
+    address->host = ntohl(((struct sockaddr_in*)results->ai_addr)->sin_addr.s_addr);
+    address->port = (uint16_t)port;
+    freeaddrinfo(results);
+    return true;
+}
+
+bool NetAddressEqual(NetAddress a, NetAddress b) {
+    return a.host == b.host && a.port == b.port;
+}
+
+NetAddress NetLoopback(uint16_t port) {
+    return (NetAddress){ INADDR_LOOPBACK, port };
+}
+
+void WriteU8(NetWriter* writer, uint8_t value) {
+    if (writer->size + 1 > writer->capacity) {
+        writer->overflow = true;
+        return;
+    }
+    writer->data[writer->size++] = value;
+}
+
+void WriteU16(NetWriter* writer, uint16_t value) {
+    WriteU8(writer, (uint8_t)value);
+    WriteU8(writer, (uint8_t)(value >> 8));
+}
+
+void WriteU32(NetWriter* writer, uint32_t value) {
+    WriteU16(writer, (uint16_t)value);
+    WriteU16(writer, (uint16_t)(value >> 16));
+}
+
+void WriteF32(NetWriter* writer, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    WriteU32(writer, bits);
+}
+
+void WriteVarint(NetWriter* writer, uint32_t value) {
+    while (value >= 0x80) {
+        WriteU8(writer, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    WriteU8(writer, (uint8_t)value);
+}
+
+void WriteSigned(NetWriter* writer, int32_t value) {
+    WriteVarint(writer, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+uint8_t ReadU8(NetReader* reader) {
+    if (reader->offset >= reader->size) {
+        reader->overflow = true;
+        return 0;
+    }
+    return reader->data[reader->offset++];
+}
+
+uint16_t ReadU16(NetReader* reader) {
+    uint16_t low = ReadU8(reader);
+    return (uint16_t)(low | (ReadU8(reader) << 8));
+}
+
+uint32_t ReadU32(NetReader* reader) {
+    uint32_t low = ReadU16(reader);
+    return low | ((uint32_t)ReadU16(reader) << 16);
+}
+
+float ReadF32(NetReader* reader) {
+    uint32_t bits = ReadU32(reader);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint32_t ReadVarint(NetReader* reader) {
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t byte = ReadU8(reader);
+        value |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    reader->overflow = true;
+    return 0;
+}
+
+int32_t ReadSigned(NetReader* reader) {
+    uint32_t value = ReadVarint(reader);
+    return (int32_t)((value >> 1) ^ (0u - (value & 1)));
+}
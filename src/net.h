@@ -0,0 +1,93 @@
+#ifndef NET_H
+#define NET_H
+
+#include "rng.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define NET_MAX_PACKET 1200       // Kept under a typical path MTU
+#define NET_SHIM_QUEUE 512        // Packets a socket can hold back for simulated latency
+
+// IPv4, host byte order
+typedef struct {
+    uint32_t host;
+    uint16_t port;
+} NetAddress;
+
+// Simulated bad network, applied to what a socket sends. Packets are
+// dropped at random, and held back for the latency plus up to the jitter
+// (so they may arrive out of order).
+typedef struct {
+    float lossPercent;
+    float latencyMs;          // One way
+    float jitterMs;
+} NetShimConfig;
+
+typedef struct {
+    double sendTime;
+    NetAddress to;
+    int size;
+    uint8_t data[NET_MAX_PACKET];
+} NetHeldPacket;
+
+// A non-blocking UDP socket
+typedef struct {
+    int fd;
+    uint16_t port;            // Bound port, also when the system picked it
+    NetShimConfig shim;
+    Rng rng;                  // Loss and jitter only; nothing gameplay
+    NetHeldPacket* held;      // Waiting out the simulated latency
+    int heldCount;
+    unsigned long long bytesSent;     // Handed to the shim, dropped or not
+    unsigned long long bytesReceived;
+    unsigned int packetsSent;
+    unsigned int packetsDropped;      // By the shim
+} NetSocket;
+
+// port 0 lets the system pick one. shim may be NULL for a clean link.
+bool OpenNetSocket(NetSocket* socket, uint16_t port, const NetShimConfig* shim, uint64_t seed);
+void CloseNetSocket(NetSocket* socket);
+
+// Through the shim; now is the caller's clock, in seconds
+void NetSend(NetSocket* socket, NetAddress to, const void* data, int size, double now);
+// Send held packets whose latency has passed
+void FlushNetSocket(NetSocket* socket, double now);
+// Size of the next waiting datagram, or 0 when there is none
+int NetReceive(NetSocket* socket, NetAddress* from, void* data, int capacity);
+
+// "host:port", host as a name or dotted quad
+bool ParseNetAddress(const char* text, NetAddress* address);
+bool NetAddressEqual(NetAddress a, NetAddress b);
+NetAddress NetLoopback(uint16_t port);
+
+// Little-endian byte writer for packets. Running out of room sets overflow
+// instead of writing past the end.
+typedef struct {
+    uint8_t* data;
+    int capacity;
+    int size;
+    bool overflow;
+} NetWriter;
+
+typedef struct {
+    const uint8_t* data;
+    int size;
+    int offset;
+    bool overflow;            // Read past the end; what was read is garbage
+} NetReader;
+
+void WriteU8(NetWriter* writer, uint8_t value);
+void WriteU16(NetWriter* writer, uint16_t value);
+void WriteU32(NetWriter* writer, uint32_t value);
+void WriteF32(NetWriter* writer, float value);
+void WriteVarint(NetWriter* writer, uint32_t value);      // 7 bits per byte
+void WriteSigned(NetWriter* writer, int32_t value);       // Zigzag varint, small magnitudes stay small
+
+uint8_t ReadU8(NetReader* reader);
+uint16_t ReadU16(NetReader* reader);
+uint32_t ReadU32(NetReader* reader);
+float ReadF32(NetReader* reader);
+uint32_t ReadVarint(NetReader* reader);
+int32_t ReadSigned(NetReader* reader);
+
+#endif // NET_H
@@ -0,0 +1,300 @@
+#include "raylib.h"
+#include "raymath.h"
+#include "net_client.h"
+#include "logger.h"
+#include "timer.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define CORRECTION_EPSILON 0.001f // Reconciliation moves smaller than this don't count
+#define RTT_SMOOTHING 0.1         // Weight of each new round trip sample
+
+bool InitNetClient(NetClient* client, NetAddress server, const NetShimConfig* shim, uint64_t seed) {
+    *client = (NetClient){ .server = server, .lastHello = -INFINITY };
+    client->socket.fd = -1;
+    return OpenNetSocket(&client->socket, 0, shim, seed);
+}
+
+static void FreeClientViews(NetClient* client) {
+    if (client->views != NULL) {
+        for (int v = 0; v < NET_VIEW_HISTORY; v++) FreeNetView(&client->views[v]);
+        free(client->views);
+    }
+    client->views = NULL;
+    client->view = NULL;
+    FreeNetView(&client->empty);
+    FreeNetView(&client->collided);
+    FreeCollisionWorld(&client->collision);
+}
+
+void FreeNetClient(NetClient* client) {
+    FreeClientViews(client);
+    CloseNetSocket(&client->socket);
+}
+
+static void Send(NetClient* client, const NetWriter* writer, double now) {
+    NetSend(&client->socket, client->server, writer->data, writer->size, now);
+}
+
+static void HandleWelcome(NetClient* client, NetReader* reader, double now) {
+    NetWelcome welcome;
+    if (client->connected || !ReadWelcome(reader, &welcome)) return;
+
+    client->views = calloc(NET_VIEW_HISTORY, sizeof(NetView));
+    bool allocated = client->views != NULL && InitNetView(&client->empty, welcome.treeCount) &&
+                     InitNetView(&client->collided, welcome.treeCount) &&
+                     InitCollisionWorld(&client->collision, welcome.treeCount + NET_MAX_ROCKS);
+    for (int v = 0; v < NET_VIEW_HISTORY && allocated; v++) {
+        allocated = InitNetView(&client->views[v], welcome.treeCount);
+    }
+    if (!allocated) {
+        LOGE(LOG_CAT_NET, "Out of memory for a world of %d trees", welcome.treeCount);
+        FreeClientViews(client);
+        return;
+    }
+
+    client->connected = true;
+    client->slot = welcome.slot;
+    client->tickRate = welcome.tickRate;
+    client->treeCount = welcome.treeCount;
+    client->lastHeard = now;
+    client->player = welcome.player;
+    LOGI(LOG_CAT_NET, "Connected as client %d at server tick %u (%d Hz, %d tree slots)",
+         welcome.slot, welcome.serverTick, welcome.tickRate, welcome.treeCount);
+}
+
+// Bring the obstacles in line with a new view, touching only what changed
+static void SyncObstacles(NetClient* client, const NetView* view) {
+    NetView* collided = &client->collided;
+    for (int i = 0; i < client->treeCount; i++) {
+        const NetTreeState* tree = &view->trees[i];
+        const NetTreeState* was = &collided->trees[i];
+        if (tree->present == was->present && tree->x == was->x && tree->z == was->z) continue;
+        if (tree->present) SetObstacle(&client->collision, i, DequantizePosition(tree->x, tree->z), TRUNK_HALF_SIZE);
+        else RemoveObstacle(&client->collision, i);
+    }
+    for (int r = 0; r < NET_MAX_ROCKS; r++) {
+        const NetRockState* rock = &view->rocks[r];
+        const NetRockState* was = &collided->rocks[r];
+        if (rock->present == was->present && rock->x == was->x && rock->z == was->z) continue;
+        int index = client->treeCount + r;
+        if (rock->present) SetObstacle(&client->collision, index, DequantizePosition(rock->x, rock->z), ROCK_HALF_SIZE);
+        else RemoveObstacle(&client->collision, index);
+    }
+    CopyNetView(collided, view, client->treeCount);
+}
+
+// The server chops the lowest-numbered tree in range, like
+// FindChopTargetLinear. Its trunk is out of the way from then on; marking it
+// gone in collided puts it back with the next snapshot, which either still
+// has it (the chop is replayed) or has it regrown elsewhere.
+static void PredictChop(NetClient* client) {
+    Vector3 forward = PlayerForward(&client->player);
+    for (int i = 0; i < client->treeCount; i++) {
+        NetTreeState* tree = &client->collided.trees[i];
+        if (!tree->present || !IsTreeInChopRange(client->player.position, forward, DequantizePosition(tree->x, tree->z))) continue;
+        tree->present = 0;
+        RemoveObstacle(&client->collision, i);
+        return;
+    }
+}
+
+// Start over from the server's player at the last input it applied and
+// replay everything issued since
+static void Reconcile(NetClient* client, const NetSnapshotHeader* header, double now) {
+    if (header->ackInput <= client->ackInput || header->ackInput > client->inputSequence) return;
+    client->ackInput = header->ackInput;
+
+    double rtt = now - client->inputTimes[header->ackInput & (NET_INPUT_HISTORY - 1)];
+    client->rttSeconds = (client->rttSeconds > 0.0) ? client->rttSeconds + (rtt - client->rttSeconds) * RTT_SMOOTHING : rtt;
+
+    Player predicted = client->player;
+    client->player.position = header->position;
+    client->player.rotationY = header->rotationY;
+    client->player.isMoving = header->isMoving;
+
+    // Inputs older than the history are gone; the server is far behind
+    // and the next snapshot will pull the player back anyway
+    uint32_t first = header->ackInput + 1;
+    if (client->inputSequence - header->ackInput >= NET_INPUT_HISTORY) first = client->inputSequence - NET_INPUT_HISTORY + 1;
+    float deltaTime = 1.0f / client->tickRate;
+    for (uint32_t sequence = first; sequence <= client->inputSequence; sequence++) {
+        InputState input = UnpackInput(client->inputs[sequence & (NET_INPUT_HISTORY - 1)]);
+        MovePlayerIn(&client->collision, &client->player, &client->camera, &input, deltaTime);
+        if (input.chop) PredictChop(client);
+    }
+
+    float error = Vector3Distance(predicted.position, client->player.position);
+    if (error > CORRECTION_EPSILON) {
+        client->corrections++;
+        if (error > client->maxCorrection) client->maxCorrection = error;
+    }
+}
+
+static void HandleSnapshot(NetClient* client, NetReader* reader, double now) {
+    if (!client->connected) return;
+    NetReader peek = *reader;
+    NetSnapshotHeader header;
+    if (!DecodeSnapshotHeader(&peek, &header)) return;
+
+    // Older than what we have, or a delta against a view we no longer keep
+    const NetView* base = &client->empty;
+    if (header.baseSequence != 0) {
+        base = &client->views[header.baseSequence % NET_VIEW_HISTORY];
+        if (header.sequence - header.baseSequence >= NET_VIEW_HISTORY) base = NULL;
+    }
+    if (header.sequence <= client->latestSnapshot || base == NULL || base->sequence != header.baseSequence) {
+        client->staleSnapshots++;
+        return;
+    }
+
+    NetView* view = &client->views[header.sequence % NET_VIEW_HISTORY];
+    if (!DecodeSnapshot(reader, base, view, client->treeCount)) {
+        view->sequence = 0;
+        LOGW(LOG_CAT_NET, "Malformed snapshot %u", header.sequence);
+        return;
+    }
+    // No input goes out before the first snapshot, so the server's player
+    // is the starting point as it is; it may have been pushed off an
+    // obstacle since the welcome
+    if (client->view == NULL) {
+        client->player.position = header.position;
+        client->player.rotationY = header.rotationY;
+        client->player.isMoving = header.isMoving;
+    }
+    client->latestSnapshot = header.sequence;
+    client->view = view;
+    client->snapshots++;
+    SyncObstacles(client, view);
+    Reconcile(client, &header, now);
+}
+
+static void ReceivePackets(NetClient* client, double now) {
+    NetAddress from;
+    int size;
+    while ((size = NetReceive(&client->socket, &from, client->packet, NET_MAX_PACKET)) > 0) {
+        if (!NetAddressEqual(from, client->server)) continue;
+        client->lastHeard = now;
+        NetReader reader = { client->packet, size, 0, false };
+        switch (client->packet[0]) {
+            case NET_MSG_WELCOME: HandleWelcome(client, &reader, now); break;
+            case NET_MSG_SNAPSHOT: HandleSnapshot(client, &reader, now); break;
+            case NET_MSG_FULL:
+                if (!client->refused) LOGW(LOG_CAT_NET, "Server is full");
+                client->refused = true;
+                break;
+            case NET_MSG_BYE:
+                if (client->connected) LOGI(LOG_CAT_NET, "Server closed the connection");
+                client->connected = false;
+                break;
+        }
+    }
+}
+
+static void SendInputs(NetClient* client, double now) {
+    uint32_t unacked = client->inputSequence - client->ackInput;
+    int count = (unacked < NET_INPUT_REDUNDANCY) ? (int)unacked : NET_INPUT_REDUNDANCY;
+    NetWriter writer = { client->packet, NET_MAX_PACKET, 0, false };
+    WriteU8(&writer, NET_MSG_INPUT);
+    WriteU32(&writer, client->latestSnapshot);
+    WriteU32(&writer, client->inputSequence);
+    WriteU8(&writer, (uint8_t)count);
+    for (uint32_t sequence = client->inputSequence - (uint32_t)count + 1; sequence <= client->inputSequence; sequence++) {
+        WriteU16(&writer, client->inputs[sequence & (NET_INPUT_HISTORY - 1)]);
+    }
+    Send(client, &writer, now);
+}
+
+void ClientTick(NetClient* client, const InputState* input, double now) {
+    bool wasConnected = client->connected;
+    ReceivePackets(client, now);
+    if (wasConnected && client->connected && now - client->lastHeard > NET_TIMEOUT_SECONDS) {
+        LOGW(LOG_CAT_NET, "Lost the server");
+        client->connected = false;
+    }
+
+    if (!client->connected) {
+        // Retry until welcomed, unless the server has just gone away
+        if (!wasConnected && !client->refused && client->views == NULL && now - client->lastHello >= NET_HELLO_INTERVAL) {
+            NetWriter writer = { client->packet, NET_MAX_PACKET, 0, false };
+            WriteU8(&writer, NET_MSG_HELLO);
+            WriteU32(&writer, NET_MAGIC);
+            WriteU8(&writer, NET_PROTOCOL_VERSION);
+            Send(client, &writer, now);
+            client->lastHello = now;
+        }
+        FlushNetSocket(&client->socket, now);
+        return;
+    }
+
+    // Until the first snapshot there's nothing to collide with, and a
+    // prediction would walk through whatever the player starts next to
+    if (client->view == NULL) {
+        FlushNetSocket(&client->socket, now);
+        return;
+    }
+
+    uint32_t sequence = ++client->inputSequence;
+    uint16_t bits = PackInput(input);
+    client->inputs[sequence & (NET_INPUT_HISTORY - 1)] = bits;
+    client->inputTimes[sequence & (NET_INPUT_HISTORY - 1)] = now;
+
+    // Predict with what the server will apply, not the raw input
+    InputState sent = UnpackInput(bits);
+    MovePlayerIn(&client->collision, &client->player, &client->camera, &sent, 1.0f / client->tickRate);
+    if (sent.chop) PredictChop(client);
+
+    SendInputs(client, now);
+    FlushNetSocket(&client->socket, now);
+}
+
+void DisconnectNetClient(NetClient* client, double now) {
+    if (!client->connected) return;
+    uint8_t bye = NET_MSG_BYE;
+    NetSend(&client->socket, client->server, &bye, 1, now);
+    FlushNetSocket(&client->socket, INFINITY);
+    client->connected = false;
+}
+
+int RunNetClient(NetAddress server, const NetShimConfig* shim, unsigned int ticks, unsigned int seed) {
+    NetClient* client = malloc(sizeof(NetClient));
+    if (client == NULL || !InitNetClient(client, server, shim, seed)) {
+        free(client);
+        return 1;
+    }
+
+    // Until the welcome brings the server's rate, tick at the default one
+    double start = GetMonotonicSeconds();
+    double due = start;
+    unsigned int played = 0;
+    while (played < ticks) {
+        double now = GetMonotonicSeconds();
+        if (due > now) SleepSeconds(due - now);
+        InputState input = ScriptedInput(played);
+        bool wasConnected = client->connected;
+        ClientTick(client, &input, GetMonotonicSeconds());
+        if (wasConnected) played++;
+        if (wasConnected && !client->connected) break;
+        if (client->refused || (!client->connected && GetMonotonicSeconds() - start > NET_TIMEOUT_SECONDS)) break;
+        due += 1.0 / ((client->tickRate > 0) ? client->tickRate : DEFAULT_TICK_RATE);
+    }
+    DisconnectNetClient(client, GetMonotonicSeconds());
+
+    int result = (played > 0) ? 0 : 1;
+    if (played == 0) {
+        LOGE(LOG_CAT_NET, "Could not connect");
+    } else {
+        int score = (client->view != NULL) ? client->view->players[client->slot].score : 0;
+        int visibleTrees = 0;
+        for (int i = 0; client->view != NULL && i < client->treeCount; i++) visibleTrees += client->view->trees[i].present;
+        LOGI(LOG_CAT_NET, "Client: %u ticks, %u snapshots (%u stale), rtt %.1f ms, score %d, %d trees in view",
+             played, client->snapshots, client->staleSnapshots, client->rttSeconds * 1000.0, score, visibleTrees);
+        LOGI(LOG_CAT_NET, "Prediction: %u corrections, largest %.3f units; final position (%.2f, %.2f)",
+             client->corrections, client->maxCorrection, client->player.position.x, client->player.position.z);
+        LOGI(LOG_CAT_NET, "Client socket: %llu bytes sent, %llu received, %u of %u packets dropped by the shim",
+             client->socket.bytesSent, client->socket.bytesReceived, client->socket.packetsDropped, client->socket.packetsSent);
+    }
+    FreeNetClient(client);
+    free(client);
+    return result;
+}
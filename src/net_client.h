@@ -0,0 +1,59 @@
+#ifndef NET_CLIENT_H
+#define NET_CLIENT_H
+
+#include "game.h"
+#include "net_protocol.h"
+
+// A client of the authoritative server. It moves its own player as soon as
+// input is issued and corrects it when a snapshot shows where the server
+// put it: the server's state at the last input it applied, plus every
+// input since then replayed on top. Prediction and replay collide with the
+// trunks and rocks of the latest snapshot, the same way the server moves
+// players.
+typedef struct {
+    NetSocket socket;
+    NetAddress server;
+    bool connected;
+    bool refused;         // The server was full
+    uint8_t slot;
+    int tickRate;
+    int treeCount;
+    double lastHello;
+    double lastHeard;
+
+    Player player;        // Predicted
+    GameCamera camera;    // UpdatePlayer takes one; movement doesn't depend on it
+    uint32_t inputSequence;   // Last input issued, from 1
+    uint16_t inputs[NET_INPUT_HISTORY];
+    double inputTimes[NET_INPUT_HISTORY];
+    uint32_t ackInput;    // Last input the server applied
+
+    NetView* views;       // NET_VIEW_HISTORY decoded snapshots, by sequence
+    NetView empty;
+    uint32_t latestSnapshot;
+    const NetView* view;  // Latest decoded snapshot, NULL before the first
+    CollisionWorld collision; // Obstacles indexed like the server's: trunks, then rocks
+    NetView collided;     // The trees and rocks the collision world holds
+
+    unsigned int snapshots;
+    unsigned int staleSnapshots;   // Arrived after a newer one, or their base was gone
+    unsigned int corrections;      // Reconciliations that moved the player
+    float maxCorrection;
+    double rttSeconds;    // Input to its ack, smoothed
+    uint8_t packet[NET_MAX_PACKET];
+} NetClient;
+
+bool InitNetClient(NetClient* client, NetAddress server, const NetShimConfig* shim, uint64_t seed);
+void FreeNetClient(NetClient* client);
+
+// Take in what arrived and, once connected, issue one tick of input: predict
+// it, then send it along with the inputs the server may not have yet
+void ClientTick(NetClient* client, const InputState* input, double now);
+// Tell the server we're leaving
+void DisconnectNetClient(NetClient* client, double now);
+
+// Connect and play scripted input in real time for the given number of
+// ticks, then report what the connection was like. Returns the exit code.
+int RunNetClient(NetAddress server, const NetShimConfig* shim, unsigned int ticks, unsigned int seed);
+
+#endif // NET_CLIENT_H
@@ -0,0 +1,367 @@
+#include "raylib.h"
+#include "net_protocol.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_PLAYER_ENTRY 18       // Bytes a player change can take at most
+#define MAX_TREE_ENTRY 21         // Likewise for a tree
+#define MAX_ROCK_ENTRY 12         // And a rock
+
+#define TREE_PRESENT 1
+#define TREE_MOVED 2
+#define TREE_RELABELED 4
+
+bool InitNetView(NetView* view, int treeCount) {
+    *view = (NetView){ 0 };
+    view->trees = malloc(sizeof(NetTreeState) * ((treeCount > 0) ? treeCount : 1));
+    if (view->trees == NULL) return false;
+    ClearNetView(view, treeCount);
+    return true;
+}
+
+void FreeNetView(NetView* view) {
+    free(view->trees);
+    *view = (NetView){ 0 };
+}
+
+void ClearNetView(NetView* view, int treeCount) {
+    view->sequence = 0;
+    view->problem = (MathProblem){ 0 };
+    memset(view->players, 0, sizeof(view->players));
+    for (int i = 0; i < treeCount; i++) view->trees[i] = (NetTreeState){ .answer = NO_ANSWER };
+    memset(view->rocks, 0, sizeof(view->rocks));
+}
+
+void CopyNetView(NetView* destination, const NetView* source, int treeCount) {
+    destination->sequence = source->sequence;
+    destination->problem = source->problem;
+    memcpy(destination->players, source->players, sizeof(destination->players));
+    memcpy(destination->trees, source->trees, sizeof(NetTreeState) * treeCount);
+    memcpy(destination->rocks, source->rocks, sizeof(destination->rocks));
+}
+
+static int32_t QuantizeCoordinate(float value) {
+    return (int32_t)lrintf(value * NET_POSITION_SCALE);
+}
+
+NetTreeState QuantizeTree(const Tree* tree, bool relevant) {
+    if (!relevant) return (NetTreeState){ .answer = NO_ANSWER };
+    return (NetTreeState){
+        .x = QuantizeCoordinate(tree->position.x),
+        .z = QuantizeCoordinate(tree->position.z),
+        .answer = tree->answerNumber,
+        .present = 1
+    };
+}
+
+NetRockState QuantizeRock(Vector3 position) {
+    return (NetRockState){ QuantizeCoordinate(position.x), QuantizeCoordinate(position.z), 1 };
+}
+
+NetPlayerState QuantizePlayer(const Player* player, int score) {
+    float turns = player->rotationY / 360.0f;
+    return (NetPlayerState){
+        .x = QuantizeCoordinate(player->position.x),
+        .z = QuantizeCoordinate(player->position.z),
+        .score = score,
+        .rotation = (uint8_t)((int)lrintf((turns - floorf(turns)) * 256.0f) & 0xff),
+        .flags = (uint8_t)(NET_PLAYER_PRESENT | (player->isMoving ? NET_PLAYER_MOVING : 0))
+    };
+}
+
+Vector3 DequantizePosition(int32_t x, int32_t z) {
+    return (Vector3){ x / NET_POSITION_SCALE, 0.0f, z / NET_POSITION_SCALE };
+}
+
+uint16_t PackInput(const InputState* input) {
+    bool bits[] = {
+        input->moveForward, input->moveBack, input->moveLeft, input->moveRight, input->chop,
+        input->nextAnimation, input->prevAnimation, input->toggleHat, input->toggleSword, input->toggleShield
+    };
+    uint16_t packed = 0;
+    for (int b = 0; b < (int)(sizeof(bits) / sizeof(bits[0])); b++) {
+        if (bits[b]) packed |= (uint16_t)(1u << b);
+    }
+    return packed;
+}
+
+// The camera stays on the client, so only the keys travel
+InputState UnpackInput(uint16_t bits) {
+    return (InputState){
+        .moveForward = bits & 1,
+        .moveBack = (bits >> 1) & 1,
+        .moveLeft = (bits >> 2) & 1,
+        .moveRight = (bits >> 3) & 1,
+        .chop = (bits >> 4) & 1,
+        .nextAnimation = (bits >> 5) & 1,
+        .prevAnimation = (bits >> 6) & 1,
+        .toggleHat = (bits >> 7) & 1,
+        .toggleSword = (bits >> 8) & 1,
+        .toggleShield = (bits >> 9) & 1
+    };
+}
+
+static bool ProblemEqual(const MathProblem* a, const MathProblem* b) {
+    return a->a == b->a && a->b == b->b && a->operation == b->operation && a->c == b->c &&
+           a->secondOperation == b->secondOperation && a->correctAnswer == b->correctAnswer;
+}
+
+static bool PlayerStateEqual(const NetPlayerState* a, const NetPlayerState* b) {
+    return a->x == b->x && a->z == b->z && a->score == b->score && a->rotation == b->rotation && a->flags == b->flags;
+}
+
+static bool TreeStateEqual(const NetTreeState* a, const NetTreeState* b) {
+    return a->x == b->x && a->z == b->z && a->answer == b->answer && a->present == b->present;
+}
+
+static bool RockStateEqual(const NetRockState* a, const NetRockState* b) {
+    return a->x == b->x && a->z == b->z && a->present == b->present;
+}
+
+bool NetViewsEqual(const NetView* a, const NetView* b, int treeCount) {
+    if (!ProblemEqual(&a->problem, &b->problem)) return false;
+    for (int p = 0; p < NET_MAX_CLIENTS; p++) {
+        if (!PlayerStateEqual(&a->players[p], &b->players[p])) return false;
+    }
+    for (int i = 0; i < treeCount; i++) {
+        if (!TreeStateEqual(&a->trees[i], &b->trees[i])) return false;
+    }
+    for (int r = 0; r < NET_MAX_ROCKS; r++) {
+        if (!RockStateEqual(&a->rocks[r], &b->rocks[r])) return false;
+    }
+    return true;
+}
+
+// NO_ANSWER as 0, everything else shifted up by one
+static void WriteAnswer(NetWriter* writer, int32_t answer) {
+    if (answer == NO_ANSWER) {
+        WriteVarint(writer, 0);
+        return;
+    }
+    uint32_t zigzag = ((uint32_t)answer << 1) ^ (uint32_t)(answer >> 31);
+    WriteVarint(writer, zigzag + 1);
+}
+
+static int32_t ReadAnswer(NetReader* reader) {
+    uint32_t value = ReadVarint(reader);
+    if (value == 0) return NO_ANSWER;
+    value--;
+    return (int32_t)((value >> 1) ^ (0u - (value & 1)));
+}
+
+static void WriteHeader(NetWriter* writer, const NetSnapshotHeader* header) {
+    WriteU8(writer, NET_MSG_SNAPSHOT);
+    WriteU32(writer, header->sequence);
+    WriteU32(writer, header->baseSequence);
+    WriteU32(writer, header->ackInput);
+    WriteU32(writer, header->serverTick);
+    WriteF32(writer, header->position.x);
+    WriteF32(writer, header->position.z);
+    WriteF32(writer, header->rotationY);
+    WriteU8(writer, header->isMoving);
+}
+
+void EncodeSnapshot(NetWriter* writer, const NetSnapshotHeader* header, const NetView* base,
+                    const NetView* current, NetView* sent, int treeCount) {
+    CopyNetView(sent, base, treeCount);
+    sent->sequence = header->sequence;
+    WriteHeader(writer, header);
+
+    bool problemChanged = !ProblemEqual(&base->problem, &current->problem);
+    WriteU8(writer, problemChanged);
+    if (problemChanged) {
+        const MathProblem* problem = &current->problem;
+        WriteSigned(writer, problem->a);
+        WriteSigned(writer, problem->b);
+        WriteSigned(writer, problem->c);
+        WriteU8(writer, (uint8_t)problem->operation);
+        WriteU8(writer, (uint8_t)(problem->secondOperation + 1));
+        WriteSigned(writer, problem->correctAnswer);
+        sent->problem = *problem;
+    }
+
+    // Counts go in front of their entries, so they're patched in afterwards
+    int playerCountAt = writer->size;
+    WriteU8(writer, 0);
+    int playerCount = 0;
+    for (int p = 0; p < NET_MAX_CLIENTS; p++) {
+        const NetPlayerState* was = &base->players[p];
+        const NetPlayerState* now = &current->players[p];
+        if (PlayerStateEqual(was, now)) continue;
+        if (writer->size + MAX_PLAYER_ENTRY > writer->capacity) break;
+
+        WriteU8(writer, (uint8_t)p);
+        WriteU8(writer, now->flags);
+        if (now->flags & NET_PLAYER_PRESENT) {
+            WriteSigned(writer, now->x - was->x);
+            WriteSigned(writer, now->z - was->z);
+            WriteU8(writer, now->rotation);
+            WriteSigned(writer, now->score - was->score);
+        }
+        sent->players[p] = *now;
+        playerCount++;
+    }
+
+    int treeCountAt = writer->size;
+    WriteU16(writer, 0);
+    int treeChanges = 0;
+    int previous = -1;
+    for (int i = 0; i < treeCount && treeChanges < 0xffff; i++) {
+        const NetTreeState* was = &base->trees[i];
+        const NetTreeState* now = &current->trees[i];
+        if (TreeStateEqual(was, now)) continue;
+        if (writer->size + MAX_TREE_ENTRY > writer->capacity) break;
+
+        bool moved = now->present && (now->x != was->x || now->z != was->z);
+        bool relabeled = now->present && now->answer != was->answer;
+        WriteVarint(writer, (uint32_t)(i - previous - 1));
+        WriteU8(writer, (uint8_t)((now->present ? TREE_PRESENT : 0) | (moved ? TREE_MOVED : 0) | (relabeled ? TREE_RELABELED : 0)));
+        if (moved) {
+            WriteSigned(writer, now->x - was->x);
+            WriteSigned(writer, now->z - was->z);
+        }
+        if (relabeled) WriteAnswer(writer, now->answer);
+        sent->trees[i] = *now;
+        previous = i;
+        treeChanges++;
+    }
+
+    // Rocks only come and go with their chunks, so a present one always
+    // carries its position (as a delta, like trees)
+    int rockCountAt = writer->size;
+    WriteU8(writer, 0);
+    int rockChanges = 0;
+    previous = -1;
+    for (int r = 0; r < NET_MAX_ROCKS; r++) {
+        const NetRockState* was = &base->rocks[r];
+        const NetRockState* now = &current->rocks[r];
+        if (RockStateEqual(was, now)) continue;
+        if (writer->size + MAX_ROCK_ENTRY > writer->capacity) break;
+
+        WriteU8(writer, (uint8_t)(r - previous - 1));
+        WriteU8(writer, now->present);
+        if (now->present) {
+            WriteSigned(writer, now->x - was->x);
+            WriteSigned(writer, now->z - was->z);
+        }
+        sent->rocks[r] = *now;
+        previous = r;
+        rockChanges++;
+    }
+
+    if (writer->overflow) return;
+    writer->data[playerCountAt] = (uint8_t)playerCount;
+    writer->data[treeCountAt] = (uint8_t)treeChanges;
+    writer->data[treeCountAt + 1] = (uint8_t)(treeChanges >> 8);
+    writer->data[rockCountAt] = (uint8_t)rockChanges;
+}
+
+bool DecodeSnapshotHeader(NetReader* reader, NetSnapshotHeader* header) {
+    if (ReadU8(reader) != NET_MSG_SNAPSHOT) return false;
+    header->sequence = ReadU32(reader);
+    header->baseSequence = ReadU32(reader);
+    header->ackInput = ReadU32(reader);
+    header->serverTick = ReadU32(reader);
+    header->position.x = ReadF32(reader);
+    header->position.y = 0.0f;
+    header->position.z = ReadF32(reader);
+    header->rotationY = ReadF32(reader);
+    header->isMoving = ReadU8(reader) != 0;
+    return !reader->overflow;
+}
+
+bool DecodeSnapshot(NetReader* reader, const NetView* base, NetView* view, int treeCount) {
+    NetSnapshotHeader header;
+    if (!DecodeSnapshotHeader(reader, &header)) return false;
+    CopyNetView(view, base, treeCount);
+    view->sequence = header.sequence;
+
+    if (ReadU8(reader)) {
+        MathProblem* problem = &view->problem;
+        problem->a = ReadSigned(reader);
+        problem->b = ReadSigned(reader);
+        problem->c = ReadSigned(reader);
+        problem->operation = ReadU8(reader);
+        problem->secondOperation = (int)ReadU8(reader) - 1;
+        problem->correctAnswer = ReadSigned(reader);
+    }
+
+    int playerCount = ReadU8(reader);
+    for (int n = 0; n < playerCount && !reader->overflow; n++) {
+        int p = ReadU8(reader);
+        if (p >= NET_MAX_CLIENTS) return false;
+        NetPlayerState* player = &view->players[p];
+        uint8_t flags = ReadU8(reader);
+        if (!(flags & NET_PLAYER_PRESENT)) {
+            *player = (NetPlayerState){ 0 };
+            continue;
+        }
+        player->flags = flags;
+        player->x += ReadSigned(reader);
+        player->z += ReadSigned(reader);
+        player->rotation = ReadU8(reader);
+        player->score += ReadSigned(reader);
+    }
+
+    int treeChanges = ReadU16(reader);
+    int i = -1;
+    for (int n = 0; n < treeChanges && !reader->overflow; n++) {
+        i += (int)ReadVarint(reader) + 1;
+        if (i < 0 || i >= treeCount) return false;
+        NetTreeState* tree = &view->trees[i];
+        uint8_t flags = ReadU8(reader);
+        if (!(flags & TREE_PRESENT)) {
+            *tree = (NetTreeState){ .answer = NO_ANSWER };
+            continue;
+        }
+        tree->present = 1;
+        if (flags & TREE_MOVED) {
+            tree->x += ReadSigned(reader);
+            tree->z += ReadSigned(reader);
+        }
+        if (flags & TREE_RELABELED) tree->answer = ReadAnswer(reader);
+    }
+
+    int rockChanges = ReadU8(reader);
+    int r = -1;
+    for (int n = 0; n < rockChanges && !reader->overflow; n++) {
+        r += ReadU8(reader) + 1;
+        if (r >= NET_MAX_ROCKS) return false;
+        NetRockState* rock = &view->rocks[r];
+        if (!ReadU8(reader)) {
+            *rock = (NetRockState){ 0 };
+            continue;
+        }
+        rock->present = 1;
+        rock->x += ReadSigned(reader);
+        rock->z += ReadSigned(reader);
+    }
+    return !reader->overflow;
+}
+
+void WriteWelcome(NetWriter* writer, const NetWelcome* welcome) {
+    WriteU8(writer, NET_MSG_WELCOME);
+    WriteU8(writer, welcome->slot);
+    WriteU32(writer, welcome->serverTick);
+    WriteU32(writer, (uint32_t)welcome->tickRate);
+    WriteU32(writer, (uint32_t)welcome->treeCount);
+    WriteF32(writer, welcome->player.position.x);
+    WriteF32(writer, welcome->player.position.z);
+    WriteF32(writer, welcome->player.rotationY);
+    WriteF32(writer, welcome->player.speed);
+}
+
+bool ReadWelcome(NetReader* reader, NetWelcome* welcome) {
+    if (ReadU8(reader) != NET_MSG_WELCOME) return false;
+    welcome->slot = ReadU8(reader);
+    welcome->serverTick = ReadU32(reader);
+    welcome->tickRate = (int32_t)ReadU32(reader);
+    welcome->treeCount = (int32_t)ReadU32(reader);
+    welcome->player = (Player){ 0 };
+    welcome->player.position.x = ReadF32(reader);
+    welcome->player.position.z = ReadF32(reader);
+    welcome->player.rotationY = ReadF32(reader);
+    welcome->player.speed = ReadF32(reader);
+    return !reader->overflow && welcome->slot < NET_MAX_CLIENTS && welcome->tickRate > 0 && welcome->treeCount >= 0;
+}
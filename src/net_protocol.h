@@ -0,0 +1,116 @@
+#ifndef NET_PROTOCOL_H
+#define NET_PROTOCOL_H
+
+#include "game.h"
+#include "net.h"
+
+#define NET_MAGIC 0x43484f50u     // "CHOP"
+#define NET_PROTOCOL_VERSION 2
+#define NET_DEFAULT_PORT 27960
+#define NET_MAX_CLIENTS 32
+#define NET_MAX_TREES_PER_CHUNK 100   // Every client keeps NET_VIEW_HISTORY copies of the trees
+#define NET_VIEW_HISTORY 16       // Snapshots a client may ack late and still be a delta base
+#define NET_INPUT_HISTORY 64      // Inputs kept for resending and replaying, power of two
+#define NET_INPUT_REDUNDANCY 8    // Latest inputs repeated in every input packet, against loss
+#define NET_SNAPSHOT_INTERVAL 2   // Server ticks per snapshot
+#define NET_INTEREST_RADIUS 48.0f // Trees and rocks further than this from a client aren't sent to it
+#define NET_POSITION_SCALE WORLD_POSITION_SCALE  // Snapshot positions are in 1/64 units
+#define NET_MAX_ROCKS (CHUNK_POOL_SIZE * CHUNK_MAX_ROCKS)  // Indexed like the simulation's rock obstacles
+#define NET_TIMEOUT_SECONDS 5.0
+#define NET_HELLO_INTERVAL 0.25   // Seconds between connection attempts
+
+typedef enum {
+    NET_MSG_HELLO = 1,    // Client: magic, version
+    NET_MSG_WELCOME,      // Server: slot, world settings and the player's start
+    NET_MSG_FULL,         // Server: no free slot
+    NET_MSG_INPUT,        // Client: snapshot ack and its latest inputs
+    NET_MSG_SNAPSHOT,     // Server: world delta against a snapshot the client acked
+    NET_MSG_BYE           // Either side: leaving
+} NetMessageType;
+
+// Snapshot state, quantized. Two views compare equal when a client would
+// see no difference, which is what the delta encoding relies on. Trees and
+// rocks are placed on the 1/NET_POSITION_SCALE grid, so theirs come through
+// exact and the client collides with the same trunks and rocks the server
+// does.
+typedef struct {
+    int32_t x;            // Position in 1/NET_POSITION_SCALE units
+    int32_t z;
+    int32_t answer;       // answerNumber, NO_ANSWER if unlabeled
+    uint8_t present;      // Exists and within the client's interest radius
+} NetTreeState;
+
+typedef struct {
+    int32_t x;
+    int32_t z;
+    uint8_t present;      // In a loaded chunk and within the client's interest radius
+} NetRockState;
+
+typedef struct {
+    int32_t x;
+    int32_t z;
+    int32_t score;
+    uint8_t rotation;     // 256 steps per turn
+    uint8_t flags;        // NET_PLAYER_*
+} NetPlayerState;
+
+#define NET_PLAYER_PRESENT 1
+#define NET_PLAYER_MOVING 2
+
+// The world as one client was told about it in one snapshot
+typedef struct {
+    uint32_t sequence;    // Snapshot it was sent in; 0 is the empty view every client starts from
+    MathProblem problem;
+    NetPlayerState players[NET_MAX_CLIENTS];
+    NetTreeState* trees;  // treeCount entries
+    NetRockState rocks[NET_MAX_ROCKS];
+} NetView;
+
+// Unquantized state of the receiving client's own player, for reconciliation
+typedef struct {
+    uint32_t sequence;
+    uint32_t baseSequence;
+    uint32_t ackInput;    // Last of the client's inputs the server has applied
+    uint32_t serverTick;
+    Vector3 position;
+    float rotationY;
+    bool isMoving;
+} NetSnapshotHeader;
+
+typedef struct {
+    uint8_t slot;
+    uint32_t serverTick;
+    int32_t tickRate;
+    int32_t treeCount;
+    Player player;
+} NetWelcome;
+
+bool InitNetView(NetView* view, int treeCount);
+void FreeNetView(NetView* view);
+// The empty view: nothing present, no problem yet
+void ClearNetView(NetView* view, int treeCount);
+void CopyNetView(NetView* destination, const NetView* source, int treeCount);
+// Same problem, players, trees and rocks (the sequence isn't compared)
+bool NetViewsEqual(const NetView* a, const NetView* b, int treeCount);
+
+NetTreeState QuantizeTree(const Tree* tree, bool relevant);
+NetRockState QuantizeRock(Vector3 position);
+NetPlayerState QuantizePlayer(const Player* player, int score);
+Vector3 DequantizePosition(int32_t x, int32_t z);
+
+uint16_t PackInput(const InputState* input);
+InputState UnpackInput(uint16_t bits);
+
+// Everything in current that differs from base, as much as fits in the
+// writer. sent becomes base plus what was written (the view the client
+// will have once it applies this snapshot), so leftovers go out next time.
+void EncodeSnapshot(NetWriter* writer, const NetSnapshotHeader* header, const NetView* base,
+                    const NetView* current, NetView* sent, int treeCount);
+// The header, then the view base plus the delta. False on a malformed packet.
+bool DecodeSnapshotHeader(NetReader* reader, NetSnapshotHeader* header);
+bool DecodeSnapshot(NetReader* reader, const NetView* base, NetView* view, int treeCount);
+
+void WriteWelcome(NetWriter* writer, const NetWelcome* welcome);
+bool ReadWelcome(NetReader* reader, NetWelcome* welcome);
+
+#endif // NET_PROTOCOL_H
@@ -0,0 +1,183 @@
+#include "raylib.h"
+#include "raymath.h"
+#include "placement.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define SWEEP_SAMPLES_PER_CELL 4  // Jittered points tried in an empty cell after its center
+
+bool InitPlacementGrid(PlacementGrid* grid, float size, float spacing, float snapScale, int capacity) {
+    *grid = (PlacementGrid){ 0 };
+    if (spacing <= 0.0f || size <= 0.0f) return false;
+
+    grid->size = size;
+    grid->spacing = spacing;
+    grid->snapScale = snapScale;
+    grid->cellSize = spacing / sqrtf(2.0f);
+    grid->cellsPerSide = (int)ceilf(grid->size / grid->cellSize);
+    grid->capacity = (capacity > 0) ? capacity : 1;
+
+    size_t cellCount = (size_t)grid->cellsPerSide * grid->cellsPerSide;
+    grid->cells = malloc(sizeof(int) * cellCount);
+    grid->occupantCell = malloc(sizeof(int) * grid->capacity);
+    grid->positions = malloc(sizeof(Vector2) * grid->capacity);
+    grid->active = malloc(sizeof(int) * (grid->capacity + 1));
+    if (!grid->cells || !grid->occupantCell || !grid->positions || !grid->active) {
+        FreePlacementGrid(grid);
+        return false;
+    }
+    ResetPlacementGrid(grid, 0.0f, 0.0f);
+    return true;
+}
+
+void FreePlacementGrid(PlacementGrid* grid) {
+    free(grid->cells);
+    free(grid->occupantCell);
+    free(grid->positions);
+    free(grid->active);
+    *grid = (PlacementGrid){ 0 };
+}
+
+void ResetPlacementGrid(PlacementGrid* grid, float minX, float minZ) {
+    grid->minX = minX;
+    grid->minZ = minZ;
+    int cellCount = grid->cellsPerSide * grid->cellsPerSide;
+    for (int c = 0; c < cellCount; c++) grid->cells[c] = PLACEMENT_EMPTY;
+    for (int i = 0; i < grid->capacity; i++) grid->occupantCell[i] = PLACEMENT_EMPTY;
+}
+
+static bool CellOf(const PlacementGrid* grid, Vector2 point, int* cx, int* cz) {
+    float x = point.x - grid->minX;
+    float z = point.y - grid->minZ;
+    if (x < 0.0f || z < 0.0f || x >= grid->size || z >= grid->size) return false;
+    *cx = (int)(x / grid->cellSize);
+    *cz = (int)(z / grid->cellSize);
+    if (*cx >= grid->cellsPerSide) *cx = grid->cellsPerSide - 1;
+    if (*cz >= grid->cellsPerSide) *cz = grid->cellsPerSide - 1;
+    return true;
+}
+
+bool IsPlacementFree(const PlacementGrid* grid, Vector2 point) {
+    int cx, cz;
+    if (!CellOf(grid, point, &cx, &cz)) return false;
+
+    // Anything closer than spacing is at most two cells away
+    float spacingSqr = grid->spacing * grid->spacing;
+    int x0 = (cx > 2) ? cx - 2 : 0;
+    int z0 = (cz > 2) ? cz - 2 : 0;
+    int x1 = (cx + 2 < grid->cellsPerSide) ? cx + 2 : grid->cellsPerSide - 1;
+    int z1 = (cz + 2 < grid->cellsPerSide) ? cz + 2 : grid->cellsPerSide - 1;
+    for (int z = z0; z <= z1; z++) {
+        for (int x = x0; x <= x1; x++) {
+            int id = grid->cells[z * grid->cellsPerSide + x];
+            if (id != PLACEMENT_EMPTY && Vector2DistanceSqr(grid->positions[id], point) < spacingSqr) return false;
+        }
+    }
+    return true;
+}
+
+bool PlacementAdd(PlacementGrid* grid, int id, Vector2 point) {
+    int cx, cz;
+    if (id < 0 || id >= grid->capacity || !CellOf(grid, point, &cx, &cz)) return false;
+    int cell = cz * grid->cellsPerSide + cx;
+    if (grid->cells[cell] != PLACEMENT_EMPTY) return false;
+
+    PlacementRemove(grid, id);
+    grid->cells[cell] = id;
+    grid->occupantCell[id] = cell;
+    grid->positions[id] = point;
+    return true;
+}
+
+void PlacementRemove(PlacementGrid* grid, int id) {
+    if (id < 0 || id >= grid->capacity || grid->occupantCell[id] == PLACEMENT_EMPTY) return;
+    grid->cells[grid->occupantCell[id]] = PLACEMENT_EMPTY;
+    grid->occupantCell[id] = PLACEMENT_EMPTY;
+}
+
+// Candidates are snapped before the spacing check, so what's placed keeps
+// the spacing exactly
+static Vector2 Snap(const PlacementGrid* grid, Vector2 point) {
+    if (grid->snapScale <= 0.0f) return point;
+    return (Vector2){ roundf(point.x * grid->snapScale) / grid->snapScale, roundf(point.y * grid->snapScale) / grid->snapScale };
+}
+
+// Uniform over the area of the ring [inner, outer] around center
+static Vector2 RandomInRing(Rng* rng, Vector2 center, float inner, float outer) {
+    float angle = RngFloat(rng) * 2.0f * PI;
+    float radius = sqrtf(inner * inner + RngFloat(rng) * (outer * outer - inner * inner));
+    return (Vector2){ center.x + cosf(angle) * radius, center.y + sinf(angle) * radius };
+}
+
+int PlacePoissonBatch(PlacementGrid* grid, Rng* rng, Vector2 start, float clearance,
+                      int firstId, int count, Vector2* points) {
+    if (count > grid->capacity - firstId) count = grid->capacity - firstId;
+    if (count <= 0) return 0;
+
+    // Points that may still have room around them; -1 stands for start,
+    // which isn't an occupant itself
+    int* active = grid->active;
+    int activeCount = 0;
+    active[activeCount++] = -1;
+
+    float clearanceSqr = clearance * clearance;
+    int placed = 0;
+    while (placed < count && activeCount > 0) {
+        int a = RngRange(rng, 0, activeCount - 1);
+        Vector2 center = (active[a] < 0) ? start : grid->positions[active[a]];
+        float inner = (active[a] < 0 && clearance > grid->spacing) ? clearance : grid->spacing;
+
+        bool found = false;
+        for (int k = 0; k < PLACEMENT_ATTEMPTS && !found; k++) {
+            Vector2 candidate = Snap(grid, RandomInRing(rng, center, inner, inner + grid->spacing));
+            if (Vector2DistanceSqr(candidate, start) < clearanceSqr || !IsPlacementFree(grid, candidate)) continue;
+
+            int id = firstId + placed;
+            if (!PlacementAdd(grid, id, candidate)) continue;
+            points[placed++] = candidate;
+            active[activeCount++] = id;
+            found = true;
+        }
+        // Nothing fits around this one any more
+        if (!found) active[a] = active[--activeCount];
+    }
+
+    return placed;
+}
+
+static bool IsCandidateValid(const PlacementGrid* grid, Vector2 point, Vector2 avoid, float avoidRadiusSqr) {
+    return Vector2DistanceSqr(point, avoid) >= avoidRadiusSqr && IsPlacementFree(grid, point);
+}
+
+bool FindPlacement(const PlacementGrid* grid, Rng* rng, Vector2 avoid, float avoidRadius, Vector2* point) {
+    float avoidRadiusSqr = avoidRadius * avoidRadius;
+
+    for (int k = 0; k < PLACEMENT_ATTEMPTS; k++) {
+        Vector2 candidate = Snap(grid, (Vector2){ grid->minX + RngFloat(rng) * grid->size, grid->minZ + RngFloat(rng) * grid->size });
+        if (IsCandidateValid(grid, candidate, avoid, avoidRadiusSqr)) {
+            *point = candidate;
+            return true;
+        }
+    }
+
+    // Crowded world: walk the empty cells instead of hoping
+    int cellCount = grid->cellsPerSide * grid->cellsPerSide;
+    int first = RngRange(rng, 0, cellCount - 1);
+    for (int n = 0; n < cellCount; n++) {
+        int cell = (first + n) % cellCount;
+        if (grid->cells[cell] != PLACEMENT_EMPTY) continue;
+
+        float x = grid->minX + (cell % grid->cellsPerSide) * grid->cellSize;
+        float z = grid->minZ + (cell / grid->cellsPerSide) * grid->cellSize;
+        for (int s = 0; s <= SWEEP_SAMPLES_PER_CELL; s++) {
+            float u = (s == 0) ? 0.5f : RngFloat(rng);
+            float v = (s == 0) ? 0.5f : RngFloat(rng);
+            Vector2 candidate = Snap(grid, (Vector2){ x + u * grid->cellSize, z + v * grid->cellSize });
+            if (IsCandidateValid(grid, candidate, avoid, avoidRadiusSqr)) {
+                *point = candidate;
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,57 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include "raylib.h"
+#include "rng.h"
+
+#define PLACEMENT_EMPTY -1
+#define PLACEMENT_ATTEMPTS 30     // Candidates tried around a point (Bridson's k) or as random darts
+
+// Occupancy of a square area for blue-noise placement. Cells are
+// spacing/sqrt(2) wide, so as long as everything keeps the minimum spacing
+// a cell holds at most one occupant and a point is checked against the 5x5
+// cells around it. Occupant ids are the caller's (e.g. trees, then rocks).
+// Everything is allocated up front, so a grid can be reset and moved to
+// another area without touching the heap.
+typedef struct {
+    float minX;
+    float minZ;
+    float size;           // Side of the square
+    float spacing;        // Minimum distance between any two occupants
+    float snapScale;      // Points are rounded to multiples of 1/snapScale before they're checked; 0 for none
+    float cellSize;
+    int cellsPerSide;
+    int* cells;           // Occupant id per cell, PLACEMENT_EMPTY if none
+    int* occupantCell;    // Per id: cell it's in, PLACEMENT_EMPTY if not placed
+    Vector2* positions;   // Per id, on the XZ plane
+    int capacity;         // Max id + 1
+    int* active;          // Scratch for PlacePoissonBatch, capacity + 1
+} PlacementGrid;
+
+// The square starts out empty at the origin corner; see ResetPlacementGrid
+bool InitPlacementGrid(PlacementGrid* grid, float size, float spacing, float snapScale, int capacity);
+void FreePlacementGrid(PlacementGrid* grid);
+
+// Empty the grid and move its square to start at (minX, minZ)
+void ResetPlacementGrid(PlacementGrid* grid, float minX, float minZ);
+
+// Inside the world and at least spacing away from every occupant
+bool IsPlacementFree(const PlacementGrid* grid, Vector2 point);
+
+// Callers check IsPlacementFree first; an occupied cell is left alone
+bool PlacementAdd(PlacementGrid* grid, int id, Vector2 point);
+void PlacementRemove(PlacementGrid* grid, int id);
+
+// Bridson's algorithm: grow a Poisson-disk set outward from start (which
+// stays clearance free) and give the points ids firstId, firstId + 1, ...
+// Returns how many fit, up to count, in O(count) time.
+int PlacePoissonBatch(PlacementGrid* grid, Rng* rng, Vector2 start, float clearance,
+                      int firstId, int count, Vector2* points);
+
+// A free point at least avoidRadius from avoid: random darts first, then a
+// sweep over the empty cells from a random one (center and a few jittered
+// points each), so it's bounded by the cell count. False means the world
+// is effectively full.
+bool FindPlacement(const PlacementGrid* grid, Rng* rng, Vector2 avoid, float avoidRadius, Vector2* point);
+
+#endif // PLACEMENT_H
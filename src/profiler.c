@@ -0,0 +1,221 @@
+#define _POSIX_C_SOURCE 199309L  // nanosleep
+#include "raylib.h"
+#include "profiler.h"
+#include "logger.h"
+#include "timer.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define SUMMARY_INTERVAL 0.5      // Seconds between overlay refreshes
+#define WRITER_SLEEP_NS 5000000   // Writer poll interval when the ring is empty
+
+static const char* stageNames[PROFILE_STAGE_COUNT] = {
+    "input", "player", "camera", "chop", "animation", "cull",
+    "draw_3d", "labels", "hud", "present", "sim_wait", "frame"
+};
+
+// Single producer (the main thread), single consumer (the CSV writer).
+// Each side only writes its own index, so no locks are needed.
+typedef struct {
+    ProfileFrame frames[PROFILE_RING_SIZE];
+    unsigned int head;    // Next slot to write, advanced by the producer
+    unsigned int tail;    // Next slot to read, advanced by the consumer
+} ProfileRing;
+
+typedef struct {
+    double stageStart[PROFILE_STAGE_COUNT];
+    ProfileFrame current;
+    unsigned int frameIndex;
+
+    ProfileFrame history[PROFILE_HISTORY];
+    int historyCount;
+    int historyNext;
+
+    ProfileRing ring;
+    unsigned int dropped;     // Frames lost because the writer fell behind
+    FILE* csv;
+    pthread_t writer;
+    bool writerRunning;
+    int quit;                 // Atomic
+
+    bool overlayVisible;
+    double summaryTime;
+    char summary[PROFILE_STAGE_COUNT][3][16];   // min, avg, p99 per stage
+} Profiler;
+
+bool profilerEnabled = false;
+static Profiler profiler;
+
+static bool RingPush(ProfileRing* ring, const ProfileFrame* frame) {
+    unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (head - tail == PROFILE_RING_SIZE) return false;
+
+    ring->frames[head & (PROFILE_RING_SIZE - 1)] = *frame;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+#if PROFILE_ENABLED
+static bool RingPop(ProfileRing* ring, ProfileFrame* frame) {
+    unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    if (tail == head) return false;
+
+    *frame = ring->frames[tail & (PROFILE_RING_SIZE - 1)];
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static void WriteCsvFrame(FILE* csv, const ProfileFrame* frame) {
+    fprintf(csv, "%u", frame->frame);
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++) fprintf(csv, ",%.4f", frame->ms[s]);
+    fputc('\n', csv);
+}
+
+// Drains the ring until asked to quit, then writes whatever is left
+static void* WriterMain(void* arg) {
+    (void)arg;
+    ProfileFrame frame;
+    for (;;) {
+        bool quit = __atomic_load_n(&profiler.quit, __ATOMIC_ACQUIRE);
+        int written = 0;
+        while (RingPop(&profiler.ring, &frame)) {
+            WriteCsvFrame(profiler.csv, &frame);
+            written++;
+        }
+        if (quit) break;
+        if (written == 0) {
+            struct timespec pause = { 0, WRITER_SLEEP_NS };
+            nanosleep(&pause, NULL);
+        }
+    }
+    return NULL;
+}
+#endif
+
+bool InitProfiler(const char* csvPath) {
+    profiler = (Profiler){ 0 };
+    profilerEnabled = false;
+    if (csvPath == NULL) return true;
+
+#if PROFILE_ENABLED
+    profiler.csv = fopen(csvPath, "w");
+    if (profiler.csv == NULL) {
+        LOGE(LOG_CAT_PERF, "Could not open %s for the profile", csvPath);
+        return false;
+    }
+    fprintf(profiler.csv, "frame");
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++) fprintf(profiler.csv, ",%s_ms", stageNames[s]);
+    fputc('\n', profiler.csv);
+
+    if (pthread_create(&profiler.writer, NULL, WriterMain, NULL) != 0) {
+        LOGE(LOG_CAT_PERF, "Could not start the profile writer thread");
+        fclose(profiler.csv);
+        profiler.csv = NULL;
+        return false;
+    }
+    profiler.writerRunning = true;
+    profilerEnabled = true;
+    return true;
+#else
+    LOGW(LOG_CAT_PERF, "Profiler compiled out (PROFILE=0), not writing %s", csvPath);
+    return false;
+#endif
+}
+
+void ShutdownProfiler(void) {
+    if (profiler.writerRunning) {
+        __atomic_store_n(&profiler.quit, 1, __ATOMIC_RELEASE);
+        pthread_join(profiler.writer, NULL);
+    }
+    if (profiler.csv != NULL) {
+        fclose(profiler.csv);
+        LOGI(LOG_CAT_PERF, "Profile: %u frames written, %u dropped", profiler.frameIndex - profiler.dropped, profiler.dropped);
+    }
+    profiler = (Profiler){ 0 };
+    profilerEnabled = false;
+}
+
+void ProfileBegin(ProfileStage stage) {
+    profiler.stageStart[stage] = GetMonotonicSeconds();
+}
+
+void ProfileEnd(ProfileStage stage) {
+    profiler.current.ms[stage] += (float)((GetMonotonicSeconds() - profiler.stageStart[stage]) * 1000.0);
+}
+
+void ProfileEndFrame(void) {
+    if (!profilerEnabled) return;
+
+    profiler.current.frame = profiler.frameIndex++;
+    profiler.history[profiler.historyNext] = profiler.current;
+    profiler.historyNext = (profiler.historyNext + 1) % PROFILE_HISTORY;
+    if (profiler.historyCount < PROFILE_HISTORY) profiler.historyCount++;
+
+    if (profiler.writerRunning && !RingPush(&profiler.ring, &profiler.current)) profiler.dropped++;
+    profiler.current = (ProfileFrame){ 0 };
+}
+
+void ToggleProfilerOverlay(void) {
+#if PROFILE_ENABLED
+    profiler.overlayVisible = !profiler.overlayVisible;
+    profilerEnabled = profiler.overlayVisible || profiler.writerRunning;
+
+    // Start the summary from scratch rather than from frames long gone
+    profiler.historyCount = 0;
+    profiler.historyNext = 0;
+    profiler.current = (ProfileFrame){ 0 };
+    profiler.summaryTime = 0.0;
+#endif
+}
+
+static int CompareFloats(const void* a, const void* b) {
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+static void UpdateSummary(void) {
+    float samples[PROFILE_HISTORY];
+    int count = profiler.historyCount;
+
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++) {
+        double sum = 0.0;
+        for (int i = 0; i < count; i++) {
+            samples[i] = profiler.history[i].ms[s];
+            sum += samples[i];
+        }
+        qsort(samples, count, sizeof(float), CompareFloats);
+
+        int p99 = (count * 99 + 99) / 100 - 1;   // Nearest rank
+        float values[3] = { samples[0], (float)(sum / count), samples[p99] };
+        for (int v = 0; v < 3; v++) snprintf(profiler.summary[s][v], sizeof(profiler.summary[s][v]), "%.3f", values[v]);
+    }
+}
+
+void DrawProfilerOverlay(int x, int y) {
+    if (!profiler.overlayVisible) return;
+
+    double now = GetMonotonicSeconds();
+    if (profiler.historyCount > 0 && now - profiler.summaryTime >= SUMMARY_INTERVAL) {
+        UpdateSummary();
+        profiler.summaryTime = now;
+    }
+
+    const int fontSize = 10;
+    const int lineHeight = 12;
+    const int columns[4] = { x + 4, x + 84, x + 144, x + 204 };
+    const char* headings[4] = { "stage (ms)", "min", "avg", "p99" };
+    DrawRectangle(x, y, 260, (PROFILE_STAGE_COUNT + 1) * lineHeight + 8, Fade(BLACK, 0.7f));
+    for (int c = 0; c < 4; c++) DrawText(headings[c], columns[c], y + 4, fontSize, YELLOW);
+
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++) {
+        int rowY = y + 4 + (s + 1) * lineHeight;
+        DrawText(stageNames[s], columns[0], rowY, fontSize, RAYWHITE);
+        if (profiler.summaryTime == 0.0) continue;
+        for (int v = 0; v < 3; v++) DrawText(profiler.summary[s][v], columns[v + 1], rowY, fontSize, RAYWHITE);
+    }
+}
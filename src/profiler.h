@@ -0,0 +1,63 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+
+// Build with `make PROFILE=0` to compile every PROFILE_BEGIN/END out
+#ifndef PROFILE_ENABLED
+    #define PROFILE_ENABLED 1
+#endif
+
+#define PROFILE_HISTORY 240       // Frames the overlay summarizes
+#define PROFILE_RING_SIZE 1024    // Frames queued for the CSV writer, power of two
+
+typedef enum {
+    PROFILE_INPUT = 0,    // PollInput and input accumulation
+    PROFILE_PLAYER,       // UpdatePlayer, all ticks this frame (timed inside the simulation job)
+    PROFILE_CAMERA,       // UpdateGameCamera
+    PROFILE_CHOP,         // CheckTreeRemoval
+    PROFILE_ANIMATION,    // Pose job kick (and wait) or raylib bone update
+    PROFILE_CULL,         // Frustum culling, label atlas update
+    PROFILE_DRAW_3D,      // Everything between BeginMode3D and EndMode3D
+    PROFILE_LABELS,       // 2D answer labels
+    PROFILE_HUD,          // HUD text
+    PROFILE_PRESENT,      // EndDrawing: buffer swap (the frame cap waits after the frame)
+    PROFILE_SIM_WAIT,     // Waiting for the simulation job after drawing
+    PROFILE_FRAME,        // The whole loop iteration
+    PROFILE_STAGE_COUNT
+} ProfileStage;
+
+// Milliseconds spent in each stage during one frame; a stage that runs
+// several times (once per tick) is summed
+typedef struct {
+    unsigned int frame;
+    float ms[PROFILE_STAGE_COUNT];
+} ProfileFrame;
+
+// Checked by the macros so a disabled profiler costs one branch per scope
+extern bool profilerEnabled;
+
+#if PROFILE_ENABLED
+    #define PROFILE_BEGIN(stage) do { if (profilerEnabled) ProfileBegin(stage); } while (0)
+    #define PROFILE_END(stage) do { if (profilerEnabled) ProfileEnd(stage); } while (0)
+#else
+    #define PROFILE_BEGIN(stage) ((void)0)
+    #define PROFILE_END(stage) ((void)0)
+#endif
+
+// csvPath may be NULL. With a path, finished frames are queued on a
+// lock-free ring and written out by a background thread.
+bool InitProfiler(const char* csvPath);
+void ShutdownProfiler(void);
+
+void ProfileBegin(ProfileStage stage);
+void ProfileEnd(ProfileStage stage);
+
+// Close the current frame: add it to the overlay history and the CSV queue
+void ProfileEndFrame(void);
+
+// The overlay turns profiling on while it's shown (or always, with a CSV)
+void ToggleProfilerOverlay(void);
+void DrawProfilerOverlay(int x, int y);
+
+#endif // PROFILER_H
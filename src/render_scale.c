@@ -0,0 +1,105 @@
+#include "raylib.h"
+#include "rlgl.h"
+#include "render_scale.h"
+#include "logger.h"
+#include <math.h>
+
+#define AVERAGE_WEIGHT 0.15       // Of the newest frame in the smoothed frame time
+#define SCALE_UP_HEADROOM 0.7     // Scale up only while frames take less than this much of the budget
+#define SCALE_UP_STEP 0.05f
+#define SCALE_DOWN_TARGET 0.9     // Scale down to land this far under the budget
+#define SCALE_DOWN_LIMIT 0.15f    // At most this much per change, as not all of a frame's cost is pixels
+#define SCALE_COOLDOWN 10         // Frames for the average to catch up with a change
+
+static void ApplyScale(RenderScaler* scaler, float scale) {
+    if (scale < RENDER_SCALE_MIN) scale = RENDER_SCALE_MIN;
+    if (scale > RENDER_SCALE_MAX) scale = RENDER_SCALE_MAX;
+    scaler->scale = scale;
+    scaler->width = (int)(scaler->fullWidth * scale + 0.5f);
+    scaler->height = (int)(scaler->fullHeight * scale + 0.5f);
+}
+
+void InitRenderScaler(RenderScaler* scaler, float scale, double budget) {
+    *scaler = (RenderScaler){ 0 };
+    scaler->fullWidth = GetScreenWidth();
+    scaler->fullHeight = GetScreenHeight();
+    scaler->adaptive = scale <= 0.0f;
+    scaler->budget = budget;
+    scaler->averageSeconds = budget;
+    ApplyScale(scaler, scaler->adaptive ? RENDER_SCALE_MAX : scale);
+    if (!scaler->adaptive && scaler->scale >= RENDER_SCALE_MAX) return;
+
+    scaler->target = LoadRenderTexture(scaler->fullWidth, scaler->fullHeight);
+    if (scaler->target.id == 0) {
+        LOGW(LOG_CAT_RENDER, "Could not create the scaled render target, drawing at full resolution");
+        scaler->adaptive = false;
+        ApplyScale(scaler, RENDER_SCALE_MAX);
+        return;
+    }
+    SetTextureFilter(scaler->target.texture, TEXTURE_FILTER_BILINEAR);
+    LOGI(LOG_CAT_RENDER, "Render scale: %s, starting at %dx%d, budget %.1f ms", scaler->adaptive ? "adaptive" : "fixed",
+         scaler->width, scaler->height, budget * 1000.0);
+}
+
+void UnloadRenderScaler(RenderScaler* scaler) {
+    if (scaler->target.id > 0) UnloadRenderTexture(scaler->target);
+    *scaler = (RenderScaler){ 0 };
+}
+
+void BeginScaledPass(RenderScaler* scaler, Color background) {
+    if (scaler->target.id > 0) {
+        // BeginMode3D takes its aspect from the whole target, which matches
+        // the corner drawn to
+        BeginTextureMode(scaler->target);
+        rlViewport(0, 0, scaler->width, scaler->height);
+    }
+    ClearBackground(background);
+}
+
+void EndScaledPass(RenderScaler* scaler) {
+    if (scaler->target.id == 0) return;
+    EndTextureMode();
+
+    // Render targets are stored bottom up, hence the negative height
+    Rectangle source = { 0.0f, 0.0f, (float)scaler->width, -(float)scaler->height };
+    Rectangle dest = { 0.0f, 0.0f, (float)GetScreenWidth(), (float)GetScreenHeight() };
+    DrawTexturePro(scaler->target.texture, source, dest, (Vector2){ 0.0f, 0.0f }, 0.0f, WHITE);
+}
+
+void UpdateRenderScale(RenderScaler* scaler, double frameSeconds) {
+    bool hit = frameSeconds <= scaler->budget;
+    if (scaler->recentCount == RENDER_SCALE_WINDOW) {
+        scaler->recentHits -= scaler->recent[scaler->recentCursor];
+    } else {
+        scaler->recentCount++;
+    }
+    scaler->recent[scaler->recentCursor] = hit;
+    scaler->recentHits += hit;
+    scaler->recentCursor = (scaler->recentCursor + 1) % RENDER_SCALE_WINDOW;
+
+    scaler->averageSeconds += (frameSeconds - scaler->averageSeconds) * AVERAGE_WEIGHT;
+    if (!scaler->adaptive) return;
+    if (scaler->cooldown > 0) {
+        scaler->cooldown--;
+        return;
+    }
+
+    // Pixel cost goes with the square of the scale
+    float scale = scaler->scale;
+    if (scaler->averageSeconds > scaler->budget && scale > RENDER_SCALE_MIN) {
+        float wanted = scale * (float)sqrt(scaler->budget * SCALE_DOWN_TARGET / scaler->averageSeconds);
+        scale = fmaxf(wanted, scale - SCALE_DOWN_LIMIT);
+    } else if (scaler->averageSeconds < scaler->budget * SCALE_UP_HEADROOM && scale < RENDER_SCALE_MAX) {
+        scale += SCALE_UP_STEP;
+    } else {
+        return;
+    }
+    ApplyScale(scaler, scale);
+    scaler->cooldown = SCALE_COOLDOWN;
+    LOGD(LOG_CAT_RENDER, "Render scale %.0f%% (%dx%d), frames averaging %.1f ms", scaler->scale * 100.0f,
+         scaler->width, scaler->height, scaler->averageSeconds * 1000.0);
+}
+
+float RenderScaleHitRate(const RenderScaler* scaler) {
+    return (scaler->recentCount > 0) ? (float)scaler->recentHits / scaler->recentCount : 1.0f;
+}
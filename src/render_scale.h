@@ -0,0 +1,53 @@
+#ifndef RENDER_SCALE_H
+#define RENDER_SCALE_H
+
+#include "raylib.h"
+#include <stdbool.h>
+
+#define RENDER_SCALE_MIN 0.5f         // Of the window per axis, so a quarter of the pixels
+#define RENDER_SCALE_MAX 1.0f
+#define RENDER_SCALE_WINDOW 120       // Frames the hit rate covers
+
+// The 3D passes are drawn into an offscreen target at a fraction of the
+// window's resolution and stretched over the window, so HUD text and
+// labels drawn afterwards stay sharp. With an adaptive scale the fraction
+// follows the measured frame time: it drops as soon as frames run over
+// the budget and creeps back up while there's headroom. The target is
+// window-sized and only its lower-left corner is used, so changing the
+// scale never reallocates it.
+typedef struct {
+    RenderTexture2D target;   // id 0 when the passes go straight to the window
+    int fullWidth;
+    int fullHeight;
+    int width;                // Of the current pass
+    int height;
+    float scale;
+    bool adaptive;
+    double budget;            // Seconds per frame to stay within
+    double averageSeconds;    // Smoothed frame time
+    int cooldown;             // Frames before the scale may change again
+    unsigned char recent[RENDER_SCALE_WINDOW];  // Whether each of the last frames was within the budget
+    int recentCount;
+    int recentHits;
+    int recentCursor;
+} RenderScaler;
+
+// Needs a window. scale 0 adapts to the budget; anything else is fixed,
+// and 1 draws straight to the window without a target.
+void InitRenderScaler(RenderScaler* scaler, float scale, double budget);
+void UnloadRenderScaler(RenderScaler* scaler);
+
+// Inside BeginDrawing, around the 3D passes: Begin switches to the target
+// at this frame's resolution and clears it, End switches back and draws
+// it stretched over the window. Without a target they only clear.
+void BeginScaledPass(RenderScaler* scaler, Color background);
+void EndScaledPass(RenderScaler* scaler);
+
+// After the frame: record whether it kept to the budget and pick the
+// scale for the next one
+void UpdateRenderScale(RenderScaler* scaler, double frameSeconds);
+
+// Share of the last RENDER_SCALE_WINDOW frames within the budget
+float RenderScaleHitRate(const RenderScaler* scaler);
+
+#endif // RENDER_SCALE_H
@@ -0,0 +1,253 @@
+#include "raylib.h"
+#include "replay.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Packed button bits of a record
+#define BUTTON_FORWARD      (1u << 0)
+#define BUTTON_BACK         (1u << 1)
+#define BUTTON_LEFT         (1u << 2)
+#define BUTTON_RIGHT        (1u << 3)
+#define BUTTON_CHOP         (1u << 4)
+#define BUTTON_NEXT_ANIM    (1u << 5)
+#define BUTTON_PREV_ANIM    (1u << 6)
+#define BUTTON_HAT          (1u << 7)
+#define BUTTON_SWORD        (1u << 8)
+#define BUTTON_SHIELD       (1u << 9)
+#define BUTTON_CAMERA_DRAG  (1u << 10)
+#define RECORD_HAS_DELTA    (1u << 15)   // A float delta follows instead of a run length
+
+#define MAX_RUN_LENGTH 0xFFFF
+
+static uint16_t PackButtons(const InputState* input) {
+    uint16_t bits = 0;
+    if (input->moveForward) bits |= BUTTON_FORWARD;
+    if (input->moveBack) bits |= BUTTON_BACK;
+    if (input->moveLeft) bits |= BUTTON_LEFT;
+    if (input->moveRight) bits |= BUTTON_RIGHT;
+    if (input->chop) bits |= BUTTON_CHOP;
+    if (input->nextAnimation) bits |= BUTTON_NEXT_ANIM;
+    if (input->prevAnimation) bits |= BUTTON_PREV_ANIM;
+    if (input->toggleHat) bits |= BUTTON_HAT;
+    if (input->toggleSword) bits |= BUTTON_SWORD;
+    if (input->toggleShield) bits |= BUTTON_SHIELD;
+    if (input->cameraDrag) bits |= BUTTON_CAMERA_DRAG;
+    return bits;
+}
+
+static InputState UnpackButtons(uint16_t bits) {
+    InputState input = { 0 };
+    input.moveForward = (bits & BUTTON_FORWARD) != 0;
+    input.moveBack = (bits & BUTTON_BACK) != 0;
+    input.moveLeft = (bits & BUTTON_LEFT) != 0;
+    input.moveRight = (bits & BUTTON_RIGHT) != 0;
+    input.chop = (bits & BUTTON_CHOP) != 0;
+    input.nextAnimation = (bits & BUTTON_NEXT_ANIM) != 0;
+    input.prevAnimation = (bits & BUTTON_PREV_ANIM) != 0;
+    input.toggleHat = (bits & BUTTON_HAT) != 0;
+    input.toggleSword = (bits & BUTTON_SWORD) != 0;
+    input.toggleShield = (bits & BUTTON_SHIELD) != 0;
+    input.cameraDrag = (bits & BUTTON_CAMERA_DRAG) != 0;
+    return input;
+}
+
+static void WriteRecord(ReplayRecorder* recorder, const void* data, size_t size) {
+    if (!recorder->failed && fwrite(data, size, 1, recorder->file) != 1) recorder->failed = true;
+}
+
+static void FlushRun(ReplayRecorder* recorder) {
+    if (recorder->runLength == 0) return;
+    WriteRecord(recorder, &recorder->runButtons, sizeof(recorder->runButtons));
+    WriteRecord(recorder, &recorder->runLength, sizeof(recorder->runLength));
+    recorder->runLength = 0;
+}
+
+bool StartRecording(ReplayRecorder* recorder, const char* path, const SimulationConfig* config) {
+    *recorder = (ReplayRecorder){ 0 };
+    recorder->file = fopen(path, "wb");
+    if (recorder->file == NULL) {
+        LOGE(LOG_CAT_REPLAY, "Could not open %s for recording", path);
+        return false;
+    }
+
+    recorder->header = (ReplayHeader){
+        .magic = REPLAY_MAGIC,
+        .version = REPLAY_VERSION,
+        .seed = config->seed,
+        .tickRate = config->tickRate,
+        .treesPerChunk = config->treesPerChunk,
+        .chopQuery = (int32_t)config->chopQuery,
+        .difficulty = (uint32_t)config->difficulty,
+        .botCount = config->botCount
+    };
+    // Rewritten with the tick count and checksum when recording finishes
+    WriteRecord(recorder, &recorder->header, sizeof(recorder->header));
+    return !recorder->failed;
+}
+
+void RecordTick(ReplayRecorder* recorder, const InputState* input) {
+    if (recorder->file == NULL) return;
+    uint16_t buttons = PackButtons(input);
+    recorder->header.tickCount++;
+
+    if (input->cameraDeltaY != 0.0f) {
+        FlushRun(recorder);
+        uint16_t record = buttons | RECORD_HAS_DELTA;
+        WriteRecord(recorder, &record, sizeof(record));
+        WriteRecord(recorder, &input->cameraDeltaY, sizeof(input->cameraDeltaY));
+        return;
+    }
+
+    if (recorder->runLength > 0 && (buttons != recorder->runButtons || recorder->runLength == MAX_RUN_LENGTH)) {
+        FlushRun(recorder);
+    }
+    recorder->runButtons = buttons;
+    recorder->runLength++;
+}
+
+bool FinishRecording(ReplayRecorder* recorder, const Simulation* sim) {
+    if (recorder->file == NULL) return false;
+    FlushRun(recorder);
+
+    recorder->header.finalChecksum = SimulationChecksum(sim);
+    long size = ftell(recorder->file);
+    if (fseek(recorder->file, 0, SEEK_SET) != 0) recorder->failed = true;
+    WriteRecord(recorder, &recorder->header, sizeof(recorder->header));
+    if (fclose(recorder->file) != 0) recorder->failed = true;
+
+    if (recorder->failed) {
+        LOGE(LOG_CAT_REPLAY, "Failed to write the recording");
+    } else {
+        LOGI(LOG_CAT_REPLAY, "Recorded %u ticks in %ld bytes, checksum %016llx", recorder->header.tickCount, size,
+             (unsigned long long)recorder->header.finalChecksum);
+    }
+    bool written = !recorder->failed;
+    *recorder = (ReplayRecorder){ 0 };
+    return written;
+}
+
+bool LoadReplay(ReplayPlayer* player, const char* path) {
+    *player = (ReplayPlayer){ 0 };
+
+    int size = 0;
+    unsigned char* file = LoadFileData(path, &size);
+    if (file == NULL || size < (int)sizeof(ReplayHeader)) {
+        LOGE(LOG_CAT_REPLAY, "Could not read replay %s", path);
+        UnloadFileData(file);
+        return false;
+    }
+    memcpy(&player->header, file, sizeof(ReplayHeader));
+    if (player->header.magic != REPLAY_MAGIC || player->header.version != REPLAY_VERSION ||
+        player->header.tickRate <= 0 || player->header.treesPerChunk < 0 ||
+        player->header.botCount < 0 || player->header.botCount > MAX_BOTS || player->header.difficulty >= DIFFICULTY_COUNT ||
+        player->header.chopQuery < CHOP_QUERY_AUTO || player->header.chopQuery > CHOP_QUERY_SIMD) {
+        LOGE(LOG_CAT_REPLAY, "%s is not a replay this build can play", path);
+        UnloadFileData(file);
+        return false;
+    }
+
+    player->size = (size_t)size - sizeof(ReplayHeader);
+    player->data = malloc(player->size > 0 ? player->size : 1);
+    if (player->data == NULL) {
+        UnloadFileData(file);
+        return false;
+    }
+    memcpy(player->data, file + sizeof(ReplayHeader), player->size);
+    UnloadFileData(file);
+    return true;
+}
+
+void FreeReplay(ReplayPlayer* player) {
+    free(player->data);
+    *player = (ReplayPlayer){ 0 };
+}
+
+static bool ReadRecord(ReplayPlayer* player, void* out, size_t size) {
+    if (player->size - player->cursor < size) return false;
+    memcpy(out, player->data + player->cursor, size);
+    player->cursor += size;
+    return true;
+}
+
+bool NextReplayInput(ReplayPlayer* player, InputState* input) {
+    if (player->ticksRead >= player->header.tickCount) return false;
+
+    if (player->runRemaining == 0) {
+        uint16_t record;
+        if (!ReadRecord(player, &record, sizeof(record))) return false;
+        player->runInput = UnpackButtons(record & ~RECORD_HAS_DELTA);
+
+        if (record & RECORD_HAS_DELTA) {
+            if (!ReadRecord(player, &player->runInput.cameraDeltaY, sizeof(float))) return false;
+            player->runRemaining = 1;
+        } else {
+            uint16_t runLength;
+            if (!ReadRecord(player, &runLength, sizeof(runLength)) || runLength == 0) return false;
+            player->runRemaining = runLength;
+        }
+    }
+
+    *input = player->runInput;
+    player->runRemaining--;
+    player->ticksRead++;
+    return true;
+}
+
+SimulationConfig ReplayConfig(const ReplayPlayer* player) {
+    SimulationConfig config = DefaultSimulationConfig();
+    config.tickRate = player->header.tickRate;
+    config.treesPerChunk = player->header.treesPerChunk;
+    config.chopQuery = (ChopQuery)player->header.chopQuery;
+    config.seed = player->header.seed;
+    config.difficulty = (DifficultyTier)player->header.difficulty;
+    config.botCount = player->header.botCount;
+    return config;
+}
+
+bool ReportReplayChecksum(const ReplayPlayer* player, const Simulation* sim) {
+    unsigned long long checksum = SimulationChecksum(sim);
+    bool complete = player->ticksRead == player->header.tickCount;
+    bool match = complete && checksum == player->header.finalChecksum;
+
+    LOG_AT(match ? LOG_LEVEL_INFO : LOG_LEVEL_ERROR, LOG_CAT_REPLAY,
+           "Replay %s: %u/%u ticks, checksum %016llx, recorded %016llx (%s)",
+           complete ? "finished" : "stopped early", player->ticksRead, player->header.tickCount,
+           checksum, (unsigned long long)player->header.finalChecksum, match ? "MATCH" : "MISMATCH");
+    return match;
+}
+
+void LogTiming(TimingLog* log, double seconds) {
+    if (log->count == log->capacity) {
+        int capacity = log->capacity ? log->capacity * 2 : 4096;
+        float* samples = realloc(log->samples, sizeof(float) * capacity);
+        if (samples == NULL) return;
+        log->samples = samples;
+        log->capacity = capacity;
+    }
+    log->samples[log->count++] = (float)(seconds * 1e6);
+}
+
+static int CompareFloats(const void* a, const void* b) {
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+void PrintTimingSummary(const char* label, TimingLog* log) {
+    if (log->count == 0) return;
+
+    double sum = 0.0;
+    for (int i = 0; i < log->count; i++) sum += log->samples[i];
+    qsort(log->samples, log->count, sizeof(float), CompareFloats);
+
+    int p99 = (log->count * 99 + 99) / 100 - 1;
+    LOGI(LOG_CAT_PERF, "  %-6s n=%-8d min %9.2f us  avg %9.2f us  p99 %9.2f us  max %9.2f us", label, log->count,
+         log->samples[0], sum / log->count, log->samples[p99], log->samples[log->count - 1]);
+}
+
+void FreeTimingLog(TimingLog* log) {
+    free(log->samples);
+    *log = (TimingLog){ 0 };
+}
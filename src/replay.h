@@ -0,0 +1,75 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "game.h"
+#include "input.h"
+#include <stdint.h>
+#include <stdio.h>
+
+#define REPLAY_MAGIC 0x4C505247u   // "GRPL"
+#define REPLAY_VERSION 6   // 2: per-simulation PCG streams and difficulty tiers, 3: streamed chunks, 4: bots, 5: collision, 6: trees and rocks on a 1/64 grid
+
+// Everything needed to rebuild the world the input was recorded against.
+// The checksum is SimulationChecksum after the last recorded tick.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seed;
+    int32_t tickRate;
+    int32_t treesPerChunk;
+    int32_t chopQuery;
+    uint32_t tickCount;
+    uint32_t difficulty;
+    int32_t botCount;
+    uint32_t reserved;        // Keeps the checksum 8-byte aligned
+    uint64_t finalChecksum;
+} ReplayHeader;
+
+// Writes the header, then one record per run of identical ticks: a
+// uint16 of packed buttons followed by a uint16 run length, or by the
+// float mouse delta for ticks where the camera moved (always a run of 1)
+typedef struct {
+    FILE* file;
+    ReplayHeader header;
+    uint16_t runButtons;
+    uint16_t runLength;
+    bool failed;
+} ReplayRecorder;
+
+typedef struct {
+    ReplayHeader header;
+    unsigned char* data;      // Records after the header
+    size_t size;
+    size_t cursor;
+    InputState runInput;      // Current run, handed out runRemaining more times
+    unsigned int runRemaining;
+    unsigned int ticksRead;
+} ReplayPlayer;
+
+bool StartRecording(ReplayRecorder* recorder, const char* path, const SimulationConfig* config);
+void RecordTick(ReplayRecorder* recorder, const InputState* input);
+// Flush, fill in the tick count and final checksum and close the file
+bool FinishRecording(ReplayRecorder* recorder, const Simulation* sim);
+
+bool LoadReplay(ReplayPlayer* player, const char* path);
+void FreeReplay(ReplayPlayer* player);
+// Input for the next tick; false once the recording is exhausted
+bool NextReplayInput(ReplayPlayer* player, InputState* input);
+SimulationConfig ReplayConfig(const ReplayPlayer* player);
+
+// Compare the simulation with what the recording ended on and print it.
+// Returns true when the checksums match.
+bool ReportReplayChecksum(const ReplayPlayer* player, const Simulation* sim);
+
+// Per-tick or per-frame durations for the end-of-replay timing summary
+typedef struct {
+    float* samples;       // Microseconds
+    int count;
+    int capacity;
+} TimingLog;
+
+void LogTiming(TimingLog* log, double seconds);
+void PrintTimingSummary(const char* label, TimingLog* log);
+void FreeTimingLog(TimingLog* log);
+
+#endif // REPLAY_H
@@ -0,0 +1,388 @@
+#include "raylib.h"
+#include "rlgl.h"
+#include "resource_manager.h"
+#include "logger.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char* typeNames[RESOURCE_TYPE_COUNT] = { "model", "animations", "shader" };
+
+const char* ResourceTypeName(ResourceType type) {
+    return typeNames[type];
+}
+
+static uint32_t HandleId(const ResourceManager* manager, const Resource* resource) {
+    return ((uint32_t)resource->generation << 16) | (uint32_t)(resource - manager->resources + 1);
+}
+
+// The resource a handle names, if it's of that type and still held
+static Resource* ResolveHandle(ResourceManager* manager, uint32_t id, ResourceType type) {
+    int index = (int)(id & 0xFFFF) - 1;
+    if (index < 0 || index >= manager->resourceCount) return NULL;
+    Resource* resource = &manager->resources[index];
+    if (resource->type != type || resource->generation != (uint16_t)(id >> 16) || resource->refs <= 0) return NULL;
+    return resource;
+}
+
+static bool IsCachedAsset(const ResourceManager* manager, const Resource* resource) {
+    return resource->asset >= 0 && manager->loader->slots[resource->asset].cached;
+}
+
+// Vertex attributes and indices, as uploaded (or kept on the CPU)
+static size_t MeshBytes(const Mesh* mesh) {
+    size_t perVertex = 0;
+    if (mesh->vertices != NULL) perVertex += 3 * sizeof(float);
+    if (mesh->texcoords != NULL) perVertex += 2 * sizeof(float);
+    if (mesh->texcoords2 != NULL) perVertex += 2 * sizeof(float);
+    if (mesh->normals != NULL) perVertex += 3 * sizeof(float);
+    if (mesh->tangents != NULL) perVertex += 4 * sizeof(float);
+    if (mesh->colors != NULL) perVertex += 4;
+    if (mesh->boneIds != NULL) perVertex += 4;
+    if (mesh->boneWeights != NULL) perVertex += 4 * sizeof(float);
+    size_t indices = (mesh->indices != NULL) ? (size_t)mesh->triangleCount * 3 * sizeof(unsigned short) : 0;
+    return perVertex * (size_t)mesh->vertexCount + indices;
+}
+
+static void MeasureModel(const ResourceManager* manager, Resource* resource) {
+    const Model* model = &resource->model;
+    bool mapped = IsCachedAsset(manager, resource);
+    size_t cpu = 0;
+    size_t gpu = 0;
+    for (int m = 0; m < model->meshCount; m++) {
+        const Mesh* mesh = &model->meshes[m];
+        gpu += MeshBytes(mesh);
+        if (!mapped) {
+            cpu += MeshBytes(mesh);
+            if (mesh->animVertices != NULL) cpu += (size_t)mesh->vertexCount * 3 * sizeof(float);
+            if (mesh->animNormals != NULL) cpu += (size_t)mesh->vertexCount * 3 * sizeof(float);
+        }
+        cpu += (size_t)mesh->boneCount * sizeof(Matrix);
+    }
+    for (int i = 0; i < model->materialCount; i++) {
+        Texture2D texture = model->materials[i].maps[MATERIAL_MAP_DIFFUSE].texture;
+        if (texture.id == 0 || texture.id == rlGetTextureIdDefault()) continue;
+        gpu += (size_t)GetPixelDataSize(texture.width, texture.height, texture.format);
+    }
+    if (!mapped) cpu += (size_t)model->boneCount * (sizeof(BoneInfo) + sizeof(Transform));
+    resource->cpuBytes = cpu;
+    resource->gpuBytes = gpu;
+}
+
+static void MeasureAnimations(const ResourceManager* manager, Resource* resource) {
+    bool mapped = IsCachedAsset(manager, resource);
+    size_t cpu = sizeof(ModelAnimation) * (size_t)resource->animationCount;
+    for (int a = 0; a < resource->animationCount; a++) {
+        const ModelAnimation* animation = &resource->animations[a];
+        cpu += sizeof(Transform*) * (size_t)animation->frameCount;
+        if (!mapped) {
+            cpu += sizeof(Transform) * (size_t)animation->frameCount * (size_t)animation->boneCount;
+            cpu += sizeof(BoneInfo) * (size_t)animation->boneCount;
+        }
+    }
+    resource->cpuBytes = cpu;
+    resource->gpuBytes = 0;
+}
+
+static void MarkResident(ResourceManager* manager, Resource* resource) {
+    resource->state = RESOURCE_RESIDENT;
+    resource->lastUsed = manager->frame;
+    if (resource->type == RESOURCE_MODEL) {
+        MeasureModel(manager, resource);
+    } else if (resource->type == RESOURCE_ANIMATIONS) {
+        MeasureAnimations(manager, resource);
+    } else {
+        resource->cpuBytes = sizeof(int) * RL_MAX_SHADER_LOCATIONS;
+        resource->gpuBytes = 0;
+    }
+    manager->stats.loads++;
+    LOGI(LOG_CAT_ASSETS, "Loaded %s %s: %.1f KB CPU, %.1f KB GPU", ResourceTypeName(resource->type), resource->path,
+         resource->cpuBytes / 1024.0, resource->gpuBytes / 1024.0);
+}
+
+// Load in place, for resources the loader has already handed over (or
+// never had)
+static void LoadResource(ResourceManager* manager, Resource* resource) {
+    bool loaded = false;
+    if (resource->type == RESOURCE_MODEL) {
+        resource->model = (resource->asset >= 0) ? ReloadModelAsset(manager->loader, (AssetId)resource->asset) : LoadModel(resource->path);
+        loaded = resource->model.meshCount > 0;
+    } else if (resource->type == RESOURCE_ANIMATIONS) {
+        resource->animations = (resource->asset >= 0) ?
+            ReloadAnimationAssets(manager->loader, (AssetId)resource->asset, &resource->animationCount) :
+            LoadModelAnimations(resource->path, &resource->animationCount);
+        loaded = resource->animations != NULL && resource->animationCount > 0;
+    } else {
+        resource->shader = LoadShader(resource->path, resource->fragmentPath);
+        if (resource->shader.id == 0 && resource->fallbackVertex != NULL) {
+            resource->shader = LoadShaderFromMemory(resource->fallbackVertex, resource->fallbackFragment);
+        }
+        loaded = resource->shader.id > 0;
+    }
+
+    if (loaded) {
+        MarkResident(manager, resource);
+    } else {
+        resource->state = RESOURCE_MISSING;
+        LOGW(LOG_CAT_ASSETS, "Could not load %s %s", ResourceTypeName(resource->type), resource->path);
+    }
+}
+
+static void UnloadResource(ResourceManager* manager, Resource* resource) {
+    if (resource->type == RESOURCE_MODEL) {
+        if (resource->asset >= 0) {
+            UnloadModelAsset(manager->loader, (AssetId)resource->asset, resource->model);
+        } else {
+            UnloadModel(resource->model);
+        }
+        resource->model = (Model){ 0 };
+    } else if (resource->type == RESOURCE_ANIMATIONS) {
+        if (resource->asset >= 0) {
+            UnloadAnimationAssets(manager->loader, (AssetId)resource->asset, resource->animations, resource->animationCount);
+        } else {
+            UnloadModelAnimations(resource->animations, resource->animationCount);
+        }
+        resource->animations = NULL;
+        resource->animationCount = 0;
+    } else {
+        UnloadShader(resource->shader);
+        resource->shader = (Shader){ 0 };
+    }
+    resource->cpuBytes = 0;
+    resource->gpuBytes = 0;
+}
+
+static Resource* FindResource(ResourceManager* manager, ResourceType type, const char* path, const char* fragmentPath) {
+    for (int i = 0; i < manager->resourceCount; i++) {
+        Resource* resource = &manager->resources[i];
+        if (resource->type != type || strcmp(resource->path, path) != 0) continue;
+        if (fragmentPath != NULL && strcmp(resource->fragmentPath, fragmentPath) != 0) continue;
+        return resource;
+    }
+    return NULL;
+}
+
+// A new slot, not loaded yet. NULL when the table is full.
+static Resource* AddResource(ResourceManager* manager, ResourceType type, const char* path) {
+    if (manager->resourceCount == RESOURCE_MAX) {
+        LOGE(LOG_CAT_ASSETS, "Out of resource slots for %s", path);
+        return NULL;
+    }
+    Resource* resource = &manager->resources[manager->resourceCount++];
+    *resource = (Resource){ .type = type, .asset = -1, .generation = 1, .state = RESOURCE_EVICTED };
+    snprintf(resource->path, sizeof(resource->path), "%s", path);
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        if (strcmp(GetAssetPath((AssetId)i), path) == 0) resource->asset = i;
+    }
+    return resource;
+}
+
+// Take a reference, loading first when it has to be
+static uint32_t AcquireResource(ResourceManager* manager, Resource* resource) {
+    if (resource == NULL) return 0;
+    if (resource->refs > 0 || resource->state == RESOURCE_RESIDENT) {
+        manager->stats.hits++;
+    } else if (resource->state == RESOURCE_EVICTED) {
+        bool reload = resource->lastUsed > 0;
+        LoadResource(manager, resource);
+        if (reload && resource->state == RESOURCE_RESIDENT) {
+            manager->stats.reloads++;
+            LOGI(LOG_CAT_ASSETS, "Reloaded %s %s", ResourceTypeName(resource->type), resource->path);
+        }
+    }
+    resource->refs++;
+    resource->lastUsed = manager->frame;
+    return HandleId(manager, resource);
+}
+
+static void ReleaseResource(ResourceManager* manager, uint32_t id, ResourceType type) {
+    Resource* resource = ResolveHandle(manager, id, type);
+    if (resource == NULL) return;
+    resource->lastUsed = manager->frame;
+    if (--resource->refs == 0) {
+        resource->generation++;
+        if (resource->generation == 0) resource->generation = 1;
+    }
+}
+
+void InitResourceManager(ResourceManager* manager, AssetLoader* loader, size_t cpuBudget, size_t gpuBudget) {
+    *manager = (ResourceManager){ 0 };
+    manager->loader = loader;
+    manager->cpuBudget = cpuBudget;
+    manager->gpuBudget = gpuBudget;
+    manager->frame = 1;
+
+    for (int i = 0; i < ASSET_COUNT; i++) {
+        Resource* resource = AddResource(manager, RESOURCE_MODEL, GetAssetPath((AssetId)i));
+        resource->state = RESOURCE_PENDING;
+    }
+}
+
+void FreeResourceManager(ResourceManager* manager) {
+    for (int i = 0; i < manager->resourceCount; i++) {
+        Resource* resource = &manager->resources[i];
+        if (resource->state == RESOURCE_RESIDENT) UnloadResource(manager, resource);
+    }
+    *manager = (ResourceManager){ 0 };
+}
+
+// Models from the loader bring their animations with them
+static void TakeLoaderModel(ResourceManager* manager, Resource* resource) {
+    AssetId id = (AssetId)resource->asset;
+    AssetState state = GetAssetState(manager->loader, id);
+    if (state == ASSET_LOADING) return;
+
+    Resource* animations = FindResource(manager, RESOURCE_ANIMATIONS, resource->path, NULL);
+    if (state != ASSET_READY) {
+        resource->state = RESOURCE_MISSING;
+        if (animations != NULL) animations->state = RESOURCE_MISSING;
+        return;
+    }
+
+    ModelAnimation* taken = NULL;
+    int takenCount = 0;
+    resource->model = TakeModelAsset(manager->loader, id, &taken, &takenCount);
+    if (resource->model.meshCount > 0) {
+        MarkResident(manager, resource);
+    } else {
+        resource->state = RESOURCE_MISSING;
+    }
+
+    if (taken != NULL && animations == NULL) animations = AddResource(manager, RESOURCE_ANIMATIONS, resource->path);
+    if (animations == NULL) {
+        UnloadAnimationAssets(manager->loader, id, taken, takenCount);
+    } else if (taken != NULL) {
+        animations->animations = taken;
+        animations->animationCount = takenCount;
+        MarkResident(manager, animations);
+    } else {
+        animations->state = RESOURCE_MISSING;
+    }
+}
+
+void UpdateResources(ResourceManager* manager) {
+    manager->frame++;
+    for (int i = 0; i < manager->resourceCount; i++) {
+        Resource* resource = &manager->resources[i];
+        if (resource->state == RESOURCE_PENDING && resource->type == RESOURCE_MODEL) TakeLoaderModel(manager, resource);
+    }
+
+    ResourceStats* stats = &manager->stats;
+    for (;;) {
+        memset(stats->types, 0, sizeof(stats->types));
+        stats->cpuBytes = 0;
+        stats->gpuBytes = 0;
+        Resource* victim = NULL;
+        for (int i = 0; i < manager->resourceCount; i++) {
+            Resource* resource = &manager->resources[i];
+            if (resource->state != RESOURCE_RESIDENT) continue;
+            ResourceTypeStats* type = &stats->types[resource->type];
+            type->resident++;
+            type->cpuBytes += resource->cpuBytes;
+            type->gpuBytes += resource->gpuBytes;
+            stats->cpuBytes += resource->cpuBytes;
+            stats->gpuBytes += resource->gpuBytes;
+            if (resource->refs == 0 && (victim == NULL || resource->lastUsed < victim->lastUsed)) victim = resource;
+        }
+
+        bool over = stats->cpuBytes > manager->cpuBudget || stats->gpuBytes > manager->gpuBudget;
+        if (over && victim != NULL) {
+            LOGI(LOG_CAT_ASSETS, "Evicting %s %s (%.1f KB CPU, %.1f KB GPU, unused for %llu frames)", ResourceTypeName(victim->type),
+                 victim->path, victim->cpuBytes / 1024.0, victim->gpuBytes / 1024.0, (unsigned long long)(manager->frame - victim->lastUsed));
+            UnloadResource(manager, victim);
+            victim->state = RESOURCE_EVICTED;
+            stats->evictions++;
+            continue;
+        }
+
+        // Nothing left to evict; say so once rather than every frame
+        if (over && !manager->overBudget) {
+            LOGW(LOG_CAT_ASSETS, "Resources in use exceed the budget: %.1f/%.1f MB CPU, %.1f/%.1f MB GPU",
+                 stats->cpuBytes / 1048576.0, manager->cpuBudget / 1048576.0, stats->gpuBytes / 1048576.0, manager->gpuBudget / 1048576.0);
+        }
+        manager->overBudget = over;
+        break;
+    }
+}
+
+ModelHandle AcquireModel(ResourceManager* manager, const char* path) {
+    Resource* resource = FindResource(manager, RESOURCE_MODEL, path, NULL);
+    if (resource == NULL) resource = AddResource(manager, RESOURCE_MODEL, path);
+    return (ModelHandle){ AcquireResource(manager, resource) };
+}
+
+AnimationsHandle AcquireAnimations(ResourceManager* manager, const char* path) {
+    Resource* resource = FindResource(manager, RESOURCE_ANIMATIONS, path, NULL);
+    if (resource == NULL) {
+        resource = AddResource(manager, RESOURCE_ANIMATIONS, path);
+        // The loader hands these over along with the model
+        if (resource != NULL && resource->asset >= 0) {
+            const Resource* model = FindResource(manager, RESOURCE_MODEL, path, NULL);
+            if (model != NULL && model->state == RESOURCE_PENDING) resource->state = RESOURCE_PENDING;
+        }
+    }
+    return (AnimationsHandle){ AcquireResource(manager, resource) };
+}
+
+ShaderHandle AcquireShader(ResourceManager* manager, const char* vertexPath, const char* fragmentPath,
+                           const char* fallbackVertex, const char* fallbackFragment) {
+    Resource* resource = FindResource(manager, RESOURCE_SHADER, vertexPath, fragmentPath);
+    if (resource == NULL) {
+        resource = AddResource(manager, RESOURCE_SHADER, vertexPath);
+        if (resource != NULL) {
+            snprintf(resource->fragmentPath, sizeof(resource->fragmentPath), "%s", fragmentPath);
+            resource->fallbackVertex = fallbackVertex;
+            resource->fallbackFragment = fallbackFragment;
+        }
+    }
+    return (ShaderHandle){ AcquireResource(manager, resource) };
+}
+
+void ReleaseModel(ResourceManager* manager, ModelHandle* handle) {
+    ReleaseResource(manager, handle->id, RESOURCE_MODEL);
+    handle->id = 0;
+}
+
+void ReleaseAnimations(ResourceManager* manager, AnimationsHandle* handle) {
+    ReleaseResource(manager, handle->id, RESOURCE_ANIMATIONS);
+    handle->id = 0;
+}
+
+void ReleaseShader(ResourceManager* manager, ShaderHandle* handle) {
+    ReleaseResource(manager, handle->id, RESOURCE_SHADER);
+    handle->id = 0;
+}
+
+// Resident resources behind a held handle, marked as used this frame
+static Resource* LookUp(ResourceManager* manager, uint32_t id, ResourceType type) {
+    Resource* resource = ResolveHandle(manager, id, type);
+    if (resource == NULL || resource->state != RESOURCE_RESIDENT) return NULL;
+    resource->lastUsed = manager->frame;
+    return resource;
+}
+
+Model* GetModel(ResourceManager* manager, ModelHandle handle) {
+    Resource* resource = LookUp(manager, handle.id, RESOURCE_MODEL);
+    return (resource != NULL) ? &resource->model : NULL;
+}
+
+ModelAnimation* GetAnimations(ResourceManager* manager, AnimationsHandle handle, int* animationCount) {
+    Resource* resource = LookUp(manager, handle.id, RESOURCE_ANIMATIONS);
+    *animationCount = (resource != NULL) ? resource->animationCount : 0;
+    return (resource != NULL) ? resource->animations : NULL;
+}
+
+Shader* GetShader(ResourceManager* manager, ShaderHandle handle) {
+    Resource* resource = LookUp(manager, handle.id, RESOURCE_SHADER);
+    return (resource != NULL) ? &resource->shader : NULL;
+}
+
+void LogResourceStats(const ResourceManager* manager) {
+    const ResourceStats* stats = &manager->stats;
+    for (int t = 0; t < RESOURCE_TYPE_COUNT; t++) {
+        const ResourceTypeStats* type = &stats->types[t];
+        LOGI(LOG_CAT_ASSETS, "Resources, %s: %d resident, %.1f KB CPU, %.1f KB GPU", ResourceTypeName((ResourceType)t),
+             type->resident, type->cpuBytes / 1024.0, type->gpuBytes / 1024.0);
+    }
+    LOGI(LOG_CAT_ASSETS, "Resources: %u loads (%u reloads), %u shared, %u evictions, budget %.0f MB CPU / %.0f MB GPU",
+         stats->loads, stats->reloads, stats->hits, stats->evictions, manager->cpuBudget / 1048576.0, manager->gpuBudget / 1048576.0);
+}
@@ -0,0 +1,120 @@
+#ifndef RESOURCE_MANAGER_H
+#define RESOURCE_MANAGER_H
+
+#include "raylib.h"
+#include "asset_loader.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define RESOURCE_MAX 32                  // Far more than the game loads
+#define RESOURCE_PATH_SIZE 256
+#define DEFAULT_RESOURCE_CPU_BUDGET_MB 64
+#define DEFAULT_RESOURCE_GPU_BUDGET_MB 64
+
+typedef enum {
+    RESOURCE_MODEL = 0,
+    RESOURCE_ANIMATIONS,
+    RESOURCE_SHADER,
+    RESOURCE_TYPE_COUNT
+} ResourceType;
+
+typedef enum {
+    RESOURCE_PENDING = 0,     // Waiting for the asset loader
+    RESOURCE_RESIDENT,
+    RESOURCE_EVICTED,         // Unloaded to make room, loaded again when acquired
+    RESOURCE_MISSING          // Failed to load
+} ResourceState;
+
+// A handle is a slot index plus the generation the slot had when it was
+// acquired. The generation moves on when the last reference is released,
+// so a handle kept past its release resolves to nothing. Zero is never a
+// valid handle.
+typedef struct { uint32_t id; } ModelHandle;
+typedef struct { uint32_t id; } AnimationsHandle;
+typedef struct { uint32_t id; } ShaderHandle;
+
+typedef struct {
+    ResourceType type;
+    char path[RESOURCE_PATH_SIZE];          // Loads are deduplicated on type and paths
+    char fragmentPath[RESOURCE_PATH_SIZE];  // Shaders only
+    const char* fallbackVertex;   // Shaders only: source used when the files don't load, NULL for none
+    const char* fallbackFragment;
+    int asset;                // AssetId when it comes through the asset loader, -1 if not
+    uint16_t generation;
+    int refs;
+    ResourceState state;
+    uint64_t lastUsed;        // Frame it was last acquired, looked up or released
+    size_t cpuBytes;          // Estimates while resident; mapped cache data counts as the loader's
+    size_t gpuBytes;
+    Model model;
+    ModelAnimation* animations;
+    int animationCount;
+    Shader shader;
+} Resource;
+
+typedef struct {
+    int resident;
+    size_t cpuBytes;
+    size_t gpuBytes;
+} ResourceTypeStats;
+
+typedef struct {
+    ResourceTypeStats types[RESOURCE_TYPE_COUNT];  // What's resident now
+    size_t cpuBytes;
+    size_t gpuBytes;
+    unsigned int loads;       // Including reloads
+    unsigned int reloads;     // Of evicted resources
+    unsigned int hits;        // Acquires of a resource already held or still loaded
+    unsigned int evictions;
+} ResourceStats;
+
+// Owns the models, animations and shaders the game draws with. Everything
+// is reference counted; a resource nobody holds stays loaded until the CPU
+// or GPU budget needs the room, and then goes least recently used first.
+// Main thread only, since loading and unloading touch GL.
+typedef struct {
+    AssetLoader* loader;
+    Resource resources[RESOURCE_MAX];
+    int resourceCount;
+    size_t cpuBudget;
+    size_t gpuBudget;
+    uint64_t frame;
+    bool overBudget;          // Held resources alone exceed a budget
+    ResourceStats stats;
+} ResourceManager;
+
+// Every asset of the loader is picked up as it finishes, held or not, so
+// the loader can let go of its copy. Budgets are in bytes.
+void InitResourceManager(ResourceManager* manager, AssetLoader* loader, size_t cpuBudget, size_t gpuBudget);
+// Unloads everything, held or not. Cached models point into the loader's
+// mappings, so this goes before StopAssetLoader.
+void FreeResourceManager(ResourceManager* manager);
+
+// Once a frame: take what the loader has finished, then evict until both
+// budgets are met or nothing unreferenced is left
+void UpdateResources(ResourceManager* manager);
+
+// Resources that come through the asset loader may not be loaded yet when
+// acquired; anything else (and anything evicted) is loaded right away
+ModelHandle AcquireModel(ResourceManager* manager, const char* path);
+AnimationsHandle AcquireAnimations(ResourceManager* manager, const char* path);
+// The fallback source, if any, must outlive the manager
+ShaderHandle AcquireShader(ResourceManager* manager, const char* vertexPath, const char* fragmentPath,
+                           const char* fallbackVertex, const char* fallbackFragment);
+
+// Drop a reference and clear the handle
+void ReleaseModel(ResourceManager* manager, ModelHandle* handle);
+void ReleaseAnimations(ResourceManager* manager, AnimationsHandle* handle);
+void ReleaseShader(ResourceManager* manager, ShaderHandle* handle);
+
+// NULL while loading, when it failed to load, or for a released handle.
+// Pointers stay valid for as long as the handle is held.
+Model* GetModel(ResourceManager* manager, ModelHandle handle);
+ModelAnimation* GetAnimations(ResourceManager* manager, AnimationsHandle handle, int* animationCount);
+Shader* GetShader(ResourceManager* manager, ShaderHandle handle);
+
+const char* ResourceTypeName(ResourceType type);
+void LogResourceStats(const ResourceManager* manager);
+
+#endif // RESOURCE_MANAGER_H
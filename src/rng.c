@@ -0,0 +1,46 @@
+#include "rng.h"
+
+#define PCG_MULTIPLIER 6364136223846793005ULL
+
+void SeedRng(Rng* rng, uint64_t seed, uint64_t stream) {
+    rng->state = 0;
+    rng->increment = (stream << 1) | 1u;
+    RngNext(rng);
+    rng->state += seed;
+    RngNext(rng);
+}
+
+uint32_t RngNext(Rng* rng) {
+    uint64_t old = rng->state;
+    rng->state = old * PCG_MULTIPLIER + rng->increment;
+    uint32_t xorShifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rotation = (uint32_t)(old >> 59);
+    return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+}
+
+int RngRange(Rng* rng, int min, int max) {
+    if (max <= min) return min;
+    uint32_t span = (uint32_t)max - (uint32_t)min + 1u;
+    if (span == 0) return (int)RngNext(rng); // The whole 32-bit range
+
+    // Reject the top sliver that doesn't divide evenly by span
+    uint32_t threshold = (0u - span) % span;
+    uint32_t value;
+    do {
+        value = RngNext(rng);
+    } while (value < threshold);
+    return (int)((uint32_t)min + value % span);
+}
+
+float RngFloat(Rng* rng) {
+    return (RngNext(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+void RngShuffle(Rng* rng, int* values, int count) {
+    for (int i = count - 1; i > 0; i--) {
+        int j = RngRange(rng, 0, i);
+        int temp = values[i];
+        values[i] = values[j];
+        values[j] = temp;
+    }
+}
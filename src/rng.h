@@ -0,0 +1,29 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// PCG32 (XSH RR): 64 bits of state, a 32-bit output per step. Each
+// generator owns its state, so the simulation's sequences don't depend on
+// who else calls rand() or on which thread a tick runs.
+typedef struct {
+    uint64_t state;
+    uint64_t increment;   // Selects the stream, always odd
+} Rng;
+
+// Same seed and stream, same sequence. Different streams of one seed are
+// independent, so subsystems can share a seed without sharing numbers.
+void SeedRng(Rng* rng, uint64_t seed, uint64_t stream);
+
+uint32_t RngNext(Rng* rng);
+
+// Uniform in [min, max], without modulo bias
+int RngRange(Rng* rng, int min, int max);
+
+// Uniform in [0, 1)
+float RngFloat(Rng* rng);
+
+// Fisher-Yates
+void RngShuffle(Rng* rng, int* values, int count);
+
+#endif // RNG_H
@@ -0,0 +1,523 @@
+#include "raylib.h"
+#include "save_game.h"
+#include "logger.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SAVE_ALIGN 8              // Every section starts on this, so arrays can be used in place
+#define SAVE_INITIAL_CAPACITY (64 * 1024)
+
+// A placed occupant of a chunk's placement grid
+typedef struct {
+    int32_t id;
+    float x;
+    float z;
+} SavedPlacement;
+
+// Changes whenever a struct saved as it is in memory changes size
+static uint32_t LayoutSignature(void) {
+    const uint32_t sizes[] = {
+        sizeof(Player), sizeof(GameCamera), sizeof(GameState), sizeof(Rng), sizeof(ProblemEngine),
+        sizeof(Tree), sizeof(TreeGridEntry), sizeof(ChunkLayout), sizeof(SavedPlacement), sizeof(Bot)
+    };
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) hash = (hash ^ sizes[i]) * 16777619u;
+    return hash;
+}
+
+// FNV-1a a word at a time: the payload is a multiple of 8 bytes, and this
+// keeps hashing a 10 MB save at memory speed
+static uint64_t HashPayload(const unsigned char* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t words = size / sizeof(uint64_t);
+    for (size_t w = 0; w < words; w++) {
+        uint64_t word;
+        memcpy(&word, data + w * sizeof(uint64_t), sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+    for (size_t i = words * sizeof(uint64_t); i < size; i++) hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    return hash;
+}
+
+static size_t AlignUp(size_t offset) {
+    return (offset + SAVE_ALIGN - 1) & ~(size_t)(SAVE_ALIGN - 1);
+}
+
+// Room for size bytes at the next aligned offset, which is returned
+// (SIZE_MAX once out of memory). The buffer may move, so callers keep
+// offsets rather than pointers across reservations.
+static size_t Reserve(SaveBuffer* buffer, size_t size) {
+    if (buffer->failed) return SIZE_MAX;
+    size_t start = AlignUp(buffer->size);
+    size_t end = start + size;
+    if (end > buffer->capacity) {
+        size_t capacity = (buffer->capacity > 0) ? buffer->capacity : SAVE_INITIAL_CAPACITY;
+        while (capacity < end) capacity *= 2;
+        unsigned char* data = realloc(buffer->data, capacity);
+        if (data == NULL) {
+            buffer->failed = true;
+            return SIZE_MAX;
+        }
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+    memset(buffer->data + buffer->size, 0, start - buffer->size);
+    buffer->size = end;
+    return start;
+}
+
+static void Put(SaveBuffer* buffer, const void* data, size_t size) {
+    size_t offset = Reserve(buffer, size);
+    if (offset != SIZE_MAX && size > 0) memcpy(buffer->data + offset, data, size);
+}
+
+static void PutInt(SaveBuffer* buffer, int32_t value) {
+    Put(buffer, &value, sizeof(value));
+}
+
+// Entry count, then the entries; returns where the entries start
+static size_t PutGrid(SaveBuffer* buffer, const TreeGrid* grid, int* count) {
+    size_t countOffset = Reserve(buffer, sizeof(int32_t));
+    size_t entriesOffset = Reserve(buffer, sizeof(TreeGridEntry) * grid->capacity);
+    *count = 0;
+    if (entriesOffset == SIZE_MAX) return SIZE_MAX;
+
+    *count = TreeGridEntries(grid, (TreeGridEntry*)(buffer->data + entriesOffset), grid->capacity);
+    int32_t written = *count;
+    memcpy(buffer->data + countOffset, &written, sizeof(written));
+    buffer->size = entriesOffset + sizeof(TreeGridEntry) * (size_t)*count;
+    return entriesOffset;
+}
+
+bool CaptureSave(SaveBuffer* buffer, const Simulation* sim) {
+    buffer->size = 0;
+    buffer->failed = false;
+    Reserve(buffer, sizeof(SaveHeader));   // Filled in last, the buffer may still move
+
+    // Player, camera, score, problem and the random streams
+    PutInt(buffer, (int32_t)sim->tick);
+    Put(buffer, &sim->player, sizeof(sim->player));
+    Put(buffer, &sim->gameCamera, sizeof(sim->gameCamera));
+    Put(buffer, &sim->gameState, sizeof(sim->gameState));
+    uint8_t equipment[3] = { sim->equipment.showHat, sim->equipment.showSword, sim->equipment.showShield };
+    Put(buffer, equipment, sizeof(equipment));
+    Put(buffer, &sim->rng, sizeof(sim->rng));
+    Put(buffer, &sim->problems, sizeof(sim->problems));
+    int32_t animation[3] = { sim->currentAnimation, sim->currentFrame, (int32_t)sim->animationTicks };
+    Put(buffer, animation, sizeof(animation));
+
+    // Trees, and the grid over them chain for chain
+    Put(buffer, sim->trees, sizeof(Tree) * sim->treeCount);
+    int treeEntries;
+    PutGrid(buffer, &sim->treeGrid, &treeEntries);
+
+    // Obstacles: their grid, then the box of each entry
+    const CollisionWorld* collision = &sim->collision;
+    int obstacleCount;
+    size_t entriesOffset = PutGrid(buffer, &collision->grid, &obstacleCount);
+    size_t boxesOffset = Reserve(buffer, sizeof(float) * 4 * obstacleCount);
+    if (entriesOffset != SIZE_MAX && boxesOffset != SIZE_MAX) {
+        const TreeGridEntry* entries = (const TreeGridEntry*)(buffer->data + entriesOffset);
+        float* boxes = (float*)(buffer->data + boxesOffset);
+        for (int e = 0; e < obstacleCount; e++) {
+            int i = entries[e].index;
+            boxes[e * 4 + 0] = collision->minX[i];
+            boxes[e * 4 + 1] = collision->minZ[i];
+            boxes[e * 4 + 2] = collision->maxX[i];
+            boxes[e * 4 + 3] = collision->maxZ[i];
+        }
+    }
+
+    // Chunk slots. Loaded ones keep what's placed in them, for respawns;
+    // generating ones only their coordinates, they're generated again.
+    const ChunkPool* pool = &sim->chunks;
+    int32_t center[4] = { pool->centerX, pool->centerZ, pool->centered, (int32_t)pool->generated };
+    Put(buffer, center, sizeof(center));
+    for (int s = 0; s < CHUNK_POOL_SIZE; s++) {
+        const Chunk* chunk = &pool->chunks[s];
+        int32_t slot[3] = { (int32_t)chunk->state, (int32_t)chunk->readyTick, chunk->treeCount };
+        Put(buffer, slot, sizeof(slot));
+        Put(buffer, &chunk->layout, sizeof(chunk->layout));
+        if (chunk->state != CHUNK_LOADED) continue;
+
+        const PlacementGrid* placement = &chunk->placement;
+        float origin[2] = { placement->minX, placement->minZ };
+        Put(buffer, origin, sizeof(origin));
+        size_t countOffset = Reserve(buffer, sizeof(int32_t));
+        size_t placedOffset = Reserve(buffer, sizeof(SavedPlacement) * placement->capacity);
+        if (placedOffset == SIZE_MAX) break;
+        SavedPlacement* placed = (SavedPlacement*)(buffer->data + placedOffset);
+        int32_t count = 0;
+        for (int id = 0; id < placement->capacity; id++) {
+            if (placement->occupantCell[id] == PLACEMENT_EMPTY) continue;
+            placed[count++] = (SavedPlacement){ id, placement->positions[id].x, placement->positions[id].y };
+        }
+        memcpy(buffer->data + countOffset, &count, sizeof(count));
+        buffer->size = placedOffset + sizeof(SavedPlacement) * (size_t)count;
+    }
+
+    Put(buffer, sim->bots, sizeof(Bot) * sim->botCount);
+    Reserve(buffer, 0);   // Pad the end too
+    if (buffer->failed) return false;
+
+    SaveHeader header = {
+        .magic = SAVE_MAGIC,
+        .version = SAVE_VERSION,
+        .layout = LayoutSignature(),
+        .seed = (uint32_t)pool->seed,
+        .tickRate = sim->tickRate,
+        .treesPerChunk = pool->treesPerChunk,
+        .chopQuery = (int32_t)sim->chopQuery,
+        .difficulty = (uint32_t)sim->problems.tier,
+        .botCount = sim->botCount,
+        .tick = sim->tick,
+        .payloadSize = buffer->size - sizeof(SaveHeader),
+        .checksum = SimulationChecksum(sim)
+    };
+    memcpy(buffer->data, &header, sizeof(header));
+    return true;
+}
+
+bool WriteSaveFile(SaveBuffer* buffer, const char* path) {
+    if (buffer->size < sizeof(SaveHeader)) return false;
+    SaveHeader header;
+    memcpy(&header, buffer->data, sizeof(header));
+    header.payloadHash = HashPayload(buffer->data + sizeof(SaveHeader), buffer->size - sizeof(SaveHeader));
+    memcpy(buffer->data, &header, sizeof(header));
+
+    char temporaryPath[512];
+    snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", path);
+    FILE* file = fopen(temporaryPath, "wb");
+    if (file == NULL) return false;
+    bool written = fwrite(buffer->data, buffer->size, 1, file) == 1;
+    if (fclose(file) != 0) written = false;
+    if (!written || rename(temporaryPath, path) != 0) {
+        remove(temporaryPath);
+        return false;
+    }
+    return true;
+}
+
+void FreeSaveBuffer(SaveBuffer* buffer) {
+    free(buffer->data);
+    *buffer = (SaveBuffer){ 0 };
+}
+
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    size_t cursor;
+    bool failed;
+} SaveReader;
+
+// The next size bytes at the next aligned offset, NULL past the end
+static const void* Take(SaveReader* reader, size_t size) {
+    size_t start = AlignUp(reader->cursor);
+    if (reader->failed || start > reader->size || size > reader->size - start) {
+        reader->failed = true;
+        return NULL;
+    }
+    reader->cursor = start + size;
+    return reader->data + start;
+}
+
+static void Get(SaveReader* reader, void* out, size_t size) {
+    const void* data = Take(reader, size);
+    if (data != NULL) memcpy(out, data, size);
+    else memset(out, 0, size);
+}
+
+static int32_t GetInt(SaveReader* reader) {
+    int32_t value;
+    Get(reader, &value, sizeof(value));
+    return value;
+}
+
+// Entry count and entries, checked against the grid; NULL when they don't fit
+static const TreeGridEntry* TakeGrid(SaveReader* reader, const TreeGrid* grid, int* count) {
+    *count = GetInt(reader);
+    if (*count < 0 || *count > grid->capacity) {
+        reader->failed = true;
+        *count = 0;
+        return NULL;
+    }
+    const TreeGridEntry* entries = Take(reader, sizeof(TreeGridEntry) * (size_t)*count);
+    for (int e = 0; entries != NULL && e < *count; e++) {
+        if (entries[e].index < 0 || entries[e].index >= grid->capacity) {
+            reader->failed = true;
+            return NULL;
+        }
+    }
+    return entries;
+}
+
+// The other half of CaptureSave, into a simulation fresh from AllocateSimulation
+static bool RestoreSimulation(Simulation* sim, SaveReader* reader) {
+    sim->tick = (unsigned int)GetInt(reader);
+    Get(reader, &sim->player, sizeof(sim->player));
+    Get(reader, &sim->gameCamera, sizeof(sim->gameCamera));
+    Get(reader, &sim->gameState, sizeof(sim->gameState));
+    uint8_t equipment[3];
+    Get(reader, equipment, sizeof(equipment));
+    sim->equipment.showHat = equipment[0] != 0;
+    sim->equipment.showSword = equipment[1] != 0;
+    sim->equipment.showShield = equipment[2] != 0;
+    Get(reader, &sim->rng, sizeof(sim->rng));
+    Get(reader, &sim->problems, sizeof(sim->problems));
+    int32_t animation[3];
+    Get(reader, animation, sizeof(animation));
+    sim->currentAnimation = animation[0];
+    sim->currentFrame = animation[1];
+    sim->animationTicks = (unsigned int)animation[2];
+    if (sim->problems.head < 0 || sim->problems.head >= PROBLEM_POOL_SIZE ||
+        sim->problems.count < 0 || sim->problems.count > PROBLEM_POOL_SIZE) return false;
+
+    Get(reader, sim->trees, sizeof(Tree) * sim->treeCount);
+    int count;
+    const TreeGridEntry* entries = TakeGrid(reader, &sim->treeGrid, &count);
+    if (entries == NULL) return false;
+    TreeGridRestore(&sim->treeGrid, entries, count);
+
+    CollisionWorld* collision = &sim->collision;
+    entries = TakeGrid(reader, &collision->grid, &count);
+    const float* boxes = Take(reader, sizeof(float) * 4 * (size_t)count);
+    if (entries == NULL || boxes == NULL) return false;
+    for (int e = 0; e < count; e++) {
+        int i = entries[e].index;
+        collision->minX[i] = boxes[e * 4 + 0];
+        collision->minZ[i] = boxes[e * 4 + 1];
+        collision->maxX[i] = boxes[e * 4 + 2];
+        collision->maxZ[i] = boxes[e * 4 + 3];
+    }
+    TreeGridRestore(&collision->grid, entries, count);
+
+    ChunkPool* pool = &sim->chunks;
+    int32_t center[4];
+    Get(reader, center, sizeof(center));
+    pool->centerX = center[0];
+    pool->centerZ = center[1];
+    pool->centered = center[2] != 0;
+    pool->generated = (unsigned int)center[3];
+    for (int s = 0; s < CHUNK_POOL_SIZE && !reader->failed; s++) {
+        Chunk* chunk = &pool->chunks[s];
+        int32_t slot[3];
+        Get(reader, slot, sizeof(slot));
+        Get(reader, &chunk->layout, sizeof(chunk->layout));
+        if (slot[0] < CHUNK_FREE || slot[0] > CHUNK_LOADED || slot[2] < 0 || slot[2] > pool->treesPerChunk ||
+            chunk->layout.rockCount < 0 || chunk->layout.rockCount > CHUNK_MAX_ROCKS) return false;
+        chunk->state = (ChunkState)slot[0];
+        chunk->readyTick = (unsigned int)slot[1];
+        chunk->treeCount = slot[2];
+        if (chunk->state != CHUNK_LOADED) continue;
+
+        // Re-adding at the same spots lands everything in the same cells
+        PlacementGrid* placement = &chunk->placement;
+        float origin[2];
+        Get(reader, origin, sizeof(origin));
+        ResetPlacementGrid(placement, origin[0], origin[1]);
+        int placedCount = GetInt(reader);
+        if (placedCount < 0 || placedCount > placement->capacity) return false;
+        const SavedPlacement* placed = Take(reader, sizeof(SavedPlacement) * (size_t)placedCount);
+        for (int p = 0; placed != NULL && p < placedCount; p++) {
+            if (placed[p].id < 0 || placed[p].id >= placement->capacity) return false;
+            PlacementAdd(placement, placed[p].id, (Vector2){ placed[p].x, placed[p].z });
+        }
+    }
+
+    Get(reader, sim->bots, sizeof(Bot) * sim->botCount);
+    if (reader->failed) return false;
+
+    // The SoA store mirrors the trees slot for slot
+    for (int i = 0; i < sim->treeCount; i++) {
+        TreeSoASet(&sim->treeStore, i, sim->trees[i].position, sim->trees[i].exists, sim->trees[i].answerNumber);
+    }
+    sim->treesVersion = 1;
+    sim->layoutVersion = 1;
+    RestartChunkJobs(pool);
+    return true;
+}
+
+static unsigned char* ReadSaveFile(const char* path, size_t* size) {
+    *size = 0;
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+
+    unsigned char* data = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long length = ftell(file);
+        if (length > 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data = malloc((size_t)length);
+            if (data != NULL && fread(data, 1, (size_t)length, file) == (size_t)length) {
+                *size = (size_t)length;
+            } else {
+                free(data);
+                data = NULL;
+            }
+        }
+    }
+    fclose(file);
+    return data;
+}
+
+bool LoadSimulation(Simulation* sim, const char* path, JobSystem* jobs) {
+    double start = GetMonotonicSeconds();
+    size_t size;
+    unsigned char* data = ReadSaveFile(path, &size);
+    if (data == NULL || size < sizeof(SaveHeader)) {
+        LOGE(LOG_CAT_SAVE, "Could not read save %s", path);
+        free(data);
+        return false;
+    }
+
+    SaveHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != SAVE_MAGIC || header.version != SAVE_VERSION || header.layout != LayoutSignature() ||
+        header.tickRate <= 0 || header.treesPerChunk < 0 || header.treesPerChunk > MAX_TREES_PER_CHUNK ||
+        header.botCount < 0 || header.botCount > MAX_BOTS || header.difficulty >= DIFFICULTY_COUNT ||
+        header.chopQuery <= CHOP_QUERY_AUTO || header.chopQuery > CHOP_QUERY_SIMD) {
+        LOGE(LOG_CAT_SAVE, "%s is not a save this build can load", path);
+        free(data);
+        return false;
+    }
+    if (header.payloadSize != size - sizeof(SaveHeader) ||
+        header.payloadHash != HashPayload(data + sizeof(SaveHeader), size - sizeof(SaveHeader))) {
+        LOGE(LOG_CAT_SAVE, "%s is damaged or incomplete", path);
+        free(data);
+        return false;
+    }
+    double readSeconds = GetMonotonicSeconds() - start;
+
+    SimulationConfig config = DefaultSimulationConfig();
+    config.tickRate = header.tickRate;
+    config.treesPerChunk = header.treesPerChunk;
+    config.chopQuery = (ChopQuery)header.chopQuery;
+    config.seed = header.seed;
+    config.difficulty = (DifficultyTier)header.difficulty;
+    config.botCount = header.botCount;
+    config.jobs = jobs;
+    if (!AllocateSimulation(sim, &config)) {
+        LOGE(LOG_CAT_SAVE, "Failed to allocate a world with %d trees per chunk", config.treesPerChunk);
+        free(data);
+        return false;
+    }
+
+    SaveReader reader = { data, size, sizeof(SaveHeader), false };
+    bool restored = RestoreSimulation(sim, &reader);
+    free(data);
+    if (!restored || SimulationChecksum(sim) != header.checksum) {
+        LOGE(LOG_CAT_SAVE, "%s doesn't restore to the state it was saved from", path);
+        FreeSimulation(sim);
+        return false;
+    }
+
+    LOGI(LOG_CAT_SAVE, "Resumed %s at tick %u: %d tree slots, %d bots, score %d (%.1f KB, read in %.2f ms, restored in %.2f ms)",
+         path, sim->tick, sim->treeCount, sim->botCount, sim->gameState.score, size / 1024.0,
+         readSeconds * 1000.0, (GetMonotonicSeconds() - start - readSeconds) * 1000.0);
+    return true;
+}
+
+// On the writer thread, or the caller's when there is none
+static void WritePending(SaveWriter* writer) {
+    SaveHeader header;
+    memcpy(&header, writer->buffer.data, sizeof(header));
+    double start = GetMonotonicSeconds();
+    bool written = WriteSaveFile(&writer->buffer, writer->path);
+    writer->writeSeconds = GetMonotonicSeconds() - start;
+
+    if (written) {
+        writer->saves++;
+        LOGI(LOG_CAT_SAVE, "Saved tick %u to %s: %.1f KB, captured in %.2f ms, written in %.2f ms", header.tick,
+             writer->path, writer->buffer.size / 1024.0, writer->captureSeconds * 1000.0, writer->writeSeconds * 1000.0);
+    } else {
+        writer->failures++;
+        LOGE(LOG_CAT_SAVE, "Could not write %s", writer->path);
+    }
+}
+
+static void* WriterMain(void* arg) {
+    SaveWriter* writer = arg;
+    pthread_mutex_lock(&writer->mutex);
+    for (;;) {
+        while (!writer->busy && !writer->quit) pthread_cond_wait(&writer->wake, &writer->mutex);
+        if (!writer->busy) break;
+        pthread_mutex_unlock(&writer->mutex);
+
+        WritePending(writer);
+
+        pthread_mutex_lock(&writer->mutex);
+        writer->busy = false;
+        pthread_cond_broadcast(&writer->done);
+    }
+    pthread_mutex_unlock(&writer->mutex);
+    return NULL;
+}
+
+bool StartSaveWriter(SaveWriter* writer, const char* path) {
+    *writer = (SaveWriter){ .path = path };
+    if (pthread_mutex_init(&writer->mutex, NULL) != 0) return false;
+    pthread_cond_init(&writer->wake, NULL);
+    pthread_cond_init(&writer->done, NULL);
+    if (pthread_create(&writer->thread, NULL, WriterMain, writer) == 0) {
+        writer->threadStarted = true;
+    } else {
+        LOGW(LOG_CAT_SAVE, "Could not start the save thread, saving in place");
+    }
+    return true;
+}
+
+void WaitForSave(SaveWriter* writer) {
+    pthread_mutex_lock(&writer->mutex);
+    while (writer->busy) pthread_cond_wait(&writer->done, &writer->mutex);
+    pthread_mutex_unlock(&writer->mutex);
+}
+
+void StopSaveWriter(SaveWriter* writer) {
+    if (writer->threadStarted) {
+        pthread_mutex_lock(&writer->mutex);
+        writer->quit = true;
+        pthread_cond_signal(&writer->wake);
+        pthread_mutex_unlock(&writer->mutex);
+        pthread_join(writer->thread, NULL);
+    }
+    if (writer->skipped > 0 || writer->failures > 0) {
+        LOGW(LOG_CAT_SAVE, "Saves: %u written, %u skipped while one was being written, %u failed",
+             writer->saves, writer->skipped, writer->failures);
+    }
+    pthread_cond_destroy(&writer->wake);
+    pthread_cond_destroy(&writer->done);
+    pthread_mutex_destroy(&writer->mutex);
+    FreeSaveBuffer(&writer->buffer);
+    *writer = (SaveWriter){ 0 };
+}
+
+bool RequestSave(SaveWriter* writer, const Simulation* sim) {
+    pthread_mutex_lock(&writer->mutex);
+    bool busy = writer->busy;
+    pthread_mutex_unlock(&writer->mutex);
+    if (busy) {
+        writer->skipped++;
+        LOGW(LOG_CAT_SAVE, "Still writing the last save, skipping tick %u", sim->tick);
+        return false;
+    }
+
+    double start = GetMonotonicSeconds();
+    bool captured = CaptureSave(&writer->buffer, sim);
+    writer->captureSeconds = GetMonotonicSeconds() - start;
+    if (!captured) {
+        writer->failures++;
+        LOGE(LOG_CAT_SAVE, "Out of memory capturing a save of tick %u", sim->tick);
+        return false;
+    }
+
+    if (!writer->threadStarted) {
+        WritePending(writer);
+        return true;
+    }
+    pthread_mutex_lock(&writer->mutex);
+    writer->busy = true;
+    pthread_cond_signal(&writer->wake);
+    pthread_mutex_unlock(&writer->mutex);
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef SAVE_GAME_H
+#define SAVE_GAME_H
+
+#include "game.h"
+#include "job_system.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SAVE_MAGIC 0x56415347u     // "GSAV"
+#define SAVE_VERSION 2          // 2: trees and rocks on a 1/64 grid
+#define DEFAULT_AUTOSAVE_SECONDS 60    // Of game time between autosaves
+
+// A save file is this header and then the payload: flat sections, each
+// starting 8-byte aligned, in a fixed order (state, trees, tree grid,
+// obstacles, chunks, bots). Plain structs go in as they are in memory, so
+// a save only loads into a build with the same layout; `layout` catches
+// the ones that don't. Indices that can be rebuilt exactly (the SoA store)
+// aren't saved, and chunks that were still being generated are saved as
+// requests and generated again.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t layout;          // Sizes of the structs saved as they are
+    uint32_t seed;
+    int32_t tickRate;
+    int32_t treesPerChunk;
+    int32_t chopQuery;        // As resolved, never auto
+    uint32_t difficulty;
+    int32_t botCount;
+    uint32_t tick;
+    uint64_t payloadSize;
+    uint64_t payloadHash;     // Of the payload, to catch torn or corrupt files
+    uint64_t checksum;        // SimulationChecksum when it was saved
+} SaveHeader;
+
+// A captured save, header first. Kept between saves so its memory is reused.
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+    bool failed;              // Ran out of memory while capturing
+} SaveBuffer;
+
+// Copy everything a resume needs out of the simulation. Only copies, so the
+// simulation can move on as soon as it returns.
+bool CaptureSave(SaveBuffer* buffer, const Simulation* sim);
+// Seal the capture and write it next to path, then rename it over path so a
+// crash mid-write leaves the previous save intact
+bool WriteSaveFile(SaveBuffer* buffer, const char* path);
+void FreeSaveBuffer(SaveBuffer* buffer);
+
+// Rebuild a simulation from a save, straight into the state it was saved
+// in: no chunk is generated again that was already loaded, no problem is
+// drawn again. Chunks are generated with jobs when it's not NULL, as in
+// InitSimulation. Fails without leaving anything allocated.
+bool LoadSimulation(Simulation* sim, const char* path, JobSystem* jobs);
+
+// Writes saves on a background thread. A save is captured on the calling
+// thread (the one that owns the simulation) and handed over, so the only
+// cost to the caller is the copy.
+typedef struct {
+    const char* path;
+    pthread_t thread;
+    bool threadStarted;
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    bool busy;                // The thread owns the buffer
+    bool quit;
+    SaveBuffer buffer;
+    unsigned int saves;
+    unsigned int skipped;     // Requested while the last one was still being written
+    unsigned int failures;
+    double captureSeconds;    // Of the last save
+    double writeSeconds;
+} SaveWriter;
+
+bool StartSaveWriter(SaveWriter* writer, const char* path);
+// Write whatever is pending, then stop the thread
+void StopSaveWriter(SaveWriter* writer);
+
+// Capture now and write in the background. Skipped (false) while the
+// previous save is still being written.
+bool RequestSave(SaveWriter* writer, const Simulation* sim);
+void WaitForSave(SaveWriter* writer);
+
+#endif // SAVE_GAME_H
@@ -0,0 +1,357 @@
+#include "raylib.h"
+#include "server.h"
+#include "logger.h"
+#include "timer.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define SPAWN_RING_RADIUS 4.0f    // Clients past slot 0 start spread around the origin
+
+bool InitNetServer(NetServer* server, const SimulationConfig* config, uint16_t port, const NetShimConfig* shim) {
+    *server = (NetServer){ 0 };
+    server->socket.fd = -1;
+
+    // Every client keeps a window of views with a state per tree, so the
+    // world has to stay small; bots aren't part of the protocol
+    SimulationConfig serverConfig = *config;
+    if (serverConfig.treesPerChunk > NET_MAX_TREES_PER_CHUNK) serverConfig.treesPerChunk = NET_MAX_TREES_PER_CHUNK;
+    serverConfig.botCount = 0;
+    if (!InitSimulation(&server->sim, &serverConfig)) return false;
+
+    int treeCount = server->sim.treeCount;
+    if (!InitNetView(&server->empty, treeCount) || !InitNetView(&server->current, treeCount) ||
+        !OpenNetSocket(&server->socket, port, shim, serverConfig.seed)) {
+        FreeNetServer(server);
+        return false;
+    }
+    return true;
+}
+
+static void FreeClientViews(NetServerClient* client) {
+    if (client->views == NULL) return;
+    for (int v = 0; v < NET_VIEW_HISTORY; v++) FreeNetView(&client->views[v]);
+    free(client->views);
+    client->views = NULL;
+}
+
+void FreeNetServer(NetServer* server) {
+    for (int c = 0; c < NET_MAX_CLIENTS; c++) FreeClientViews(&server->clients[c]);
+    FreeNetView(&server->empty);
+    FreeNetView(&server->current);
+    CloseNetSocket(&server->socket);
+    FreeSimulation(&server->sim);
+}
+
+int ConnectedClientCount(const NetServer* server) {
+    int count = 0;
+    for (int c = 0; c < NET_MAX_CLIENTS; c++) {
+        if (server->clients[c].connected) count++;
+    }
+    return count;
+}
+
+double ServerBytesPerClientTick(const NetServer* server) {
+    return (server->clientTicks > 0) ? (double)server->snapshotBytes / server->clientTicks : 0.0;
+}
+
+static Player* ClientPlayer(NetServer* server, int slot) {
+    return (slot == 0) ? &server->sim.player : &server->clients[slot].player;
+}
+
+static int* ClientScore(NetServer* server, int slot) {
+    return (slot == 0) ? &server->sim.gameState.score : &server->clients[slot].score;
+}
+
+static void SendToClient(NetServer* server, NetAddress to, const NetWriter* writer, double now) {
+    NetSend(&server->socket, to, writer->data, writer->size, now);
+}
+
+static void SendWelcome(NetServer* server, int slot, double now) {
+    NetWelcome welcome = {
+        .slot = (uint8_t)slot,
+        .serverTick = server->sim.tick,
+        .tickRate = server->sim.tickRate,
+        .treeCount = server->sim.treeCount,
+        .player = *ClientPlayer(server, slot)
+    };
+    NetWriter writer = { server->packet, NET_MAX_PACKET, 0, false };
+    WriteWelcome(&writer, &welcome);
+    SendToClient(server, server->clients[slot].address, &writer, now);
+}
+
+static int FindClient(const NetServer* server, NetAddress address) {
+    for (int c = 0; c < NET_MAX_CLIENTS; c++) {
+        if (server->clients[c].connected && NetAddressEqual(server->clients[c].address, address)) return c;
+    }
+    return -1;
+}
+
+static void HandleHello(NetServer* server, NetReader* reader, NetAddress from, double now) {
+    uint32_t magic = ReadU32(reader);
+    uint8_t version = ReadU8(reader);
+    if (reader->overflow || magic != NET_MAGIC || version != NET_PROTOCOL_VERSION) return;
+
+    // A repeated hello means our welcome was lost
+    int slot = FindClient(server, from);
+    if (slot < 0) {
+        for (int c = 0; c < NET_MAX_CLIENTS && slot < 0; c++) {
+            if (!server->clients[c].connected) slot = c;
+        }
+        if (slot < 0) {
+            uint8_t full = NET_MSG_FULL;
+            NetSend(&server->socket, from, &full, 1, now);
+            return;
+        }
+
+        NetServerClient* client = &server->clients[slot];
+        if (client->views == NULL) {
+            client->views = calloc(NET_VIEW_HISTORY, sizeof(NetView));
+            bool allocated = client->views != NULL;
+            for (int v = 0; v < NET_VIEW_HISTORY && allocated; v++) {
+                allocated = InitNetView(&client->views[v], server->sim.treeCount);
+            }
+            if (!allocated) {
+                LOGE(LOG_CAT_NET, "Out of memory for client views");
+                FreeClientViews(client);
+                return;
+            }
+        }
+        NetView* views = client->views;
+        *client = (NetServerClient){ .connected = true, .address = from, .views = views };
+        for (int v = 0; v < NET_VIEW_HISTORY; v++) ClearNetView(&views[v], server->sim.treeCount);
+        if (slot > 0) {
+            float angle = slot * 2.0f * PI / NET_MAX_CLIENTS;
+            client->player = server->sim.player;
+            client->player.position = (Vector3){ cosf(angle) * SPAWN_RING_RADIUS, 0.0f, sinf(angle) * SPAWN_RING_RADIUS };
+            client->player.velocity = (Vector3){ 0.0f, 0.0f, 0.0f };
+            client->player.isMoving = false;
+        }
+        LOGI(LOG_CAT_NET, "Client %d connected from %u.%u.%u.%u:%u", slot,
+             from.host >> 24, (from.host >> 16) & 0xff, (from.host >> 8) & 0xff, from.host & 0xff, from.port);
+    }
+    server->clients[slot].lastHeard = now;
+    SendWelcome(server, slot, now);
+}
+
+static void HandleInput(NetServer* server, NetReader* reader, int slot) {
+    NetServerClient* client = &server->clients[slot];
+    uint32_t snapshotAck = ReadU32(reader);
+    uint32_t newest = ReadU32(reader);
+    int count = ReadU8(reader);
+    if (reader->overflow || count > NET_INPUT_HISTORY || newest < (uint32_t)count) return;
+
+    // Only a snapshot we still hold can become the delta base
+    if (snapshotAck > client->ackedSnapshot && snapshotAck <= client->snapshotSequence &&
+        client->snapshotSequence - snapshotAck < NET_VIEW_HISTORY) {
+        client->ackedSnapshot = snapshotAck;
+    }
+
+    for (int k = 0; k < count; k++) {
+        uint32_t sequence = newest - (uint32_t)count + 1 + (uint32_t)k;
+        uint16_t bits = ReadU16(reader);
+        if (reader->overflow) return;
+        if (sequence <= client->lastApplied || sequence - client->lastApplied > NET_INPUT_HISTORY) continue;
+        client->inputs[sequence & (NET_INPUT_HISTORY - 1)] = bits;
+        client->inputSequences[sequence & (NET_INPUT_HISTORY - 1)] = sequence;
+    }
+    if (newest > client->newestInput) client->newestInput = newest;
+}
+
+static void Disconnect(NetServer* server, int slot, const char* reason) {
+    server->clients[slot].connected = false;
+    LOGI(LOG_CAT_NET, "Client %d %s", slot, reason);
+}
+
+static void ReceivePackets(NetServer* server, double now) {
+    NetAddress from;
+    int size;
+    while ((size = NetReceive(&server->socket, &from, server->packet, NET_MAX_PACKET)) > 0) {
+        NetReader reader = { server->packet, size, 0, false };
+        uint8_t type = ReadU8(&reader);
+        if (type == NET_MSG_HELLO) {
+            HandleHello(server, &reader, from, now);
+            continue;
+        }
+
+        int slot = FindClient(server, from);
+        if (slot < 0) continue;
+        server->clients[slot].lastHeard = now;
+        if (type == NET_MSG_INPUT) HandleInput(server, &reader, slot);
+        else if (type == NET_MSG_BYE) Disconnect(server, slot, "left");
+    }
+}
+
+// One input per tick, in order. A lost one is waited for briefly (it may
+// come again in the next packet's redundant inputs), then skipped. With
+// nothing queued yet the player stands still; a standing tick doesn't move
+// it, so the client's prediction still holds once the input turns up.
+static InputState NextClientInput(NetServerClient* client) {
+    uint32_t next = client->lastApplied + 1;
+    int index = next & (NET_INPUT_HISTORY - 1);
+    if (client->inputSequences[index] == next) {
+        client->lastApplied = next;
+        client->waitTicks = 0;
+        return UnpackInput(client->inputs[index]);
+    }
+    if (client->newestInput > next && ++client->waitTicks > NET_INPUT_WAIT_TICKS) {
+        client->lastApplied = next;
+        client->waitTicks = 0;
+    }
+    return (InputState){ 0 };
+}
+
+// Move and chop for a client the simulation doesn't step itself
+static void ApplyInput(NetServer* server, int slot, const InputState* input) {
+    Simulation* sim = &server->sim;
+    Player* player = ClientPlayer(server, slot);
+    MovePlayer(sim, player, input);
+    if (!input->chop) return;
+    int tree = FindSimulationChopTarget(sim, player);
+    if (tree >= 0) ChopTree(sim, player, tree, ClientScore(server, slot));
+}
+
+static void StepPlayers(NetServer* server) {
+    NetServerClient* clients = server->clients;
+
+    // A client whose inputs piled up (after a wait for a lost one, or a
+    // burst) gets an extra one applied per tick until it's caught up, so the
+    // delay doesn't stay for good
+    for (int c = 0; c < NET_MAX_CLIENTS; c++) {
+        if (!clients[c].connected || clients[c].newestInput - clients[c].lastApplied <= NET_INPUT_BACKLOG) continue;
+        InputState extra = NextClientInput(&clients[c]);
+        ApplyInput(server, c, &extra);
+    }
+
+    InputState input = clients[0].connected ? NextClientInput(&clients[0]) : (InputState){ 0 };
+    StepSimulation(&server->sim, &input);
+
+    // Everyone else moves and chops after slot 0, like bots do after the player
+    for (int c = 1; c < NET_MAX_CLIENTS; c++) {
+        if (!clients[c].connected) continue;
+        input = NextClientInput(&clients[c]);
+        ApplyInput(server, c, &input);
+    }
+}
+
+// The world as this client should see it: every player, the problem, and
+// the trees and rocks around its own player
+static void BuildView(NetServer* server, int slot) {
+    Simulation* sim = &server->sim;
+    NetView* view = &server->current;
+    ClearNetView(view, sim->treeCount);
+    view->problem = sim->gameState.currentProblem;
+    for (int c = 0; c < NET_MAX_CLIENTS; c++) {
+        if (server->clients[c].connected) view->players[c] = QuantizePlayer(ClientPlayer(server, c), *ClientScore(server, c));
+    }
+
+    Vector3 center = ClientPlayer(server, slot)->position;
+    int count = QueryTreesInRadius(sim->trees, &sim->treeGrid, center, NET_INTEREST_RADIUS,
+                                   sim->queryResults, sim->treeCount);
+    for (int k = 0; k < count; k++) {
+        int i = sim->queryResults[k];
+        view->trees[i] = QuantizeTree(&sim->trees[i], true);
+    }
+
+    for (int c = 0; c < CHUNK_POOL_SIZE; c++) {
+        const Chunk* chunk = &sim->chunks.chunks[c];
+        if (chunk->state != CHUNK_LOADED) continue;
+        for (int r = 0; r < chunk->layout.rockCount; r++) {
+            Vector3 rock = chunk->layout.rocks[r];
+            float dx = rock.x - center.x;
+            float dz = rock.z - center.z;
+            if (dx * dx + dz * dz > NET_INTEREST_RADIUS * NET_INTEREST_RADIUS) continue;
+            view->rocks[c * CHUNK_MAX_ROCKS + r] = QuantizeRock(rock);
+        }
+    }
+}
+
+static void SendSnapshot(NetServer* server, int slot, double now) {
+    NetServerClient* client = &server->clients[slot];
+    uint32_t sequence = client->snapshotSequence + 1;
+    const NetView* base = &server->empty;
+    if (client->ackedSnapshot != 0 && sequence - client->ackedSnapshot < NET_VIEW_HISTORY) {
+        base = &client->views[client->ackedSnapshot % NET_VIEW_HISTORY];
+    }
+
+    const Player* player = ClientPlayer(server, slot);
+    NetSnapshotHeader header = {
+        .sequence = sequence,
+        .baseSequence = base->sequence,
+        .ackInput = client->lastApplied,
+        .serverTick = server->sim.tick,
+        .position = player->position,
+        .rotationY = player->rotationY,
+        .isMoving = player->isMoving
+    };
+    BuildView(server, slot);
+    NetWriter writer = { server->packet, NET_MAX_PACKET, 0, false };
+    EncodeSnapshot(&writer, &header, base, &server->current, &client->views[sequence % NET_VIEW_HISTORY],
+                   server->sim.treeCount);
+    if (writer.overflow) return;
+
+    client->snapshotSequence = sequence;
+    SendToClient(server, client->address, &writer, now);
+    server->snapshotBytes += (unsigned long long)writer.size;
+    server->snapshotCount++;
+}
+
+void ServerTick(NetServer* server, double now) {
+    ReceivePackets(server, now);
+    for (int c = 0; c < NET_MAX_CLIENTS; c++) {
+        if (server->clients[c].connected && now - server->clients[c].lastHeard > NET_TIMEOUT_SECONDS) {
+            Disconnect(server, c, "timed out");
+        }
+    }
+
+    double start = GetMonotonicSeconds();
+    StepPlayers(server);
+    int connected = ConnectedClientCount(server);
+    if (server->sim.tick % NET_SNAPSHOT_INTERVAL == 0) {
+        for (int c = 0; c < NET_MAX_CLIENTS; c++) {
+            if (server->clients[c].connected) SendSnapshot(server, c, now);
+        }
+    }
+    server->tickSeconds += GetMonotonicSeconds() - start;
+    server->ticks++;
+    server->clientTicks += (unsigned long long)connected;
+
+    FlushNetSocket(&server->socket, now);
+}
+
+int RunServer(const SimulationConfig* config, uint16_t port, const NetShimConfig* shim, unsigned int ticks) {
+    NetServer* server = malloc(sizeof(NetServer));
+    if (server == NULL || !InitNetServer(server, config, port, shim)) {
+        LOGE(LOG_CAT_NET, "Failed to start the server on port %u", port);
+        free(server);
+        return 1;
+    }
+    LOGI(LOG_CAT_NET, "Serving on port %u at %d Hz, seed %u, %d trees per chunk, for %u ticks",
+         server->socket.port, server->sim.tickRate, config->seed, server->sim.chunks.treesPerChunk, ticks);
+
+    // Ticks are paced against the start time, so a slow one is caught up
+    // on rather than pushing every later tick back
+    double start = GetMonotonicSeconds();
+    double tickLength = 1.0 / server->sim.tickRate;
+    for (unsigned int tick = 0; tick < ticks; tick++) {
+        double due = start + tick * tickLength;
+        double now = GetMonotonicSeconds();
+        if (due > now) SleepSeconds(due - now);
+        ServerTick(server, GetMonotonicSeconds());
+    }
+
+    for (int c = 0; c < NET_MAX_CLIENTS; c++) {
+        if (!server->clients[c].connected) continue;
+        uint8_t bye = NET_MSG_BYE;
+        NetSend(&server->socket, server->clients[c].address, &bye, 1, GetMonotonicSeconds());
+    }
+    FlushNetSocket(&server->socket, INFINITY);
+
+    LOGI(LOG_CAT_PERF, "Server: %u ticks, %.3f ms per tick, %u snapshots, %.1f bytes per tick per client",
+         server->ticks, (server->ticks > 0) ? server->tickSeconds * 1000.0 / server->ticks : 0.0,
+         server->snapshotCount, ServerBytesPerClientTick(server));
+    LOGI(LOG_CAT_PERF, "Server socket: %llu bytes sent, %llu received, %u of %u packets dropped by the shim",
+         server->socket.bytesSent, server->socket.bytesReceived, server->socket.packetsDropped, server->socket.packetsSent);
+    FreeNetServer(server);
+    free(server);
+    return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "game.h"
+#include "net_protocol.h"
+
+#define NET_INPUT_WAIT_TICKS 4    // Ticks a missing input is waited for once later ones have arrived
+#define NET_INPUT_BACKLOG 2       // Inputs a client may have queued before the server catches up
+
+// One connected client. Slot 0 is the simulation's own player (the world
+// streams and problems are labeled around it); the others are stepped by
+// the server next to it, the way bots are.
+typedef struct {
+    bool connected;
+    NetAddress address;
+    double lastHeard;
+    Player player;        // Unused for slot 0, which is sim.player
+    int score;            // Likewise sim.gameState.score
+    uint16_t inputs[NET_INPUT_HISTORY];       // Packed inputs by sequence
+    uint32_t inputSequences[NET_INPUT_HISTORY]; // Which sequence each entry holds
+    uint32_t lastApplied; // Acked back to the client in every snapshot
+    uint32_t newestInput;
+    int waitTicks;        // Spent waiting for the input after lastApplied
+    NetView* views;       // NET_VIEW_HISTORY snapshots as sent, by sequence; allocated on first connect
+    uint32_t snapshotSequence; // Last one sent
+    uint32_t ackedSnapshot;    // Newest one the client has, the delta base
+} NetServerClient;
+
+typedef struct {
+    Simulation sim;
+    NetSocket socket;
+    NetServerClient clients[NET_MAX_CLIENTS];
+    NetView empty;        // Base for clients that haven't acked anything yet
+    NetView current;      // What one client should see this tick
+    uint8_t packet[NET_MAX_PACKET];
+    double tickSeconds;   // Stepping and snapshots, summed over ticks
+    unsigned int ticks;
+    unsigned long long clientTicks;   // Ticks times the clients connected during them
+    unsigned long long snapshotBytes;
+    unsigned int snapshotCount;
+} NetServer;
+
+// Open the server's socket and start its world. The simulation runs with
+// the config as given, except that trees per chunk are capped at
+// NET_MAX_TREES_PER_CHUNK and there are no bots.
+bool InitNetServer(NetServer* server, const SimulationConfig* config, uint16_t port, const NetShimConfig* shim);
+void FreeNetServer(NetServer* server);
+
+// Take in what arrived, step every player and the world once, then send
+// snapshots on snapshot ticks. now is in seconds, on any clock.
+void ServerTick(NetServer* server, double now);
+
+int ConnectedClientCount(const NetServer* server);
+// Snapshot bytes per tick per connected client, over the whole run
+double ServerBytesPerClientTick(const NetServer* server);
+
+// Serve in real time for the given number of ticks, then report traffic
+// and tick cost. Returns the process exit code.
+int RunServer(const SimulationConfig* config, uint16_t port, const NetShimConfig* shim, unsigned int ticks);
+
+#endif // SERVER_H
@@ -0,0 +1,59 @@
+#include "raylib.h"
+#include "raymath.h"
+#include "socket_cache.h"
+#include "game.h"
+#include "timer.h"
+#include <stdlib.h>
+
+bool BuildSocketCache(SocketCache* cache, Model model, const ModelAnimation* animations, int animationCount,
+                      const int socketBones[SOCKET_COUNT]) {
+    *cache = (SocketCache){ 0 };
+    if (animationCount <= 0) return true;
+    
+    double start = GetMonotonicSeconds();
+    
+    int totalFrames = 0;
+    for (int a = 0; a < animationCount; a++) totalFrames += animations[a].frameCount;
+    
+    cache->firstFrame = malloc(sizeof(int) * animationCount);
+    cache->frameCount = malloc(sizeof(int) * animationCount);
+    cache->matrices = malloc(sizeof(Matrix) * SOCKET_COUNT * (totalFrames > 0 ? totalFrames : 1));
+    if (!cache->firstFrame || !cache->frameCount || !cache->matrices) {
+        FreeSocketCache(cache);
+        return false;
+    }
+    cache->animationCount = animationCount;
+    
+    int row = 0;
+    for (int a = 0; a < animationCount; a++) {
+        cache->firstFrame[a] = row;
+        cache->frameCount[a] = animations[a].frameCount;
+        for (int f = 0; f < animations[a].frameCount; f++, row++) {
+            for (int s = 0; s < SOCKET_COUNT; s++) {
+                // Identity model transform: the character transform is applied per draw
+                cache->matrices[row * SOCKET_COUNT + s] = GetSocketTransform(model, animations[a], f, socketBones[s], MatrixIdentity());
+            }
+        }
+    }
+    
+    cache->bytes = sizeof(Matrix) * SOCKET_COUNT * totalFrames + sizeof(int) * 2 * animationCount;
+    cache->buildSeconds = GetMonotonicSeconds() - start;
+    return true;
+}
+
+void FreeSocketCache(SocketCache* cache) {
+    free(cache->firstFrame);
+    free(cache->frameCount);
+    free(cache->matrices);
+    *cache = (SocketCache){ 0 };
+}
+
+Matrix GetCachedSocketTransform(const SocketCache* cache, int animation, int frame, SocketSlot socket, Matrix characterTransform) {
+    if (animation < 0 || animation >= cache->animationCount ||
+        frame < 0 || frame >= cache->frameCount[animation]) {
+        return characterTransform;
+    }
+    
+    const Matrix* local = &cache->matrices[(cache->firstFrame[animation] + frame) * SOCKET_COUNT + socket];
+    return MatrixMultiply(*local, characterTransform);
+}
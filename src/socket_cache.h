@@ -0,0 +1,34 @@
+#ifndef SOCKET_CACHE_H
+#define SOCKET_CACHE_H
+
+#include "raylib.h"
+#include <stddef.h>
+
+typedef enum {
+    SOCKET_HAT = 0,
+    SOCKET_HAND_RIGHT,
+    SOCKET_HAND_LEFT,
+    SOCKET_COUNT
+} SocketSlot;
+
+// Socket-local attachment matrices for every frame of every animation,
+// baked once at load with GetSocketTransform. Drawing an attachment is then
+// one lookup plus one multiply by the character transform.
+typedef struct {
+    int animationCount;
+    int* firstFrame;      // Per animation: its first row in matrices
+    int* frameCount;      // Per animation
+    Matrix* matrices;     // One row of SOCKET_COUNT matrices per frame
+    double buildSeconds;
+    size_t bytes;
+} SocketCache;
+
+// socketBones[slot] is the bone index from FindBoneSocket, -1 if missing
+bool BuildSocketCache(SocketCache* cache, Model model, const ModelAnimation* animations, int animationCount,
+                      const int socketBones[SOCKET_COUNT]);
+void FreeSocketCache(SocketCache* cache);
+
+// World transform for an attachment on this socket in this frame
+Matrix GetCachedSocketTransform(const SocketCache* cache, int animation, int frame, SocketSlot socket, Matrix characterTransform);
+
+#endif // SOCKET_CACHE_H
@@ -0,0 +1,237 @@
+#include "raylib.h"
+#include "raymath.h"
+#include "static_scene.h"
+#include "logger.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define GRID_SPACING 1.0f
+#define GRID_LINES_PER_CHUNK ((int)(CHUNK_SIZE / GRID_SPACING))  // Each way; the far edge is the neighbour's
+#define CHUNK_QUADS (1 + 2 * GRID_LINES_PER_CHUNK)               // Ground and grid, rocks come on top
+
+static const Vector3 rockSize = { 0.8f, 0.6f, 0.8f };
+
+// Fills a preallocated mesh one quad at a time
+typedef struct {
+    Mesh* mesh;
+    int vertex;
+    int triangle;
+} MeshBuilder;
+
+// Quad from corner along u then v; u x v is its front face
+static void AddQuad(MeshBuilder* builder, Vector3 corner, Vector3 u, Vector3 v, Color color) {
+    Mesh* mesh = builder->mesh;
+    Vector3 points[4] = { corner, Vector3Add(corner, u), Vector3Add(Vector3Add(corner, u), v), Vector3Add(corner, v) };
+    int first = builder->vertex;
+
+    for (int i = 0; i < 4; i++) {
+        int n = first + i;
+        mesh->vertices[n * 3] = points[i].x;
+        mesh->vertices[n * 3 + 1] = points[i].y;
+        mesh->vertices[n * 3 + 2] = points[i].z;
+        mesh->colors[n * 4] = color.r;
+        mesh->colors[n * 4 + 1] = color.g;
+        mesh->colors[n * 4 + 2] = color.b;
+        mesh->colors[n * 4 + 3] = color.a;
+    }
+
+    unsigned short* indices = &mesh->indices[builder->triangle * 3];
+    indices[0] = (unsigned short)first;
+    indices[1] = (unsigned short)(first + 1);
+    indices[2] = (unsigned short)(first + 2);
+    indices[3] = (unsigned short)first;
+    indices[4] = (unsigned short)(first + 2);
+    indices[5] = (unsigned short)(first + 3);
+
+    builder->vertex += 4;
+    builder->triangle += 2;
+}
+
+// The six outward-facing sides of an axis-aligned box, like DrawCube
+static void AddBox(MeshBuilder* builder, Vector3 center, Vector3 size, Color color) {
+    Vector3 e = Vector3Scale(size, 0.5f);
+    Vector3 low = Vector3Subtract(center, e);
+    Vector3 x = { size.x, 0.0f, 0.0f };
+    Vector3 y = { 0.0f, size.y, 0.0f };
+    Vector3 z = { 0.0f, 0.0f, size.z };
+
+    AddQuad(builder, (Vector3){ low.x, low.y + size.y, low.z }, z, x, color);   // +Y
+    AddQuad(builder, low, x, z, color);                                         // -Y
+    AddQuad(builder, (Vector3){ low.x + size.x, low.y, low.z }, y, z, color);   // +X
+    AddQuad(builder, low, z, y, color);                                         // -X
+    AddQuad(builder, (Vector3){ low.x, low.y, low.z + size.z }, x, y, color);   // +Z
+    AddQuad(builder, low, y, x, color);                                         // -Z
+}
+
+// Grid line color: the world's axes darker, like DrawGrid's center lines
+static Color GridLineColor(float coordinate) {
+    return (fabsf(coordinate) < GRID_SPACING * 0.5f) ? (Color){ 128, 128, 128, 255 } : (Color){ 191, 191, 191, 255 };
+}
+
+static int ChunkQuads(const ChunkLayout* chunk) {
+    return CHUNK_QUADS + 6 * chunk->rockCount;
+}
+
+// One mesh over chunks [begin, end), quadCount quads in all
+static bool BakeMesh(Mesh* out, const FrameSnapshot* frame, int begin, int end, int quadCount) {
+    Mesh mesh = { 0 };
+    mesh.vertexCount = quadCount * 4;
+    mesh.triangleCount = quadCount * 2;
+    mesh.vertices = calloc(mesh.vertexCount * 3 + 1, sizeof(float));
+    mesh.colors = calloc(mesh.vertexCount * 4 + 1, sizeof(unsigned char));
+    mesh.indices = calloc(mesh.triangleCount * 3 + 1, sizeof(unsigned short));
+    if (!mesh.vertices || !mesh.colors || !mesh.indices) {
+        free(mesh.vertices);
+        free(mesh.colors);
+        free(mesh.indices);
+        return false;
+    }
+
+    MeshBuilder builder = { &mesh, 0, 0 };
+    float w = GRID_LINE_WIDTH;
+    for (int c = begin; c < end; c++) {
+        const ChunkLayout* chunk = &frame->chunks[c];
+        float minX = (chunk->x - 0.5f) * CHUNK_SIZE;
+        float minZ = (chunk->z - 0.5f) * CHUNK_SIZE;
+        AddQuad(&builder, (Vector3){ minX, 0.0f, minZ }, (Vector3){ 0.0f, 0.0f, CHUNK_SIZE }, (Vector3){ CHUNK_SIZE, 0.0f, 0.0f }, chunk->ground);
+
+        for (int i = 0; i < GRID_LINES_PER_CHUNK; i++) {
+            float x = minX + i * GRID_SPACING;
+            float z = minZ + i * GRID_SPACING;
+            AddQuad(&builder, (Vector3){ minX, GRID_LINE_HEIGHT, z - w * 0.5f },
+                    (Vector3){ 0.0f, 0.0f, w }, (Vector3){ CHUNK_SIZE, 0.0f, 0.0f }, GridLineColor(z));
+            AddQuad(&builder, (Vector3){ x - w * 0.5f, GRID_LINE_HEIGHT, minZ },
+                    (Vector3){ 0.0f, 0.0f, CHUNK_SIZE }, (Vector3){ w, 0.0f, 0.0f }, GridLineColor(x));
+        }
+
+        for (int r = 0; r < chunk->rockCount; r++) {
+            AddBox(&builder, chunk->rocks[r], rockSize, GRAY);
+        }
+    }
+
+    UploadMesh(&mesh, false);
+    *out = mesh;
+    return true;
+}
+
+// As few meshes as the index limit allows, filled chunk by chunk. False if
+// memory ran out, or a single chunk is past the limit by itself.
+static bool BakeStaticMeshes(StaticScene* scene, const FrameSnapshot* frame) {
+    int begin = 0;
+    while (begin < frame->chunkCount) {
+        int end = begin;
+        int quadCount = 0;
+        while (end < frame->chunkCount && (quadCount + ChunkQuads(&frame->chunks[end])) * 4 <= STATIC_MESH_MAX_VERTICES) {
+            quadCount += ChunkQuads(&frame->chunks[end]);
+            end++;
+        }
+        if (end == begin) {
+            LOGW(LOG_CAT_RENDER, "A chunk needs %d vertices, more than one mesh can index", ChunkQuads(&frame->chunks[begin]) * 4);
+            return false;
+        }
+        if (!BakeMesh(&scene->meshes[scene->meshCount], frame, begin, end, quadCount)) {
+            LOGW(LOG_CAT_RENDER, "Not enough memory to bake the static scene");
+            return false;
+        }
+        scene->meshCount++;
+        begin = end;
+    }
+    return true;
+}
+
+static void UnloadStaticMeshes(StaticScene* scene) {
+    for (int m = 0; m < scene->meshCount; m++) UnloadMesh(scene->meshes[m]);
+    scene->meshCount = 0;
+}
+
+// What raylib's batch would stream for the same chunks
+static StaticSceneStats ImmediateStats(const FrameSnapshot* frame) {
+    StaticSceneStats stats = { 0 };
+    for (int c = 0; c < frame->chunkCount; c++) {
+        stats.streamedVertices += 4 + GRID_LINES_PER_CHUNK * 4 + frame->chunks[c].rockCount * 36;
+    }
+    // One draw per primitive type: the planes' quads, the grid's lines and
+    // the rocks' triangles
+    stats.drawCalls = (frame->chunkCount > 0) ? 3 : 0;
+    stats.drawnVertices = stats.streamedVertices;
+    return stats;
+}
+
+void InitStaticScene(StaticScene* scene, bool bake) {
+    *scene = (StaticScene){ 0 };
+    if (!bake) return;
+    scene->material = LoadMaterialDefault();
+    scene->baked = true;
+    scene->builtVersion = 0; // Bakes on the first draw
+}
+
+void UnloadStaticScene(StaticScene* scene) {
+    if (scene->baked) {
+        UnloadStaticMeshes(scene);
+        UnloadMaterial(scene->material);
+    }
+    *scene = (StaticScene){ 0 };
+}
+
+static void DrawStaticSceneImmediate(const FrameSnapshot* frame) {
+    for (int c = 0; c < frame->chunkCount; c++) {
+        const ChunkLayout* chunk = &frame->chunks[c];
+        Vector3 center = { chunk->x * CHUNK_SIZE, 0.0f, chunk->z * CHUNK_SIZE };
+        DrawPlane(center, (Vector2){ CHUNK_SIZE, CHUNK_SIZE }, chunk->ground);
+    }
+    for (int c = 0; c < frame->chunkCount; c++) {
+        const ChunkLayout* chunk = &frame->chunks[c];
+        float minX = (chunk->x - 0.5f) * CHUNK_SIZE;
+        float minZ = (chunk->z - 0.5f) * CHUNK_SIZE;
+        for (int i = 0; i < GRID_LINES_PER_CHUNK; i++) {
+            float x = minX + i * GRID_SPACING;
+            float z = minZ + i * GRID_SPACING;
+            DrawLine3D((Vector3){ minX, 0.0f, z }, (Vector3){ minX + CHUNK_SIZE, 0.0f, z }, GridLineColor(z));
+            DrawLine3D((Vector3){ x, 0.0f, minZ }, (Vector3){ x, 0.0f, minZ + CHUNK_SIZE }, GridLineColor(x));
+        }
+    }
+    for (int c = 0; c < frame->chunkCount; c++) {
+        const ChunkLayout* chunk = &frame->chunks[c];
+        for (int r = 0; r < chunk->rockCount; r++) {
+            DrawCube(chunk->rocks[r], rockSize.x, rockSize.y, rockSize.z, GRAY);
+        }
+    }
+}
+
+void DrawStaticScene(StaticScene* scene, const FrameSnapshot* frame) {
+    if (scene->baked && scene->builtVersion != frame->layoutVersion) {
+        UnloadStaticMeshes(scene);
+
+        scene->immediateStats = ImmediateStats(frame);
+        if (BakeStaticMeshes(scene, frame)) {
+            scene->builtVersion = frame->layoutVersion;
+            int vertices = 0, triangles = 0;
+            for (int m = 0; m < scene->meshCount; m++) {
+                vertices += scene->meshes[m].vertexCount;
+                triangles += scene->meshes[m].triangleCount;
+            }
+            LOGI(LOG_CAT_RENDER, "Baked static scene: %d vertices, %d triangles in %d draw calls (immediate: %d vertices in %d draw calls per frame)",
+                 vertices, triangles, scene->meshCount,
+                 scene->immediateStats.streamedVertices, scene->immediateStats.drawCalls);
+        } else {
+            LOGW(LOG_CAT_RENDER, "Drawing the static scene immediately");
+            UnloadStaticMeshes(scene);
+            UnloadMaterial(scene->material);
+            scene->baked = false;
+        }
+    }
+
+    if (!scene->baked) {
+        DrawStaticSceneImmediate(frame);
+        scene->immediateStats = ImmediateStats(frame);
+        scene->stats = scene->immediateStats;
+        return;
+    }
+
+    scene->stats = (StaticSceneStats){ 0 };
+    for (int m = 0; m < scene->meshCount; m++) {
+        DrawMesh(scene->meshes[m], scene->material, MatrixIdentity());
+        scene->stats.drawCalls++;
+        scene->stats.drawnVertices += scene->meshes[m].vertexCount;
+    }
+}
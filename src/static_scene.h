@@ -0,0 +1,41 @@
+#ifndef STATIC_SCENE_H
+#define STATIC_SCENE_H
+
+#include "raylib.h"
+#include "frame_pipeline.h"
+
+#define GRID_LINE_WIDTH 0.03f     // Grid lines are baked as thin quads
+#define GRID_LINE_HEIGHT 0.01f    // Just above the ground to avoid z-fighting
+#define STATIC_MESH_MAX_VERTICES 65535  // Mesh indices are 16-bit
+
+// What the static scene costs per frame
+typedef struct {
+    int drawCalls;
+    int streamedVertices;     // Vertices sent from the CPU this frame
+    int drawnVertices;        // Vertices the GPU processes
+} StaticSceneStats;
+
+// Ground, grid and rocks of the loaded chunks only change when a chunk
+// streams in or out, so they are merged into vertex-colored meshes and
+// drawn with one call each: a single mesh unless the chunks need more
+// vertices than 16-bit indices reach, in which case they're split between
+// chunks. The meshes are rebaked when the simulation's layoutVersion
+// changes. Without baking (the immediate path) they are re-emitted
+// through raylib's batch every frame as before.
+typedef struct {
+    bool baked;
+    Mesh meshes[CHUNK_POOL_SIZE]; // At least one chunk each
+    int meshCount;
+    Material material;
+    unsigned int builtVersion;
+    StaticSceneStats stats;
+    StaticSceneStats immediateStats;  // What the immediate path costs, for comparison
+} StaticScene;
+
+void InitStaticScene(StaticScene* scene, bool bake);
+void UnloadStaticScene(StaticScene* scene);
+
+// Call inside BeginMode3D
+void DrawStaticScene(StaticScene* scene, const FrameSnapshot* frame);
+
+#endif // STATIC_SCENE_H
@@ -0,0 +1,11 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+// Seconds from a monotonic clock; only differences are meaningful.
+// Works without a window, unlike raylib's GetTime().
+double GetMonotonicSeconds(void);
+
+// Block the calling thread, also without a window (unlike raylib's WaitTime)
+void SleepSeconds(double seconds);
+
+#endif // TIMER_H
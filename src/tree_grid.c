@@ -0,0 +1,148 @@
+#include "raylib.h"
+#include "tree_grid.h"
+#include <math.h>
+#include <stdlib.h>
+
+static int CellCoord(const TreeGrid* grid, float value) {
+    return (int)floorf(value / grid->cellSize);
+}
+
+static int BucketIndex(const TreeGrid* grid, int cellX, int cellZ) {
+    unsigned int hash = ((unsigned int)cellX * 73856093u) ^ ((unsigned int)cellZ * 19349663u);
+    return (int)(hash & (unsigned int)grid->bucketMask);
+}
+
+bool InitTreeGrid(TreeGrid* grid, int capacity, float cellSize) {
+    *grid = (TreeGrid){ 0 };
+    grid->cellSize = cellSize;
+    grid->capacity = capacity;
+
+    // About two buckets per tree keeps chains short even when cells are sparse
+    int bucketCount = 64;
+    while (bucketCount < capacity * 2) bucketCount *= 2;
+    grid->bucketMask = bucketCount - 1;
+
+    grid->bucketHeads = malloc(sizeof(int) * bucketCount);
+    grid->next = malloc(sizeof(int) * capacity);
+    grid->prev = malloc(sizeof(int) * capacity);
+    grid->cellX = malloc(sizeof(int) * capacity);
+    grid->cellZ = malloc(sizeof(int) * capacity);
+    grid->inserted = calloc(capacity, sizeof(bool));
+    if (!grid->bucketHeads || !grid->next || !grid->prev || !grid->cellX || !grid->cellZ || !grid->inserted) {
+        FreeTreeGrid(grid);
+        return false;
+    }
+
+    for (int i = 0; i < bucketCount; i++) grid->bucketHeads[i] = -1;
+    return true;
+}
+
+void FreeTreeGrid(TreeGrid* grid) {
+    free(grid->bucketHeads);
+    free(grid->next);
+    free(grid->prev);
+    free(grid->cellX);
+    free(grid->cellZ);
+    free(grid->inserted);
+    *grid = (TreeGrid){ 0 };
+}
+
+void TreeGridInsert(TreeGrid* grid, int treeIndex, Vector3 position) {
+    if (treeIndex < 0 || treeIndex >= grid->capacity || grid->inserted[treeIndex]) return;
+
+    int cellX = CellCoord(grid, position.x);
+    int cellZ = CellCoord(grid, position.z);
+    int bucket = BucketIndex(grid, cellX, cellZ);
+
+    grid->cellX[treeIndex] = cellX;
+    grid->cellZ[treeIndex] = cellZ;
+    grid->prev[treeIndex] = -1;
+    grid->next[treeIndex] = grid->bucketHeads[bucket];
+    if (grid->bucketHeads[bucket] >= 0) grid->prev[grid->bucketHeads[bucket]] = treeIndex;
+    grid->bucketHeads[bucket] = treeIndex;
+    grid->inserted[treeIndex] = true;
+}
+
+void TreeGridRemove(TreeGrid* grid, int treeIndex) {
+    if (treeIndex < 0 || treeIndex >= grid->capacity || !grid->inserted[treeIndex]) return;
+
+    int prev = grid->prev[treeIndex];
+    int next = grid->next[treeIndex];
+    if (prev >= 0) {
+        grid->next[prev] = next;
+    } else {
+        grid->bucketHeads[BucketIndex(grid, grid->cellX[treeIndex], grid->cellZ[treeIndex])] = next;
+    }
+    if (next >= 0) grid->prev[next] = prev;
+    grid->inserted[treeIndex] = false;
+}
+
+void TreeGridMove(TreeGrid* grid, int treeIndex, Vector3 position) {
+    if (treeIndex < 0 || treeIndex >= grid->capacity) return;
+
+    // Staying in the same cell needs no relinking
+    if (grid->inserted[treeIndex] &&
+        grid->cellX[treeIndex] == CellCoord(grid, position.x) &&
+        grid->cellZ[treeIndex] == CellCoord(grid, position.z)) {
+        return;
+    }
+
+    TreeGridRemove(grid, treeIndex);
+    TreeGridInsert(grid, treeIndex, position);
+}
+
+int TreeGridQueryRect(const TreeGrid* grid, float minX, float minZ, float maxX, float maxZ,
+                      int* results, int maxResults) {
+    int count = 0;
+    int startX = CellCoord(grid, minX);
+    int startZ = CellCoord(grid, minZ);
+    int endX = CellCoord(grid, maxX);
+    int endZ = CellCoord(grid, maxZ);
+
+    for (int cellZ = startZ; cellZ <= endZ; cellZ++) {
+        for (int cellX = startX; cellX <= endX; cellX++) {
+            int tree = grid->bucketHeads[BucketIndex(grid, cellX, cellZ)];
+            while (tree >= 0) {
+                // Skip trees from other cells that hashed into the same bucket
+                if (grid->cellX[tree] == cellX && grid->cellZ[tree] == cellZ) {
+                    if (count >= maxResults) return count;
+                    results[count++] = tree;
+                }
+                tree = grid->next[tree];
+            }
+        }
+    }
+
+    return count;
+}
+
+int TreeGridEntries(const TreeGrid* grid, TreeGridEntry* entries, int maxEntries) {
+    int count = 0;
+    for (int bucket = 0; bucket <= grid->bucketMask; bucket++) {
+        for (int tree = grid->bucketHeads[bucket]; tree >= 0; tree = grid->next[tree]) {
+            if (count >= maxEntries) return count;
+            entries[count++] = (TreeGridEntry){ tree, grid->cellX[tree], grid->cellZ[tree] };
+        }
+    }
+    return count;
+}
+
+void TreeGridRestore(TreeGrid* grid, const TreeGridEntry* entries, int count) {
+    for (int bucket = 0; bucket <= grid->bucketMask; bucket++) grid->bucketHeads[bucket] = -1;
+    for (int i = 0; i < grid->capacity; i++) grid->inserted[i] = false;
+
+    // Linking pushes onto the head, so going backwards rebuilds each chain
+    // in its saved order
+    for (int e = count - 1; e >= 0; e--) {
+        int tree = entries[e].index;
+        if (tree < 0 || tree >= grid->capacity || grid->inserted[tree]) continue;
+        int bucket = BucketIndex(grid, entries[e].cellX, entries[e].cellZ);
+        grid->cellX[tree] = entries[e].cellX;
+        grid->cellZ[tree] = entries[e].cellZ;
+        grid->prev[tree] = -1;
+        grid->next[tree] = grid->bucketHeads[bucket];
+        if (grid->bucketHeads[bucket] >= 0) grid->prev[grid->bucketHeads[bucket]] = tree;
+        grid->bucketHeads[bucket] = tree;
+        grid->inserted[tree] = true;
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef TREE_GRID_H
+#define TREE_GRID_H
+
+#include "raylib.h"
+
+// One inserted tree and its cell, for saving a grid exactly
+typedef struct {
+    int index;
+    int cellX;
+    int cellZ;
+} TreeGridEntry;
+
+// Uniform grid over the XZ plane, hashed into a fixed bucket table so the
+// world doesn't need bounds. Each tree sits in exactly one cell; buckets are
+// intrusive doubly linked lists over tree indices so moving a tree is O(1).
+typedef struct {
+    float cellSize;
+    int capacity;         // Max tree index + 1
+    int bucketMask;       // Bucket count - 1 (power of two)
+    int* bucketHeads;     // First tree in each bucket, -1 if empty
+    int* next;            // Per tree: next tree in the same bucket
+    int* prev;            // Per tree: previous tree in the same bucket
+    int* cellX;           // Per tree: cell coordinates, used to filter hash collisions
+    int* cellZ;
+    bool* inserted;       // Per tree: currently in the grid
+} TreeGrid;
+
+bool InitTreeGrid(TreeGrid* grid, int capacity, float cellSize);
+void FreeTreeGrid(TreeGrid* grid);
+
+void TreeGridInsert(TreeGrid* grid, int treeIndex, Vector3 position);
+void TreeGridRemove(TreeGrid* grid, int treeIndex);
+void TreeGridMove(TreeGrid* grid, int treeIndex, Vector3 position);
+
+// Collect trees whose cell overlaps the XZ rectangle [minX, maxX] x [minZ, maxZ].
+// Candidates are not distance tested; callers do their own exact checks.
+// Returns the number of indices written (never more than maxResults).
+int TreeGridQueryRect(const TreeGrid* grid, float minX, float minZ, float maxX, float maxZ,
+                      int* results, int maxResults);
+
+// Every inserted tree, bucket by bucket in chain order. Queries hand out
+// candidates in chain order, so a grid restored from these answers every
+// query exactly like the one saved. Returns the number written.
+int TreeGridEntries(const TreeGrid* grid, TreeGridEntry* entries, int maxEntries);
+// Empty the grid, then relink those entries into the same chains
+void TreeGridRestore(TreeGrid* grid, const TreeGridEntry* entries, int count);
+
+#endif // TREE_GRID_H
@@ -0,0 +1,194 @@
+#include "raylib.h"
+#include "tree_soa.h"
+#include "chop.h"
+#include <stdlib.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define TREE_SOA_AVX2
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define TREE_SOA_SSE2
+#endif
+
+// The wide test runs without sqrtf, so its rounding differs from the exact
+// test by a few ulps. Widening both thresholds slightly keeps it a strict
+// superset of the exact test; the exact test then makes the final call.
+#define RANGE_MARGIN 1.00001f
+#define CONE_MARGIN 0.99998f
+
+bool InitTreeSoA(TreeSoA* store, int capacity) {
+    *store = (TreeSoA){ 0 };
+    int padded = ((capacity > 0 ? capacity : 1) + 7) & ~7;
+    int words = (padded + 31) / 32;
+
+    store->x = calloc(padded, sizeof(float));
+    store->z = calloc(padded, sizeof(float));
+    store->exists = calloc(words, sizeof(uint32_t));
+    store->answer = calloc(padded, sizeof(int));
+    if (!store->x || !store->z || !store->exists || !store->answer) {
+        FreeTreeSoA(store);
+        return false;
+    }
+
+    store->capacity = padded;
+    return true;
+}
+
+void FreeTreeSoA(TreeSoA* store) {
+    free(store->x);
+    free(store->z);
+    free(store->exists);
+    free(store->answer);
+    *store = (TreeSoA){ 0 };
+}
+
+void TreeSoASet(TreeSoA* store, int index, Vector3 position, bool exists, int answer) {
+    if (index < 0 || index >= store->capacity) return;
+
+    store->x[index] = position.x;
+    store->z[index] = position.z;
+    store->answer[index] = answer;
+    if (exists) {
+        store->exists[index / 32] |= 1u << (index % 32);
+    } else {
+        store->exists[index / 32] &= ~(1u << (index % 32));
+    }
+    if (index >= store->count) store->count = index + 1;
+}
+
+// Exists bits for trees [base, base + 8), base a multiple of 8, with the
+// lanes outside [begin, end) cleared
+static unsigned int ExistsByte(const TreeSoA* store, int base, int begin, int end) {
+    unsigned int bits = (store->exists[base / 32] >> (base % 32)) & 0xFFu;
+    if (begin > base) bits &= 0xFFu << (begin - base);
+    if (end < base + 8) bits &= 0xFFu >> (base + 8 - end);
+    return bits & 0xFFu;
+}
+
+// Check candidates lowest index first with the exact scalar test
+static int ConfirmCandidates(const TreeSoA* store, int base, unsigned int mask, Vector3 playerPosition, Vector3 forward) {
+    while (mask != 0) {
+        int lane = __builtin_ctz(mask);
+        Vector3 treePosition = { store->x[base + lane], 0.0f, store->z[base + lane] };
+        if (IsTreeInChopRange(playerPosition, forward, treePosition)) return base + lane;
+        mask &= mask - 1;
+    }
+    return -1;
+}
+
+int TreeSoAFindChopTarget(const TreeSoA* store, Vector3 playerPosition, Vector3 forward) {
+    return TreeSoAFindChopTargetInRange(store, 0, store->count, playerPosition, forward);
+}
+
+int TreeSoAFindChopTargetInRange(const TreeSoA* store, int begin, int end, Vector3 playerPosition, Vector3 forward) {
+    if (begin < 0) begin = 0;
+    if (end > store->count) end = store->count;
+    if (begin >= end) return -1;
+
+    // Trees are at y = 0, so the player's height only adds a constant term
+    float dyTerm = playerPosition.y * playerPosition.y;
+    float rangeSqr = CHOP_RANGE * CHOP_RANGE * RANGE_MARGIN;
+    float coneSqr = CHOP_CONE_COS * CHOP_CONE_COS * CONE_MARGIN; // dot > cos * length, squared
+    int blockEnd = (end + 7) / 8;
+
+#if defined(TREE_SOA_AVX2)
+    __m256 px = _mm256_set1_ps(playerPosition.x);
+    __m256 pz = _mm256_set1_ps(playerPosition.z);
+    __m256 fx = _mm256_set1_ps(forward.x);
+    __m256 fz = _mm256_set1_ps(forward.z);
+    __m256 dy2 = _mm256_set1_ps(dyTerm);
+    __m256 range = _mm256_set1_ps(rangeSqr);
+    __m256 cone = _mm256_set1_ps(coneSqr);
+    __m256 zero = _mm256_setzero_ps();
+
+    for (int block = begin / 8; block < blockEnd; block++) {
+        int base = block * 8;
+        unsigned int exists = ExistsByte(store, base, begin, end);
+        if (exists == 0) continue;
+
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(store->x + base), px);
+        __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(store->z + base), pz);
+        __m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dz, dz)), dy2);
+        __m256 dot = _mm256_add_ps(_mm256_mul_ps(fx, dx), _mm256_mul_ps(fz, dz));
+
+        __m256 inRange = _mm256_cmp_ps(d2, range, _CMP_LE_OQ);
+        __m256 inFront = _mm256_cmp_ps(dot, zero, _CMP_GT_OQ);
+        __m256 inCone = _mm256_cmp_ps(_mm256_mul_ps(dot, dot), _mm256_mul_ps(cone, d2), _CMP_GT_OQ);
+        unsigned int mask = (unsigned int)_mm256_movemask_ps(_mm256_and_ps(inRange, _mm256_and_ps(inFront, inCone))) & exists;
+
+        if (mask != 0) {
+            int hit = ConfirmCandidates(store, base, mask, playerPosition, forward);
+            if (hit >= 0) return hit;
+        }
+    }
+#elif defined(TREE_SOA_SSE2)
+    __m128 px = _mm_set1_ps(playerPosition.x);
+    __m128 pz = _mm_set1_ps(playerPosition.z);
+    __m128 fx = _mm_set1_ps(forward.x);
+    __m128 fz = _mm_set1_ps(forward.z);
+    __m128 dy2 = _mm_set1_ps(dyTerm);
+    __m128 range = _mm_set1_ps(rangeSqr);
+    __m128 cone = _mm_set1_ps(coneSqr);
+    __m128 zero = _mm_setzero_ps();
+
+    for (int block = begin / 8; block < blockEnd; block++) {
+        int base = block * 8;
+        unsigned int exists = ExistsByte(store, base, begin, end);
+        if (exists == 0) continue;
+
+        // Two 4-wide halves make up one block of 8
+        unsigned int mask = 0;
+        for (int half = 0; half < 2; half++) {
+            __m128 dx = _mm_sub_ps(_mm_loadu_ps(store->x + base + half * 4), px);
+            __m128 dz = _mm_sub_ps(_mm_loadu_ps(store->z + base + half * 4), pz);
+            __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz)), dy2);
+            __m128 dot = _mm_add_ps(_mm_mul_ps(fx, dx), _mm_mul_ps(fz, dz));
+
+            __m128 inRange = _mm_cmple_ps(d2, range);
+            __m128 inFront = _mm_cmpgt_ps(dot, zero);
+            __m128 inCone = _mm_cmpgt_ps(_mm_mul_ps(dot, dot), _mm_mul_ps(cone, d2));
+            mask |= (unsigned int)_mm_movemask_ps(_mm_and_ps(inRange, _mm_and_ps(inFront, inCone))) << (half * 4);
+        }
+        mask &= exists;
+
+        if (mask != 0) {
+            int hit = ConfirmCandidates(store, base, mask, playerPosition, forward);
+            if (hit >= 0) return hit;
+        }
+    }
+#else
+    for (int block = begin / 8; block < blockEnd; block++) {
+        int base = block * 8;
+        unsigned int exists = ExistsByte(store, base, begin, end);
+        if (exists == 0) continue;
+
+        unsigned int mask = 0;
+        for (int lane = 0; lane < 8; lane++) {
+            float dx = store->x[base + lane] - playerPosition.x;
+            float dz = store->z[base + lane] - playerPosition.z;
+            float d2 = dx * dx + dz * dz + dyTerm;
+            float dot = forward.x * dx + forward.z * dz;
+            if (d2 <= rangeSqr && dot > 0.0f && dot * dot > coneSqr * d2) mask |= 1u << lane;
+        }
+        mask &= exists;
+
+        if (mask != 0) {
+            int hit = ConfirmCandidates(store, base, mask, playerPosition, forward);
+            if (hit >= 0) return hit;
+        }
+    }
+#endif
+
+    return -1;
+}
+
+const char* TreeSoAKernelName(void) {
+#if defined(TREE_SOA_AVX2)
+    return "AVX2";
+#elif defined(TREE_SOA_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,35 @@
+#ifndef TREE_SOA_H
+#define TREE_SOA_H
+
+#include "raylib.h"
+#include <stdint.h>
+
+// Structure-of-arrays copy of the tree list laid out for the SIMD chop
+// kernel. Trees always stand on the ground, so only X and Z are stored.
+// Arrays are padded to a multiple of 8; padding slots never exist.
+typedef struct {
+    float* x;
+    float* z;
+    uint32_t* exists;     // Bitset, bit i set when tree i exists
+    int* answer;
+    int count;
+    int capacity;
+} TreeSoA;
+
+bool InitTreeSoA(TreeSoA* store, int capacity);
+void FreeTreeSoA(TreeSoA* store);
+
+void TreeSoASet(TreeSoA* store, int index, Vector3 position, bool exists, int answer);
+
+// Lowest index that passes the chop range + facing test, or -1. Evaluates 8
+// trees per step with squared distances and a squared cone test, then
+// confirms candidates with the exact scalar test so the result always
+// matches FindChopTargetLinear.
+int TreeSoAFindChopTarget(const TreeSoA* store, Vector3 playerPosition, Vector3 forward);
+// The same over trees [begin, end) only
+int TreeSoAFindChopTargetInRange(const TreeSoA* store, int begin, int end, Vector3 playerPosition, Vector3 forward);
+
+// Which kernel was compiled in ("AVX2", "SSE2" or "scalar")
+const char* TreeSoAKernelName(void);
+
+#endif // TREE_SOA_H
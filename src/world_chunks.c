@@ -0,0 +1,193 @@
+#include "raylib.h"
+#include "world_chunks.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define GROUND_TINT 10            // Per-channel variation of each chunk's ground around BEIGE
+#define ROCK_HEIGHT 0.3f          // Rocks sit half sunk, like the old fixed ones
+
+// Mix the coordinates so neighbouring chunks get unrelated streams
+static uint64_t ChunkStream(int x, int z) {
+    uint64_t h = ((uint64_t)(uint32_t)x << 32) | (uint32_t)z;
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+static int ChunkDistance(const Chunk* chunk, int x, int z) {
+    int dx = abs(chunk->layout.x - x);
+    int dz = abs(chunk->layout.z - z);
+    return (dx > dz) ? dx : dz;
+}
+
+void ChunkAt(Vector3 position, int* x, int* z) {
+    *x = (int)floorf(position.x / CHUNK_SIZE + 0.5f);
+    *z = (int)floorf(position.z / CHUNK_SIZE + 0.5f);
+}
+
+// Job: everything in a chunk from the seed and its coordinates alone. Trees
+// and rocks stay half the spacing inside the chunk's edges, so they keep
+// the spacing from the neighbours' too.
+static void GenerateChunk(void* userData, int begin, int end) {
+    (void)begin;
+    (void)end;
+    Chunk* chunk = userData;
+    ChunkLayout* layout = &chunk->layout;
+    PlacementGrid* grid = &chunk->placement;
+    int treesPerChunk = grid->capacity - CHUNK_MAX_ROCKS;
+
+    Rng rng;
+    SeedRng(&rng, chunk->seed, ChunkStream(layout->x, layout->z));
+    Vector2 center = { layout->x * CHUNK_SIZE, layout->z * CHUNK_SIZE };
+    float inset = grid->spacing * 0.5f;
+    ResetPlacementGrid(grid, center.x - CHUNK_SIZE * 0.5f + inset, center.y - CHUNK_SIZE * 0.5f + inset);
+
+    layout->ground = (Color){
+        (unsigned char)(BEIGE.r + RngRange(&rng, -GROUND_TINT, GROUND_TINT)),
+        (unsigned char)(BEIGE.g + RngRange(&rng, -GROUND_TINT, GROUND_TINT)),
+        (unsigned char)(BEIGE.b + RngRange(&rng, -GROUND_TINT, GROUND_TINT)),
+        255
+    };
+
+    layout->rockCount = 0;
+    int rocks = RngRange(&rng, 0, CHUNK_MAX_ROCKS);
+    for (int r = 0; r < rocks; r++) {
+        Vector2 point;
+        if (!FindPlacement(grid, &rng, (Vector2){ 0.0f, 0.0f }, SPAWN_CLEARANCE, &point)) break;
+        PlacementAdd(grid, treesPerChunk + layout->rockCount, point);
+        layout->rocks[layout->rockCount++] = (Vector3){ point.x, ROCK_HEIGHT, point.y };
+    }
+
+    // Grown from the middle; the spawn chunk leaves room for the player
+    bool spawn = (layout->x == 0 && layout->z == 0);
+    chunk->treeCount = PlacePoissonBatch(grid, &rng, center, spawn ? SPAWN_CLEARANCE : 0.0f,
+                                         0, treesPerChunk, chunk->treePositions);
+}
+
+bool InitChunkPool(ChunkPool* pool, int treesPerChunk, uint64_t seed, JobSystem* jobs) {
+    *pool = (ChunkPool){ 0 };
+    if (treesPerChunk < 0) treesPerChunk = 0;
+    if (treesPerChunk > MAX_TREES_PER_CHUNK) treesPerChunk = MAX_TREES_PER_CHUNK;
+    pool->treesPerChunk = treesPerChunk;
+    pool->seed = seed;
+    pool->jobs = jobs;
+
+    // Crowded chunks get a tighter spacing, with room to spare for Bridson
+    pool->spacing = (treesPerChunk > 0) ? 0.6f * CHUNK_SIZE / sqrtf((float)treesPerChunk) : TREE_SPACING;
+    if (pool->spacing > TREE_SPACING) pool->spacing = TREE_SPACING;
+
+    pool->slab = malloc(sizeof(Vector2) * CHUNK_POOL_SIZE * ((treesPerChunk > 0) ? treesPerChunk : 1));
+    if (pool->slab == NULL) return false;
+    for (int s = 0; s < CHUNK_POOL_SIZE; s++) {
+        Chunk* chunk = &pool->chunks[s];
+        chunk->treePositions = &pool->slab[s * treesPerChunk];
+        chunk->seed = seed;
+        if (!InitPlacementGrid(&chunk->placement, CHUNK_SIZE - pool->spacing, pool->spacing, WORLD_POSITION_SCALE,
+                               treesPerChunk + CHUNK_MAX_ROCKS)) {
+            FreeChunkPool(pool);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void WaitForChunk(ChunkPool* pool, Chunk* chunk) {
+    if (pool->jobs != NULL) WaitForJobs(pool->jobs, &chunk->counter);
+}
+
+void FreeChunkPool(ChunkPool* pool) {
+    for (int s = 0; s < CHUNK_POOL_SIZE; s++) {
+        WaitForChunk(pool, &pool->chunks[s]);
+        FreePlacementGrid(&pool->chunks[s].placement);
+    }
+    free(pool->slab);
+    *pool = (ChunkPool){ 0 };
+}
+
+static bool IsChunkPresent(const ChunkPool* pool, int x, int z) {
+    for (int s = 0; s < CHUNK_POOL_SIZE; s++) {
+        const Chunk* chunk = &pool->chunks[s];
+        if (chunk->state != CHUNK_FREE && chunk->layout.x == x && chunk->layout.z == z) return true;
+    }
+    return false;
+}
+
+static void StartChunkJob(ChunkPool* pool, Chunk* chunk) {
+    if (pool->jobs != NULL) SubmitJob(pool->jobs, GenerateChunk, chunk, &chunk->counter);
+    else GenerateChunk(chunk, 0, 1);
+}
+
+// Lowest free slot, so slots are handed out the same way every run
+static void RequestChunk(ChunkPool* pool, int x, int z, unsigned int readyTick) {
+    for (int s = 0; s < CHUNK_POOL_SIZE; s++) {
+        Chunk* chunk = &pool->chunks[s];
+        if (chunk->state != CHUNK_FREE) continue;
+
+        chunk->state = CHUNK_GENERATING;
+        chunk->layout = (ChunkLayout){ .x = x, .z = z };
+        chunk->treeCount = 0;
+        chunk->readyTick = readyTick;
+        pool->generated++;
+        StartChunkJob(pool, chunk);
+        return;
+    }
+}
+
+void UpdateChunkPool(ChunkPool* pool, Vector3 playerPosition, unsigned int tick, ChunkChanges* changes) {
+    changes->unloadedCount = 0;
+    changes->loadedCount = 0;
+
+    int x, z;
+    ChunkAt(playerPosition, &x, &z);
+    if (!pool->centered || x != pool->centerX || z != pool->centerZ) {
+        bool first = !pool->centered;
+        pool->centered = true;
+        pool->centerX = x;
+        pool->centerZ = z;
+
+        for (int s = 0; s < CHUNK_POOL_SIZE; s++) {
+            Chunk* chunk = &pool->chunks[s];
+            if (chunk->state == CHUNK_FREE || ChunkDistance(chunk, x, z) <= CHUNK_UNLOAD_RADIUS) continue;
+            if (chunk->state == CHUNK_LOADED) changes->unloaded[changes->unloadedCount++] = s;
+            WaitForChunk(pool, chunk);
+            chunk->state = CHUNK_FREE;
+        }
+
+        // Nearest rings first, so their jobs are the first to start
+        unsigned int readyTick = first ? tick : tick + CHUNK_GENERATION_TICKS;
+        for (int ring = 0; ring <= CHUNK_LOAD_RADIUS; ring++) {
+            for (int dz = -ring; dz <= ring; dz++) {
+                for (int dx = -ring; dx <= ring; dx++) {
+                    if (abs(dx) != ring && abs(dz) != ring) continue;
+                    if (!IsChunkPresent(pool, x + dx, z + dz)) RequestChunk(pool, x + dx, z + dz, readyTick);
+                }
+            }
+        }
+    }
+
+    for (int s = 0; s < CHUNK_POOL_SIZE; s++) {
+        Chunk* chunk = &pool->chunks[s];
+        if (chunk->state != CHUNK_GENERATING || chunk->readyTick > tick) continue;
+        WaitForChunk(pool, chunk);
+        chunk->state = CHUNK_LOADED;
+        changes->loaded[changes->loadedCount++] = s;
+    }
+}
+
+int LoadedChunkCount(const ChunkPool* pool) {
+    int count = 0;
+    for (int s = 0; s < CHUNK_POOL_SIZE; s++) {
+        if (pool->chunks[s].state == CHUNK_LOADED) count++;
+    }
+    return count;
+}
+
+void RestartChunkJobs(ChunkPool* pool) {
+    for (int s = 0; s < CHUNK_POOL_SIZE; s++) {
+        Chunk* chunk = &pool->chunks[s];
+        if (chunk->state == CHUNK_GENERATING) StartChunkJob(pool, chunk);
+    }
+}
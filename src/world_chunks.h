@@ -0,0 +1,93 @@
+#ifndef WORLD_CHUNKS_H
+#define WORLD_CHUNKS_H
+
+#include "raylib.h"
+#include "job_system.h"
+#include "placement.h"
+#include "rng.h"
+#include <stdint.h>
+
+#define CHUNK_SIZE 32.0f          // Side of a chunk; chunk (0, 0) is centered on the origin
+#define CHUNK_LOAD_RADIUS 2       // Chunks this many steps (or fewer) from the player's get streamed in...
+#define CHUNK_UNLOAD_RADIUS 3     // ...and only dropped beyond this, so pacing along a border doesn't thrash
+#define CHUNK_POOL_SIZE ((2 * CHUNK_UNLOAD_RADIUS + 1) * (2 * CHUNK_UNLOAD_RADIUS + 1))
+#define CHUNK_GENERATION_TICKS 6  // From requesting a chunk to it joining the world
+#define CHUNK_MAX_ROCKS 3
+#define MAX_TREES_PER_CHUNK 10000
+#define TREE_SPACING 6.0f         // Minimum gap between trees and rocks, shrunk for crowded chunks
+#define SPAWN_CLEARANCE 3.0f      // Kept free around the origin, where the player starts
+#define WORLD_POSITION_SCALE 64.0f  // Trees and rocks sit on a 1/64 grid, which snapshots carry exactly
+
+typedef enum {
+    CHUNK_FREE = 0,
+    CHUNK_GENERATING,     // A job is filling it in
+    CHUNK_LOADED          // Its trees are in the world
+} ChunkState;
+
+// What the renderer needs of a chunk
+typedef struct {
+    int x;
+    int z;
+    Color ground;
+    Vector3 rocks[CHUNK_MAX_ROCKS];
+    int rockCount;
+} ChunkLayout;
+
+typedef struct {
+    ChunkState state;
+    ChunkLayout layout;
+    unsigned int readyTick;   // Generating: the tick it's loaded on
+    JobCounter counter;
+    PlacementGrid placement;  // Trees by index within the chunk, then rocks
+    Vector2* treePositions;   // This chunk's part of the pool's slab
+    int treeCount;            // What fit, at most treesPerChunk
+    uint64_t seed;
+} Chunk;
+
+// Chunks that changed in an UpdateChunkPool, by slot, for the caller to
+// mirror into its own tree arrays
+typedef struct {
+    int unloaded[CHUNK_POOL_SIZE];
+    int unloadedCount;
+    int loaded[CHUNK_POOL_SIZE];
+    int loadedCount;
+} ChunkChanges;
+
+// A fixed pool of chunk slots around the player. Chunk contents depend only
+// on the seed and the chunk's coordinates, and are generated by jobs that
+// get CHUNK_GENERATION_TICKS to finish; loading then waits for the job if it
+// has to, so what's in the world on a given tick never depends on thread
+// timing. Slot s owns trees [s * treesPerChunk, (s + 1) * treesPerChunk) of
+// the caller's arrays. Nothing is allocated after InitChunkPool, so memory
+// stays the same however far the player walks.
+typedef struct {
+    Chunk chunks[CHUNK_POOL_SIZE];
+    Vector2* slab;            // Tree positions of every slot
+    int treesPerChunk;
+    float spacing;
+    uint64_t seed;
+    JobSystem* jobs;          // NULL generates inline when a chunk is requested
+    int centerX;              // Chunk the player was in at the last update
+    int centerZ;
+    bool centered;
+    unsigned int generated;   // Chunks generated so far
+} ChunkPool;
+
+bool InitChunkPool(ChunkPool* pool, int treesPerChunk, uint64_t seed, JobSystem* jobs);
+// Waits for generation still in flight
+void FreeChunkPool(ChunkPool* pool);
+
+void ChunkAt(Vector3 position, int* x, int* z);
+
+// When the player has moved to another chunk, drop slots beyond the unload
+// radius and request what's missing within the load radius. Then load every
+// chunk whose ready tick has come. The very first update loads at once.
+void UpdateChunkPool(ChunkPool* pool, Vector3 playerPosition, unsigned int tick, ChunkChanges* changes);
+
+int LoadedChunkCount(const ChunkPool* pool);
+
+// For a pool restored from a save: start generating the chunks that were
+// still generating when it was saved (their contents weren't saved)
+void RestartChunkJobs(ChunkPool* pool);
+
+#endif // WORLD_CHUNKS_H
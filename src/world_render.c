@@ -0,0 +1,216 @@
+#include "raylib.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include "world_render.h"
+#include "logger.h"
+#include <stdlib.h>
+
+#define INSTANCES_PER_TREE 2
+
+// Instance transforms carry their color in the bottom row (always 0, 0, 0
+// for scale + translate), which the shader reads back and clears
+static Matrix CubeInstance(Vector3 center, float width, float height, float length, Color color) {
+    Matrix transform = MatrixMultiply(MatrixScale(width, height, length), MatrixTranslate(center.x, center.y, center.z));
+    transform.m3 = color.r / 255.0f;
+    transform.m7 = color.g / 255.0f;
+    transform.m11 = color.b / 255.0f;
+    return transform;
+}
+
+static bool IsInstancingSupported(void) {
+    int version = rlGetVersion();
+    return version == RL_OPENGL_33 || version == RL_OPENGL_43 || version == RL_OPENGL_ES_30;
+}
+
+void InitWorldRenderer(WorldRenderer* renderer, WorldRenderPath requested, int treeCapacity) {
+    *renderer = (WorldRenderer){ 0 };
+    renderer->path = WORLD_RENDER_IMMEDIATE;
+    
+    int capacity = (treeCapacity > 0) ? treeCapacity : 1;
+    renderer->nearTrees = malloc(sizeof(int) * capacity);
+    renderer->farTrees = malloc(sizeof(int) * capacity);
+    if (!renderer->nearTrees || !renderer->farTrees) {
+        LOGW(LOG_CAT_RENDER, "Not enough memory for tree culling lists, trees will not be drawn");
+        UnloadWorldRenderer(renderer);
+        return;
+    }
+    renderer->treeCapacity = capacity;
+    if (requested != WORLD_RENDER_INSTANCED) return;
+    
+    if (!IsInstancingSupported()) {
+        LOGW(LOG_CAT_RENDER, "Instancing not supported by this GL context, drawing trees one by one");
+        return;
+    }
+    
+    renderer->shader = LoadShaderFromMemory(
+        "#version 330\n"
+        "in vec3 vertexPosition;\n"
+        "in mat4 instanceTransform;\n"
+        "uniform mat4 mvp;\n"
+        "out vec3 fragColor;\n"
+        "void main() {\n"
+        "    mat4 model = instanceTransform;\n"
+        "    fragColor = vec3(model[0][3], model[1][3], model[2][3]);\n"
+        "    model[0][3] = 0.0;\n"
+        "    model[1][3] = 0.0;\n"
+        "    model[2][3] = 0.0;\n"
+        "    gl_Position = mvp*model*vec4(vertexPosition, 1.0);\n"
+        "}",
+        "#version 330\n"
+        "in vec3 fragColor;\n"
+        "out vec4 finalColor;\n"
+        "void main() {\n"
+        "    finalColor = vec4(fragColor, 1.0);\n"
+        "}"
+    );
+    if (renderer->shader.id == 0 || renderer->shader.id == rlGetShaderIdDefault()) {
+        LOGW(LOG_CAT_RENDER, "Instancing shader failed to compile, drawing trees one by one");
+        return;
+    }
+    renderer->shader.locs[SHADER_LOC_MATRIX_MVP] = GetShaderLocation(renderer->shader, "mvp");
+    renderer->shader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(renderer->shader, "instanceTransform");
+    
+    renderer->treeInstances = malloc(sizeof(Matrix) * capacity * INSTANCES_PER_TREE);
+    renderer->markerInstances = malloc(sizeof(Matrix) * capacity);
+    renderer->drawInstances = malloc(sizeof(Matrix) * (capacity * (INSTANCES_PER_TREE + 1)));
+    if (!renderer->treeInstances || !renderer->markerInstances || !renderer->drawInstances) {
+        LOGW(LOG_CAT_RENDER, "Not enough memory for tree instances, drawing trees one by one");
+        free(renderer->treeInstances);
+        free(renderer->markerInstances);
+        free(renderer->drawInstances);
+        renderer->treeInstances = NULL;
+        renderer->markerInstances = NULL;
+        renderer->drawInstances = NULL;
+        return;
+    }
+    
+    renderer->cube = GenMeshCube(1.0f, 1.0f, 1.0f);
+    renderer->material = LoadMaterialDefault();
+    renderer->material.shader = renderer->shader;
+    renderer->builtVersion = 0; // Forces a build on the first draw
+    renderer->path = WORLD_RENDER_INSTANCED;
+}
+
+void UnloadWorldRenderer(WorldRenderer* renderer) {
+    if (renderer->path == WORLD_RENDER_INSTANCED) {
+        UnloadMesh(renderer->cube);
+        // The material shares our shader; unload them separately so it isn't freed twice
+        renderer->material.shader = (Shader){ rlGetShaderIdDefault(), rlGetShaderLocsDefault() };
+        UnloadMaterial(renderer->material);
+    }
+    if (renderer->shader.id > 0 && renderer->shader.id != rlGetShaderIdDefault()) UnloadShader(renderer->shader);
+    free(renderer->treeInstances);
+    free(renderer->markerInstances);
+    free(renderer->drawInstances);
+    free(renderer->nearTrees);
+    free(renderer->farTrees);
+    *renderer = (WorldRenderer){ 0 };
+}
+
+static void BuildTreeInstances(WorldRenderer* renderer, const FrameSnapshot* frame) {
+    int count = (frame->treeCount < renderer->treeCapacity) ? frame->treeCount : renderer->treeCapacity;
+    for (int i = 0; i < count; i++) {
+        Vector3 pos = frame->trees[i].position;
+        renderer->treeInstances[i * INSTANCES_PER_TREE] = CubeInstance((Vector3){ pos.x, 1.5f, pos.z }, 2.0f, 2.0f, 2.0f, LIME);
+        renderer->treeInstances[i * INSTANCES_PER_TREE + 1] = CubeInstance((Vector3){ pos.x, 0.5f, pos.z }, 0.5f, 1.0f, 0.5f, BROWN);
+        renderer->markerInstances[i] = CubeInstance((Vector3){ pos.x, pos.y + 3.5f, pos.z }, 1.0f, 1.0f, 1.0f, WHITE);
+    }
+    renderer->builtVersion = frame->treesVersion;
+}
+
+void CullWorldObjects(WorldRenderer* renderer, const FrameSnapshot* frame, Camera3D camera, float aspect,
+                      const int* candidates, int candidateCount) {
+    Frustum frustum = GetCameraFrustum(camera, aspect);
+    float lodDistanceSqr = TREE_LOD_DISTANCE*TREE_LOD_DISTANCE;
+    
+    renderer->nearCount = 0;
+    renderer->farCount = 0;
+    renderer->stats = (WorldRenderStats){ 0 };
+    
+    for (int c = 0; c < candidateCount; c++) {
+        int i = candidates[c];
+        if (i >= renderer->treeCapacity || !frame->trees[i].exists) continue;
+        
+        Vector3 pos = frame->trees[i].position;
+        Vector3 center = { pos.x, 2.0f, pos.z };
+        if (!IsSphereInFrustum(&frustum, center, TREE_BOUND_RADIUS)) {
+            renderer->stats.culled++;
+            continue;
+        }
+        
+        renderer->stats.submitted++;
+        if (Vector3DistanceSqr(camera.position, center) > lodDistanceSqr) {
+            renderer->farTrees[renderer->farCount++] = i;
+            renderer->stats.lod++;
+        } else {
+            renderer->nearTrees[renderer->nearCount++] = i;
+        }
+    }
+}
+
+static void DrawWorldObjectsImmediate(WorldRenderer* renderer, const FrameSnapshot* frame) {
+    const Tree* trees = frame->trees;
+    int cubes = 0;
+    
+    // Draw nearby trees (green cube on brown trunk) with their number cubes
+    for (int n = 0; n < renderer->nearCount; n++)
+    {
+        Vector3 pos = trees[renderer->nearTrees[n]].position;
+        DrawCube((Vector3){ pos.x, 1.5f, pos.z }, 2.0f, 2.0f, 2.0f, LIME);
+        DrawCube((Vector3){ pos.x, 0.5f, pos.z }, 0.5f, 1.0f, 0.5f, BROWN);
+        cubes += 2;
+        
+        if (trees[renderer->nearTrees[n]].answerNumber != NO_ANSWER)
+        {
+            Vector3 numberPos = {pos.x, pos.y + 3.5f, pos.z};
+            
+            // Draw a white cube above the tree
+            DrawCube(numberPos, 1.0f, 1.0f, 1.0f, WHITE);
+            DrawCubeWires(numberPos, 1.0f, 1.0f, 1.0f, BLACK);
+            cubes++;
+        }
+    }
+    
+    // Distant trees are just the canopy
+    for (int f = 0; f < renderer->farCount; f++)
+    {
+        Vector3 pos = trees[renderer->farTrees[f]].position;
+        DrawCube((Vector3){ pos.x, 1.5f, pos.z }, 2.0f, 2.0f, 2.0f, LIME);
+        cubes++;
+    }
+    
+    renderer->stats.cubes = cubes;
+}
+
+void DrawWorldObjects(WorldRenderer* renderer, const FrameSnapshot* frame) {
+    if (renderer->path != WORLD_RENDER_INSTANCED) {
+        DrawWorldObjectsImmediate(renderer, frame);
+        return;
+    }
+    
+    if (renderer->builtVersion != frame->treesVersion) BuildTreeInstances(renderer, frame);
+    
+    // Gather the prebuilt transforms of objects that survived culling
+    int count = 0;
+    for (int n = 0; n < renderer->nearCount; n++) {
+        int i = renderer->nearTrees[n];
+        renderer->drawInstances[count++] = renderer->treeInstances[i * INSTANCES_PER_TREE];
+        renderer->drawInstances[count++] = renderer->treeInstances[i * INSTANCES_PER_TREE + 1];
+        if (frame->trees[i].answerNumber != NO_ANSWER) renderer->drawInstances[count++] = renderer->markerInstances[i];
+    }
+    for (int f = 0; f < renderer->farCount; f++) {
+        renderer->drawInstances[count++] = renderer->treeInstances[renderer->farTrees[f] * INSTANCES_PER_TREE];
+    }
+    
+    if (count > 0) DrawMeshInstanced(renderer->cube, renderer->material, renderer->drawInstances, count);
+    renderer->stats.cubes = count;
+    
+    // Outlines stay immediate: only the handful of nearby labeled trees have them
+    for (int n = 0; n < renderer->nearCount; n++) {
+        int i = renderer->nearTrees[n];
+        if (frame->trees[i].answerNumber != NO_ANSWER) {
+            Vector3 pos = frame->trees[i].position;
+            DrawCubeWires((Vector3){ pos.x, pos.y + 3.5f, pos.z }, 1.0f, 1.0f, 1.0f, BLACK);
+        }
+    }
+}
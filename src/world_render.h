@@ -0,0 +1,59 @@
+#ifndef WORLD_RENDER_H
+#define WORLD_RENDER_H
+
+#include "raylib.h"
+#include "frame_pipeline.h"
+#include "frustum.h"
+
+#define TREE_LOD_DISTANCE 40.0f   // Past this from the camera a tree is one cube, unlabeled
+#define TREE_BOUND_RADIUS 2.45f   // Sphere around trunk, canopy and number cube
+
+typedef enum {
+    WORLD_RENDER_IMMEDIATE = 0,   // DrawCube per object through raylib's batch
+    WORLD_RENDER_INSTANCED        // One DrawMeshInstanced for every cube
+} WorldRenderPath;
+
+// Objects that made it through culling in the last CullWorldObjects call
+typedef struct {
+    int submitted;        // Trees inside the view frustum
+    int culled;           // Candidates rejected by the frustum test
+    int lod;              // Submitted trees drawn as a single cube
+    int cubes;            // Cubes actually drawn
+} WorldRenderStats;
+
+// Draws trees and answer marker cubes. The instanced path keeps a
+// transform per cube (with its color packed into the unused bottom row of
+// the matrix) and only rebuilds it when the simulation's trees change.
+typedef struct {
+    WorldRenderPath path;
+    Shader shader;
+    Material material;
+    Mesh cube;
+
+    Matrix* treeInstances;    // Canopy + trunk per tree
+    Matrix* markerInstances;  // Number cube per tree (used when it has an answer)
+    Matrix* drawInstances;    // Visible instances gathered for this frame
+    int treeCapacity;
+    unsigned int builtVersion;
+
+    // Output of CullWorldObjects, consumed by DrawWorldObjects and the labels
+    int* nearTrees;           // Full detail: trunk, canopy, outline and label
+    int* farTrees;            // Past TREE_LOD_DISTANCE: canopy only
+    int nearCount;
+    int farCount;
+    WorldRenderStats stats;
+} WorldRenderer;
+
+// Falls back to the immediate path when instancing isn't available
+void InitWorldRenderer(WorldRenderer* renderer, WorldRenderPath requested, int treeCapacity);
+void UnloadWorldRenderer(WorldRenderer* renderer);
+
+// Frustum cull the candidate trees (e.g. the snapshot's visibleTrees) against
+// the camera, then split the survivors by distance
+void CullWorldObjects(WorldRenderer* renderer, const FrameSnapshot* frame, Camera3D camera, float aspect,
+                      const int* candidates, int candidateCount);
+
+// Call inside BeginMode3D, after CullWorldObjects
+void DrawWorldObjects(WorldRenderer* renderer, const FrameSnapshot* frame);
+
+#endif // WORLD_RENDER_H